@@ -1,6 +1,9 @@
+import QtCore
+
 import QtQuick
 import QtQuick.Layouts
 import QtQuick.Controls
+import QtQuick.Dialogs
 
 import ComponentLibrary
 import QmlMobileScanner
@@ -59,13 +62,132 @@ Loader {
         Component {
             id: mainView
 
-            ListView {
-                model: barcodeManager.barcodesHistory
-                delegate: WidgetBarcodeHistory {
-                    width: ListView.view.width
-                    onClicked: {
-                        stackView.push(detailsView)
-                        stackView.get(1).loadBarcode(modelData)
+            Item {
+                RowLayout {
+                    id: toolBar
+                    anchors.top: parent.top
+                    anchors.topMargin: Theme.componentMargin
+                    anchors.left: parent.left
+                    anchors.leftMargin: screenPaddingLeft + Theme.componentMargin
+                    anchors.right: parent.right
+                    anchors.rightMargin: screenPaddingRight + Theme.componentMargin
+                    height: 40
+                    spacing: Theme.componentMargin / 2
+
+                    TextFieldThemed {
+                        id: searchField
+                        Layout.fillWidth: true
+                        Layout.preferredHeight: 40
+
+                        visible: barcodeManager.hasBarcodesHistory
+                        placeholderText: qsTr("Search")
+
+                        onDisplayTextChanged: barcodeManager.historySearch.query = displayText
+                    }
+                    Item {
+                        Layout.fillWidth: true
+                        visible: !searchField.visible
+                    }
+
+                    SquareButtonClear { // import
+                        enabled: !historyTransfer.busy
+                        color: Theme.colorIcon
+                        tooltipText: qsTr("Import")
+                        source: "qrc:/IconLibrary/material-symbols/file.svg"
+
+                        onClicked: historyImportDialog.open()
+                    }
+                    SquareButtonClear { // export
+                        visible: barcodeManager.hasBarcodesHistory
+                        enabled: !historyTransfer.busy
+                        color: Theme.colorIcon
+                        tooltipText: qsTr("Export")
+                        source: "qrc:/IconLibrary/material-icons/duotone/save_alt.svg"
+
+                        onClicked: historyExportDialog.open()
+                    }
+                }
+
+                Column { // transfer progress and result
+                    id: transferStatus
+                    anchors.top: toolBar.bottom
+                    anchors.topMargin: Theme.componentMargin / 2
+                    anchors.left: toolBar.left
+                    anchors.right: toolBar.right
+                    spacing: 4
+
+                    visible: historyTransfer.busy || transferResult.text.length > 0
+
+                    ProgressBarThemed {
+                        width: parent.width
+                        height: 6
+                        visible: historyTransfer.busy
+                        value: historyTransfer.progress
+                    }
+                    Text {
+                        id: transferResult
+                        width: parent.width
+                        visible: !historyTransfer.busy && text.length > 0
+                        textFormat: Text.PlainText
+                        font.pixelSize: Theme.fontSizeContentSmall
+                        color: Theme.colorSubText
+                        wrapMode: Text.WordWrap
+                    }
+
+                    Connections {
+                        target: historyTransfer
+                        function onExportFinished(success, count, filePath) {
+                            transferResult.text = success ? qsTr("%n barcode(s) exported", "", count) : qsTr("Export failed")
+                        }
+                        function onImportFinished(success, count) {
+                            transferResult.text = success ? qsTr("%n barcode(s) imported", "", count) : qsTr("Import failed")
+                        }
+                    }
+                }
+
+                ListView {
+                    anchors.top: transferStatus.visible ? transferStatus.bottom : toolBar.bottom
+                    anchors.topMargin: Theme.componentMargin
+                    anchors.left: parent.left
+                    anchors.right: parent.right
+                    anchors.bottom: parent.bottom
+                    clip: true
+
+                    model: (searchField.displayText.length > 0) ? barcodeManager.historySearch
+                                                                : barcodeManager.barcodesHistory
+                    delegate: WidgetBarcodeHistory {
+                        width: ListView.view.width
+                        onClicked: {
+                            stackView.push(detailsView)
+                            stackView.get(1).loadBarcode(ListView.view.model.get(index))
+                        }
+                    }
+                }
+
+                FileDialog {
+                    id: historyExportDialog
+
+                    fileMode: FileDialog.SaveFile
+                    nameFilters: ["CSV files (*.csv)", "JSONL files (*.jsonl)", "GeoJSON files (*.geojson)"]
+                    currentFolder: StandardPaths.standardLocations(StandardPaths.DocumentsLocation)[0]
+                    currentFile: StandardPaths.standardLocations(StandardPaths.DocumentsLocation)[0] + "/history.csv"
+
+                    onAccepted: {
+                        console.log("historyExportDialog: ACCEPTED: " + selectedFile)
+                        historyTransfer.exportHistory(selectedFile)
+                    }
+                }
+
+                FileDialog {
+                    id: historyImportDialog
+
+                    fileMode: FileDialog.OpenFile
+                    nameFilters: ["History files (*.csv *.jsonl *.ndjson *.geojson *.json)"]
+                    currentFolder: StandardPaths.standardLocations(StandardPaths.DocumentsLocation)[0]
+
+                    onAccepted: {
+                        console.log("historyImportDialog: ACCEPTED: " + selectedFile)
+                        historyTransfer.importHistory(selectedFile)
                     }
                 }
             }
@@ -177,7 +177,10 @@ Loader {
                 focusMode: Camera.FocusModeAutoNear
 
                 cameraDevice: mediaDevices.videoInputs[mediaDevices.selectedDevice] ? mediaDevices.videoInputs[mediaDevices.selectedDevice] : mediaDevices.defaultVideoInput
-                cameraFormat: utilsCamera.selectCameraFormat(cameraDevice)
+                cameraFormat: {
+                    utilsCamera.decodeCostPerPixel // selected again once the decoding cost is calibrated
+                    return utilsCamera.selectCameraFormat(cameraDevice)
+                }
                 //cameraFormat: (settingsManager.scanFullres) ? utilsCamera.selectCameraFormat(cameraDevice) : undefined
 
                 onCameraDeviceChanged: {
@@ -216,6 +219,9 @@ Loader {
             fillMode: VideoOutput.PreserveAspectCrop
             //fillMode: VideoOutput.PreserveAspectFit
 
+            // camera frame rate, for the debug infos
+            Component.onCompleted: utilsFpsMonitor.setVideoSink(videoOutput.videoSink)
+
             // Capture rectangle
             property double captureRectStartFactorX: 0.05
             property double captureRectStartFactorY: 0.20
@@ -428,7 +434,7 @@ Loader {
                     anchors.leftMargin: screenPaddingLeft
                     anchors.rightMargin: screenPaddingRight
 
-                    opacity: modelData.isOnScreen ? 0.80 : 0
+                    opacity: model.isOnScreen ? 0.80 : 0
                     Behavior on opacity { NumberAnimation { duration: 133 } }
 
                     layer.enabled: appWindow.isDesktop
@@ -436,16 +442,16 @@ Loader {
 
                     ShapePath {
                         strokeWidth: 4
-                        strokeColor: modelData.color
+                        strokeColor: model.color
                         strokeStyle: ShapePath.SolidLine
                         fillColor: "transparent"
 
-                        startX: modelData.lastCoordinates[3].x
-                        startY: modelData.lastCoordinates[3].y
-                        PathLine { x: modelData.lastCoordinates[0].x; y: modelData.lastCoordinates[0].y; }
-                        PathLine { x: modelData.lastCoordinates[1].x; y: modelData.lastCoordinates[1].y; }
-                        PathLine { x: modelData.lastCoordinates[2].x; y: modelData.lastCoordinates[2].y; }
-                        PathLine { x: modelData.lastCoordinates[3].x; y: modelData.lastCoordinates[3].y; }
+                        startX: model.lastCoordinates[3].x
+                        startY: model.lastCoordinates[3].y
+                        PathLine { x: model.lastCoordinates[0].x; y: model.lastCoordinates[0].y; }
+                        PathLine { x: model.lastCoordinates[1].x; y: model.lastCoordinates[1].y; }
+                        PathLine { x: model.lastCoordinates[2].x; y: model.lastCoordinates[2].y; }
+                        PathLine { x: model.lastCoordinates[3].x; y: model.lastCoordinates[3].y; }
                     }
                 }
             }
@@ -486,21 +492,21 @@ Loader {
                     anchors.leftMargin: screenPaddingLeft
                     anchors.rightMargin: screenPaddingRight
 
-                    opacity: modelData.isOnScreen ? 0.80 : 0
+                    opacity: model.isOnScreen ? 0.80 : 0
                     Behavior on opacity { NumberAnimation { duration: 133 } }
 
                     ShapePath {
                         strokeWidth: 4
-                        strokeColor: modelData.color
+                        strokeColor: model.color
                         strokeStyle: ShapePath.SolidLine
                         fillColor: "transparent"
 
-                        startX: modelData.lastCoordinates[3].x * imageOutput.sourceSize.width
-                        startY: modelData.lastCoordinates[3].y * imageOutput.sourceSize.height
-                        PathLine { x: modelData.lastCoordinates[0].x* imageOutput.sourceSize.width; y: modelData.lastCoordinates[0].y* imageOutput.sourceSize.height; }
-                        PathLine { x: modelData.lastCoordinates[1].x* imageOutput.sourceSize.width; y: modelData.lastCoordinates[1].y* imageOutput.sourceSize.height; }
-                        PathLine { x: modelData.lastCoordinates[2].x* imageOutput.sourceSize.width; y: modelData.lastCoordinates[2].y* imageOutput.sourceSize.height; }
-                        PathLine { x: modelData.lastCoordinates[3].x* imageOutput.sourceSize.width; y: modelData.lastCoordinates[3].y* imageOutput.sourceSize.height; }
+                        startX: model.lastCoordinates[3].x * imageOutput.sourceSize.width
+                        startY: model.lastCoordinates[3].y * imageOutput.sourceSize.height
+                        PathLine { x: model.lastCoordinates[0].x* imageOutput.sourceSize.width; y: model.lastCoordinates[0].y* imageOutput.sourceSize.height; }
+                        PathLine { x: model.lastCoordinates[1].x* imageOutput.sourceSize.width; y: model.lastCoordinates[1].y* imageOutput.sourceSize.height; }
+                        PathLine { x: model.lastCoordinates[2].x* imageOutput.sourceSize.width; y: model.lastCoordinates[2].y* imageOutput.sourceSize.height; }
+                        PathLine { x: model.lastCoordinates[3].x* imageOutput.sourceSize.width; y: model.lastCoordinates[3].y* imageOutput.sourceSize.height; }
                     }
                 }
             }
@@ -544,7 +550,13 @@ Loader {
 
                     Text {
                         id: fpsCounter
-                        text: utilsFpsMonitor.fps.toFixed(0) + " fps"
+                        text: utilsFpsMonitor.fps.toFixed(0) + " fps (±" + utilsFpsMonitor.fpsJitter.toFixed(1) + " ms)"
+                        color: "white"
+                    }
+                    Text {
+                        id: cameraFpsCounter
+                        visible: (currentMode === "video")
+                        text: "camera " + utilsFpsMonitor.cameraFps.toFixed(0) + " fps"
                         color: "white"
                     }
                     Text {
@@ -553,6 +565,30 @@ Loader {
                         text: barcodeReader && barcodeReader.timePerFrameDecode.toFixed(0) + " ms"
                         color: "white"
                     }
+                    Text {
+                        id: latency
+                        visible: (currentMode === "video" && utilsFpsMonitor.latencyP50 > 0)
+                        text: "latency " + utilsFpsMonitor.latencyP50.toFixed(0) + " / " +
+                                           utilsFpsMonitor.latencyP90.toFixed(0) + " / " +
+                                           utilsFpsMonitor.latencyP99.toFixed(0) + " ms"
+                        color: "white"
+                    }
+                    Text {
+                        id: frameGating
+                        visible: (currentMode === "video" && barcodeReader && barcodeReader.frameGating === true)
+                        text: visible ? ("sharp " + barcodeReader.sharpness.toFixed(2) +
+                                         " / motion " + barcodeReader.motion.toFixed(1) +
+                                         " / skipped " + barcodeReader.framesSkipped) : ""
+                        color: "white"
+                    }
+                    Text {
+                        id: videoScan
+                        visible: dndItm.videoScanning
+                        text: visible ? ("video scan " + (barcodeReader.fileScanner.progress * 100).toFixed(0) + "% (" +
+                                         barcodeReader.fileScanner.framesDecoded + " frames in " +
+                                         (barcodeReader.fileScanner.elapsed / 1000).toFixed(0) + " s)") : ""
+                        color: "white"
+                    }
                 }
             }
 
@@ -577,6 +613,8 @@ Loader {
 
                     visible: isDesktop
 
+                    property bool videoScanning: (barcodeReader && barcodeReader.fileScanner && barcodeReader.fileScanner.running) ? true : false
+
                     Rectangle {
                         anchors.fill: parent
                         radius: height
@@ -588,7 +626,7 @@ Loader {
                         width: parent.height * 0.6
                         height: parent.height * 0.6
                         anchors.centerIn: parent
-                        color: fileOpenDialog.visible ? Theme.colorYellow : "white"
+                        color: (fileOpenDialog.visible || dndItm.videoScanning) ? Theme.colorYellow : "white"
                         source: "qrc:/IconLibrary/material-icons/duotone/photo_library.svg"
                     }
                     MouseArea {
@@ -609,13 +647,16 @@ Loader {
 
                         fileMode: FileDialog.OpenFile
                         nameFilters: ["Picture files (*.png *.bmp *.jpg *.jpeg *.webp)",
-                                      "PNG files (*.png)", "BMP files (*.bmp)", "JPEG files (*.jpg *.jpeg)", "WebP files (*.webp)"]
+                                      "PNG files (*.png)", "BMP files (*.bmp)", "JPEG files (*.jpg *.jpeg)", "WebP files (*.webp)"].concat(
+                                      (barcodeReader && barcodeReader.fileScanner) ? ["Video files (*.mp4 *.mkv *.mov *.avi *.webm)"] : [])
                         currentFolder: StandardPaths.standardLocations(StandardPaths.PicturesLocation)[0]
 
                         onAccepted: {
                             console.log("fileOpenDialog: ACCEPTED: " + selectedFile)
 
-                            if (barcodeManager.loadImage(selectedFile)) {
+                            if (/\.(mp4|mkv|mov|avi|webm)$/i.test(selectedFile.toString())) {
+                                if (barcodeReader && barcodeReader.fileScanner) barcodeReader.fileScanner.scan(selectedFile)
+                            } else if (barcodeManager.loadImage(selectedFile)) {
                                 open_image(selectedFile)
                             }
                         }
@@ -832,10 +873,10 @@ Loader {
                     WidgetBarcodeResult {
                         anchors.left: parent.left
                         anchors.right: parent.right
-                        barcode: modelData
+                        barcode: model
 
                         onLongPressed: {
-                            screenBarcodeDetails.loadBarcode(modelData)
+                            screenBarcodeDetails.loadBarcode(barcodeManager.barcodes.get(index))
                         }
                     }
                 }
@@ -1,6 +1,9 @@
+import QtCore
+
 import QtQuick
 import QtQuick.Layouts
 import QtQuick.Controls
+import QtQuick.Dialogs
 
 import ComponentLibrary
 import QmlMobileScanner
@@ -569,6 +572,103 @@ Loader {
 
                 ////////////////
 
+                ListTitle {
+                    text: qsTr("Products")
+                    source: "qrc:/IconLibrary/material-symbols/shopping_cart.svg"
+                }
+
+                ////////////////
+
+                RowLayout { // product catalog
+                    anchors.left: parent.left
+                    anchors.leftMargin: contentColumn.padMargin
+                    anchors.right: parent.right
+                    anchors.rightMargin: contentColumn.padMargin
+                    height: 56
+
+                    Item {
+                        Layout.preferredWidth: 56
+
+                        IconSvg {
+                            anchors.centerIn: parent
+                            width: 24
+                            height: 24
+                            color: Theme.colorIcon
+                            source: "qrc:/IconLibrary/material-symbols/barcode.svg"
+                        }
+                    }
+
+                    Column {
+                        Layout.fillWidth: true
+                        Layout.alignment: Qt.AlignVCenter
+                        spacing: 4
+
+                        Text {
+                            width: parent.width
+                            text: qsTr("Product catalog")
+                            textFormat: Text.PlainText
+                            font.pixelSize: Theme.fontSizeContent
+                            color: Theme.colorText
+                            wrapMode: Text.WordWrap
+                        }
+                        Text {
+                            width: parent.width
+                            text: {
+                                if (productsManager.catalogImporting) return qsTr("Importing…")
+                                if (productsManager.catalogAvailable) return qsTr("%n product(s)", "", productsManager.catalogCount)
+                                return qsTr("CSV or JSONL dump, used offline")
+                            }
+                            textFormat: Text.PlainText
+                            font.pixelSize: Theme.fontSizeContentSmall
+                            color: Theme.colorSubText
+                            wrapMode: Text.WordWrap
+                        }
+                        ProgressBarThemed {
+                            width: parent.width
+                            height: 6
+                            visible: productsManager.catalogImporting
+                            value: productsManager.catalogImportProgress
+                        }
+                    }
+
+                    SquareButtonClear {
+                        Layout.alignment: Qt.AlignVCenter
+                        visible: productsManager.catalogAvailable
+                        enabled: !productsManager.catalogImporting
+                        color: Theme.colorSubText
+                        tooltipText: qsTr("Remove")
+                        source: "qrc:/IconLibrary/material-symbols/delete.svg"
+
+                        onClicked: productsManager.removeCatalog()
+                    }
+
+                    ButtonFlat {
+                        Layout.alignment: Qt.AlignVCenter
+                        Layout.rightMargin: 12
+                        enabled: !productsManager.catalogImporting
+                        color: Theme.colorGrey
+
+                        text: qsTr("import")
+                        onClicked: catalogOpenDialog.open()
+
+                        FileDialog {
+                            id: catalogOpenDialog
+
+                            fileMode: FileDialog.OpenFile
+                            nameFilters: ["Catalog files (*.csv *.tsv *.txt *.jsonl *.ndjson *.json)",
+                                          "CSV files (*.csv *.tsv *.txt)", "JSONL files (*.jsonl *.ndjson *.json)"]
+                            currentFolder: StandardPaths.standardLocations(StandardPaths.DownloadLocation)[0]
+
+                            onAccepted: {
+                                console.log("catalogOpenDialog: ACCEPTED: " + selectedFile)
+                                productsManager.importCatalog(selectedFile)
+                            }
+                        }
+                    }
+                }
+
+                ////////////////
+
                 ListTitle {
                     text: qsTr("Debug")
                     source: "qrc:/IconLibrary/material-icons/duotone/bug_report.svg"
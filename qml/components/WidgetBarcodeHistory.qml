@@ -15,7 +15,7 @@ SwipeDelegate {
 
     onClicked: {
         //console.log("WidgetBarcodeHistory::onClicked()")
-        //screenBarcodeDetails.loadScreenFrom("ScreenBarcodeHistory", modelData)
+        //screenBarcodeDetails.loadScreenFrom("ScreenBarcodeHistory", model)
     }
 
     ////////////////////////////////////////////////////////////////////////////
@@ -64,10 +64,10 @@ SwipeDelegate {
 
                 IconSvg {
                     anchors.centerIn: parent
-                    width: modelData.isMatrix ? 48 : 32
-                    height: modelData.isMatrix ? 48 : 32
+                    width: model.isMatrix ? 48 : 32
+                    height: model.isMatrix ? 48 : 32
                     color: Theme.colorText
-                    source: modelData.isMatrix ? "qrc:/IconLibrary/material-symbols/qr_code_2.svg" :
+                    source: model.isMatrix ? "qrc:/IconLibrary/material-symbols/qr_code_2.svg" :
                                                  "qrc:/IconLibrary/material-symbols/barcode.svg"
                 }
             }
@@ -87,11 +87,11 @@ SwipeDelegate {
                     spacing: 8
 
                     TagClear {
-                        visible: modelData.content
-                        text: modelData.content
+                        visible: model.content
+                        text: model.content
                     }
                     Text {
-                        text: modelData.data
+                        text: model.data
                         Layout.fillWidth: true
                         font.pixelSize: Theme.fontSizeContentBig
                         color: Theme.colorText
@@ -109,7 +109,7 @@ SwipeDelegate {
                     ////
 
                     Row { // date
-                        visible: modelData.date
+                        visible: model.date
                         height: 16
                         spacing: 6
 
@@ -122,7 +122,7 @@ SwipeDelegate {
                         }
                         Text {
                             anchors.verticalCenter: parent.verticalCenter
-                            text: modelData.date.toLocaleString(Qt.locale(), "dddd, MMMM d, yyyy hh:mm")
+                            text: model.date.toLocaleString(Qt.locale(), "dddd, MMMM d, yyyy hh:mm")
                             font.pixelSize: Theme.fontSizeContentSmall
                             color: Theme.colorSubText
                         }
@@ -131,7 +131,7 @@ SwipeDelegate {
                     ////
 
                     Row { // location
-                        visible: (modelData.latitude != 0 && modelData.longitude != 0)
+                        visible: (model.latitude != 0 && model.longitude != 0)
                         height: 16
                         spacing: 6
 
@@ -144,7 +144,7 @@ SwipeDelegate {
                         }
                         Text {
                             anchors.verticalCenter: parent.verticalCenter
-                            text: modelData.latitude + "°N " + modelData.longitude + "°E"
+                            text: model.latitude + "°N " + model.longitude + "°E"
                             font.pixelSize: Theme.fontSizeContentSmall
                             color: Theme.colorSubText
                         }
@@ -159,7 +159,7 @@ SwipeDelegate {
             ////////
 
             Item {
-                Layout.preferredWidth: modelData.isStarred ? 48 : 0
+                Layout.preferredWidth: model.isStarred ? 48 : 0
                 Layout.preferredHeight: 48
                 Layout.alignment: Qt.AlignVCenter
 
@@ -167,7 +167,7 @@ SwipeDelegate {
                     anchors.centerIn: parent
                     width: 32
                     height: 32
-                    visible: modelData.isStarred
+                    visible: model.isStarred
                     color: Theme.colorSubText
                     source: "qrc:/IconLibrary/material-symbols/stars-fill.svg"
                 }
@@ -227,7 +227,7 @@ SwipeDelegate {
 
             SwipeDelegate.onClicked: {
                 utilsApp.vibrate(33)
-                barcodeManager.removeHistory(modelData.data)
+                barcodeManager.removeHistory(model.data)
             }
         }
     }
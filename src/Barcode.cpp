@@ -21,105 +21,88 @@
 
 #include "Barcode.h"
 
+#include <QSet>
+
 /* ************************************************************************** */
 
-Barcode::Barcode(const QString &data, const QString &format, const QString &enc, const QString &ecc,
-                 const QDateTime &lastseen, const double lat, const double lon,
-                 const bool starred,
-                 QObject *parent) : QObject(parent)
+//! Share the few distinct format / encoding / ecc strings between all entries
+static QString intern(const QString &str)
 {
-    m_data = data;
-    m_format = format;
-    m_encoding = enc;
-    m_ecc = ecc;
-
-    m_date = lastseen;
-    m_geo_lat = lat;
-    m_geo_long = lon;
-
-    m_starred = starred;
+    static QSet<QString> pool;
 
-    m_isMatrix = (format == "QR_CODE" || format == "QRCode" || format == "MicroQRCode" ||
-                  format == "DATA_MATRIX" || format == "DataMatrix" || format == "Aztec" ||
-                  format == "PDF417" || format == "MaxiCode");
+    auto it = pool.constFind(str);
+    if (it != pool.constEnd()) return *it;
 
-    if (m_data.startsWith("http://") || m_data.startsWith("https://")) m_content = "URL";
-    else if (m_data.startsWith("WIFI:")) m_content = "WiFi";
-    else if (m_data.startsWith("mailto:")) m_content = "Email";
-    else if (m_data.startsWith("geo:")) m_content = "Geolocation";
-    else if (m_data.startsWith("tel:")) m_content = "Phone";
-    else if (m_data.startsWith("smsto:")) m_content = "SMS";
-    else if (m_data.startsWith("BEGIN:VCARD") || m_data.startsWith("MECARD:")) m_content = "Contact";
-    else if (m_data.startsWith("BEGIN:VEVENT")) m_content = "Calendar";
+    pool.insert(str);
+    return str;
 }
 
+/* ************************************************************************** */
+
 Barcode::Barcode(const QString &data, const QString &format, const QString &enc, const QString &ecc,
-                 const QDateTime &lastseen, const QColor &color,
-                 /*const QPointF &p1, const QPointF &p2, const QPointF &p3, const QPointF &p4,*/
-                 QObject *parent) : QObject(parent)
+                 const qint64 date, const double lat, const double lon, const bool starred)
 {
     m_data = data;
-    m_format = format;
-    m_encoding = enc;
-    m_ecc = ecc;
+    m_format = intern(format);
+    m_encoding = intern(enc);
+    m_ecc = intern(ecc);
+
+    m_date = date;
+    m_geo_lat = lat;
+    m_geo_long = lon;
+
+    m_starred = starred;
 
     m_isMatrix = (format == "QR_CODE" || format == "QRCode" || format == "MicroQRCode" ||
                   format == "DATA_MATRIX" || format == "DataMatrix" || format == "Aztec" ||
                   format == "PDF417" || format == "MaxiCode");
 
-    if (m_data.startsWith("http://") || m_data.startsWith("https://")) m_content = "URL";
-    else if (m_data.startsWith("WIFI:")) m_content = "WiFi";
-    else if (m_data.startsWith("mailto:")) m_content = "Email";
-    else if (m_data.startsWith("geo:")) m_content = "Geolocation";
-    else if (m_data.startsWith("tel:")) m_content = "Phone";
-    else if (m_data.startsWith("smsto:")) m_content = "SMS";
-    else if (m_data.startsWith("BEGIN:VCARD") || m_data.startsWith("MECARD:")) m_content = "Contact";
-    else if (m_data.startsWith("BEGIN:VEVENT")) m_content = "Calendar";
-
-    //m_lastCoordinates << p1 << p2 << p3 << p4;
-    m_isOnScreen = true;
-    m_lastSeen = lastseen;
-    m_color = color;
-
-    if (m_lastSeen.isValid())
-    {
-        connect(&m_lastTimer, &QTimer::timeout, [this]() { m_isOnScreen = false; Q_EMIT lastseenChanged(); });
-        m_lastTimer.start(1000);
-    }
-}
-
-Barcode::~Barcode()
-{
-    //
+    if (m_data.startsWith("http://") || m_data.startsWith("https://")) m_content = Content::URL;
+    else if (m_data.startsWith("WIFI:")) m_content = Content::WiFi;
+    else if (m_data.startsWith("mailto:")) m_content = Content::Email;
+    else if (m_data.startsWith("geo:")) m_content = Content::Geolocation;
+    else if (m_data.startsWith("tel:")) m_content = Content::Phone;
+    else if (m_data.startsWith("smsto:")) m_content = Content::SMS;
+    else if (m_data.startsWith("BEGIN:VCARD") || m_data.startsWith("MECARD:")) m_content = Content::Contact;
+    else if (m_data.startsWith("BEGIN:VEVENT")) m_content = Content::Calendar;
 }
 
 /* ************************************************************************** */
 
-void Barcode::setStarred(const bool value)
+QString Barcode::getContent() const
 {
-    if (m_starred != value)
+    switch (m_content)
     {
-        m_starred = value;
-        Q_EMIT barcodeChanged();
+        case Content::URL: return QStringLiteral("URL");
+        case Content::WiFi: return QStringLiteral("WiFi");
+        case Content::Email: return QStringLiteral("Email");
+        case Content::Geolocation: return QStringLiteral("Geolocation");
+        case Content::Phone: return QStringLiteral("Phone");
+        case Content::SMS: return QStringLiteral("SMS");
+        case Content::Contact: return QStringLiteral("Contact");
+        case Content::Calendar: return QStringLiteral("Calendar");
+        case Content::None: break;
     }
-}
 
-void Barcode::setLastSeen(const QDateTime &value)
-{
-    if (m_lastSeen != value)
-    {
-        m_isOnScreen = true;
-        m_lastTimer.start(1000);
-        m_lastSeen = value;
-        Q_EMIT lastseenChanged();
-    }
+    return QString();
 }
 
-void Barcode::setLastCoordinates(const QPointF &p1, const QPointF &p2, const QPointF &p3, const QPointF &p4)
+QVariantMap Barcode::toVariantMap() const
 {
-    m_lastCoordinates.clear();
-    m_lastCoordinates << p1 << p2 << p3 << p4;
-    Q_EMIT lastseenChanged();
+    return {
+        {"data", m_data},
+        {"format", m_format},
+        {"encoding", m_encoding},
+        {"errorCorrection", m_ecc},
+        {"date", getDate()},
+        {"latitude", m_geo_lat},
+        {"longitude", m_geo_long},
+        {"isStarred", m_starred},
+        {"isMatrix", m_isMatrix},
+        {"isLinear", !m_isMatrix},
+        {"hasPosition", hasPosition()},
+        {"content", getContent()},
+    };
 }
 
 /* ************************************************************************** */
@@ -23,12 +23,9 @@
 #define BARCODE_H
 /* ************************************************************************** */
 
-#include <QObject>
-#include <QTimer>
-#include <QPoint>
-#include <QColor>
 #include <QString>
 #include <QDateTime>
+#include <QVariantMap>
 
 /* ************************************************************************** */
 
@@ -90,86 +87,63 @@ WIFI:S:ssid;P:password;;
 
 /*!
  * \brief The Barcode class
+ *
+ * Plain value type, stored contiguously in the barcode models.
+ * Format, encoding and ecc strings are interned, so that every entry shares
+ * the same few allocations, and the content type is stored as an enum.
  */
-class Barcode: public QObject
+class Barcode
 {
-    Q_OBJECT
-
-    Q_PROPERTY(QString data READ getData CONSTANT)
-    Q_PROPERTY(QString format READ getFormat CONSTANT)
-    Q_PROPERTY(QString encoding READ getEnc CONSTANT)
-    Q_PROPERTY(QString errorCorrection READ getEcc CONSTANT)
-    Q_PROPERTY(QDateTime date READ getDate CONSTANT)
-    Q_PROPERTY(double latitude READ getLat CONSTANT)
-    Q_PROPERTY(double longitude READ getLon CONSTANT)
-
-    Q_PROPERTY(bool isStarred READ isStarred WRITE setStarred NOTIFY barcodeChanged)
-    Q_PROPERTY(bool isMatrix READ isMatrix CONSTANT)
-    Q_PROPERTY(bool isLinear READ isLinear CONSTANT)
-    Q_PROPERTY(bool hasPosition READ hasPosition CONSTANT)
-
-    Q_PROPERTY(QString content READ getContent CONSTANT)
-
-    Q_PROPERTY(bool isOnScreen READ isOnScreen NOTIFY lastseenChanged)
-    Q_PROPERTY(QDateTime lastSeen READ getLastSeen NOTIFY lastseenChanged)
-    Q_PROPERTY(QList<QPointF> lastCoordinates READ getLastCoordinates NOTIFY lastseenChanged)
-    Q_PROPERTY(QColor color READ getColor CONSTANT)
-
-    QString m_data;
-    QString m_format;
-    QString m_encoding;
-    QString m_ecc;
-
-    bool m_starred = false;
-    bool m_isMatrix = false;
-    QColor m_color;
-    QString m_content;
-
-    QDateTime m_date;
-    double m_geo_lat;
-    double m_geo_long;
-
-    bool m_isOnScreen = false;
-    QTimer m_lastTimer;
-    QDateTime m_lastSeen;
-    QList<QPointF> m_lastCoordinates;
-
-Q_SIGNALS:
-    void barcodeChanged();
-    void lastseenChanged();
-
 public:
+    enum class Content : quint8 {
+        None,
+        URL,
+        WiFi,
+        Email,
+        Geolocation,
+        Phone,
+        SMS,
+        Contact,
+        Calendar,
+    };
+
+    Barcode() = default;
     Barcode(const QString &data, const QString &format, const QString &enc, const QString &ecc,
-            const QDateTime &date = QDateTime(), const double lat = 0.0, const double lon = 0.0, const bool starred = false,
-            QObject *parent = nullptr);
-    Barcode(const QString &data, const QString &format, const QString &enc, const QString &ecc,
-            const QDateTime &lastseen, const QColor &color,
-            QObject *parent = nullptr);
-    ~Barcode();
-
-    QString getData() const { return m_data; }
-    QString getFormat() const { return m_format; }
-    QString getEnc() const { return m_encoding; }
-    QString getEcc() const { return m_ecc; }
-    QDateTime getDate() const { return m_date; }
+            const qint64 date = 0, const double lat = 0.0, const double lon = 0.0, const bool starred = false);
+
+    const QString &getData() const { return m_data; }
+    const QString &getFormat() const { return m_format; }
+    const QString &getEnc() const { return m_encoding; }
+    const QString &getEcc() const { return m_ecc; }
+    qint64 getDateMs() const { return m_date; }
+    QDateTime getDate() const { return m_date ? QDateTime::fromMSecsSinceEpoch(m_date) : QDateTime(); }
     double getLat() const { return m_geo_lat; }
     double getLon() const { return m_geo_long; }
     bool hasPosition() const { return (m_geo_lat != 0.0 || m_geo_long != 0.0); }
 
     bool isStarred() const { return m_starred; }
-    void setStarred(const bool value);
+    void setStarred(const bool value) { m_starred = value; }
 
     bool isMatrix() const { return m_isMatrix; }
     bool isLinear() const { return !m_isMatrix; }
-    QColor getColor() const { return m_color; }
-    QString getContent() const { return m_content; }
+    QString getContent() const;
 
-    bool isOnScreen() const { return m_isOnScreen; }
-    QDateTime getLastSeen() const { return m_lastSeen; }
-    void setLastSeen(const QDateTime &value);
+    //! Snapshot of every property, for QML (same keys as the model roles)
+    QVariantMap toVariantMap() const;
 
-    QList<QPointF> getLastCoordinates() const { return m_lastCoordinates; }
-    void setLastCoordinates(const QPointF &p1, const QPointF &p2, const QPointF &p3, const QPointF &p4);
+private:
+    QString m_data;
+    QString m_format;
+    QString m_encoding;
+    QString m_ecc;
+
+    qint64 m_date = 0;
+    double m_geo_lat = 0.0;
+    double m_geo_long = 0.0;
+
+    bool m_starred = false;
+    bool m_isMatrix = false;
+    Content m_content = Content::None;
 };
 
 /* ************************************************************************** */
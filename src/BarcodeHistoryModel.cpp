@@ -0,0 +1,231 @@
+/*!
+ * This file is part of QmlMobileScanner.
+ * Copyright (c) 2023 Emeric Grange - All Rights Reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \date      2026
+ * \author    Emeric Grange <emeric.grange@gmail.com>
+ */
+
+#include "BarcodeHistoryModel.h"
+
+#include <algorithm>
+#include <bit>
+
+/* ************************************************************************** */
+
+BarcodeHistoryModel::BarcodeHistoryModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+    //
+}
+
+/* ************************************************************************** */
+
+void BarcodeHistoryModel::setEntries(std::vector<Barcode> &&entries)
+{
+    beginResetModel();
+    m_entries = std::move(entries);
+    std::erase_if(m_entries, [](const Barcode &bc) { return bc.getData().isEmpty(); }); // empty marks a tombstone
+    m_positions.clear();
+    m_positions.reserve(qsizetype(m_entries.size()));
+    for (size_t i = 0; i < m_entries.size(); i++)
+    {
+        m_positions.insert(m_entries[i].getData(), qsizetype(i));
+    }
+    m_alive = int(m_entries.size());
+    buildAliveTree();
+    endResetModel();
+
+    Q_EMIT countChanged();
+}
+
+void BarcodeHistoryModel::append(const Barcode &bc)
+{
+    // newest entry, displayed on the first row
+    beginInsertRows(QModelIndex(), 0, 0);
+    const qsizetype slot = qsizetype(m_entries.size());
+    m_positions.insert(bc.getData(), slot);
+    m_entries.push_back(bc);
+    m_alive++;
+
+    // the new node covers (slot - lowbit(slot + 1), slot], only its own slot is not counted yet
+    const qsizetype first = (slot + 1) - ((slot + 1) & -(slot + 1));
+    m_aliveTree.push_back(aliveBefore(slot) - aliveBefore(first) + 1);
+    endInsertRows();
+
+    Q_EMIT countChanged();
+}
+
+bool BarcodeHistoryModel::remove(const QString &data)
+{
+    auto it = m_positions.find(data);
+    if (it == m_positions.end()) return false;
+
+    const qsizetype slot = it.value();
+    const int row = rowOf(data);
+
+    beginRemoveRows(QModelIndex(), row, row);
+    m_positions.erase(it);
+    m_entries[slot] = Barcode();
+    for (size_t i = size_t(slot) + 1; i <= m_aliveTree.size(); i += i & -i)
+    {
+        m_aliveTree[i - 1]--;
+    }
+    m_alive--;
+    endRemoveRows();
+
+    // compaction does not move any row
+    const int tombstones = int(m_entries.size()) - m_alive;
+    if (tombstones > std::max(s_minTombstones, m_alive / 2)) compact();
+
+    Q_EMIT countChanged();
+    return true;
+}
+
+int BarcodeHistoryModel::rowOf(const QString &data) const
+{
+    auto it = m_positions.constFind(data);
+    if (it == m_positions.constEnd()) return -1;
+
+    return m_alive - 1 - aliveBefore(it.value());
+}
+
+QVariantMap BarcodeHistoryModel::get(const int row) const
+{
+    if (row < 0 || row >= m_alive) return QVariantMap();
+
+    return m_entries[slotOf(row)].toVariantMap();
+}
+
+/* ************************************************************************** */
+
+void BarcodeHistoryModel::compact()
+{
+    std::vector<Barcode> entries;
+    entries.reserve(m_alive);
+    for (Barcode &bc: m_entries)
+    {
+        if (bc.getData().isEmpty()) continue;
+
+        m_positions[bc.getData()] = qsizetype(entries.size());
+        entries.push_back(std::move(bc));
+    }
+    m_entries.swap(entries);
+
+    buildAliveTree();
+}
+
+void BarcodeHistoryModel::buildAliveTree()
+{
+    // every node starts with its own slot, then is added to its parent
+    m_aliveTree.assign(m_entries.size(), 0);
+    for (size_t i = 0; i < m_entries.size(); i++)
+    {
+        if (!m_entries[i].getData().isEmpty()) m_aliveTree[i]++;
+
+        const size_t parent = i | (i + 1);
+        if (parent < m_aliveTree.size()) m_aliveTree[parent] += m_aliveTree[i];
+    }
+}
+
+int BarcodeHistoryModel::aliveBefore(const qsizetype slot) const
+{
+    int count = 0;
+    for (qsizetype i = slot; i > 0; i &= i - 1)
+    {
+        count += m_aliveTree[i - 1];
+    }
+    return count;
+}
+
+qsizetype BarcodeHistoryModel::slotOf(const int row) const
+{
+    // descend the tree to the slot having 'rank' alive slots before it
+    int rank = m_alive - 1 - row;
+    qsizetype slot = 0;
+    for (qsizetype step = std::bit_floor(m_aliveTree.size()); step > 0; step >>= 1)
+    {
+        if (slot + step <= qsizetype(m_aliveTree.size()) && m_aliveTree[slot + step - 1] <= rank)
+        {
+            slot += step;
+            rank -= m_aliveTree[slot - 1];
+        }
+    }
+    return slot;
+}
+
+/* ************************************************************************** */
+
+int BarcodeHistoryModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) return 0;
+    return m_alive;
+}
+
+QVariant BarcodeHistoryModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= m_alive) return QVariant();
+
+    return barcodeData(m_entries[slotOf(index.row())], role);
+}
+
+QHash<int, QByteArray> BarcodeHistoryModel::roleNames() const
+{
+    return barcodeRoleNames();
+}
+
+/* ************************************************************************** */
+
+QVariant BarcodeHistoryModel::barcodeData(const Barcode &bc, const int role)
+{
+    switch (role)
+    {
+        case DataRole: return bc.getData();
+        case FormatRole: return bc.getFormat();
+        case EncodingRole: return bc.getEnc();
+        case EccRole: return bc.getEcc();
+        case DateRole: return bc.getDate();
+        case LatitudeRole: return bc.getLat();
+        case LongitudeRole: return bc.getLon();
+        case StarredRole: return bc.isStarred();
+        case MatrixRole: return bc.isMatrix();
+        case LinearRole: return bc.isLinear();
+        case PositionRole: return bc.hasPosition();
+        case ContentRole: return bc.getContent();
+    }
+
+    return QVariant();
+}
+
+QHash<int, QByteArray> BarcodeHistoryModel::barcodeRoleNames()
+{
+    return {
+        {DataRole, "data"},
+        {FormatRole, "format"},
+        {EncodingRole, "encoding"},
+        {EccRole, "errorCorrection"},
+        {DateRole, "date"},
+        {LatitudeRole, "latitude"},
+        {LongitudeRole, "longitude"},
+        {StarredRole, "isStarred"},
+        {MatrixRole, "isMatrix"},
+        {LinearRole, "isLinear"},
+        {PositionRole, "hasPosition"},
+        {ContentRole, "content"},
+    };
+}
+
+/* ************************************************************************** */
@@ -0,0 +1,116 @@
+/*!
+ * This file is part of QmlMobileScanner.
+ * Copyright (c) 2023 Emeric Grange - All Rights Reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \date      2026
+ * \author    Emeric Grange <emeric.grange@gmail.com>
+ */
+
+#ifndef BARCODE_HISTORY_MODEL_H
+#define BARCODE_HISTORY_MODEL_H
+/* ************************************************************************** */
+
+#include "Barcode.h"
+
+#include <QAbstractListModel>
+#include <QHash>
+
+#include <vector>
+
+/* ************************************************************************** */
+
+/*!
+ * \brief The BarcodeHistoryModel class
+ *
+ * Entries are stored contiguously, oldest first, and exposed newest first
+ * (row 0 is the last entry). Adding to the history is an append, and entries
+ * are looked up by payload through a hash.
+ *
+ * Removed entries leave a tombstone, so the other slots (and the hash) stay
+ * put, and are compacted away once they outnumber half the alive entries.
+ * Rows are mapped to slots through a Fenwick tree counting the alive slots.
+ */
+class BarcodeHistoryModel: public QAbstractListModel
+{
+    Q_OBJECT
+
+    Q_PROPERTY(int count READ getCount NOTIFY countChanged)
+
+    std::vector<Barcode> m_entries;         //!< slots, removed ones are left empty
+    QHash<QString, qsizetype> m_positions;
+    std::vector<int> m_aliveTree;           //!< node i counts the alive slots (i - lowbit(i + 1), i]
+    int m_alive = 0;
+
+    static constexpr int s_minTombstones = 64;
+
+    void compact();
+    void buildAliveTree();
+    int aliveBefore(const qsizetype slot) const;
+    qsizetype slotOf(const int row) const;
+
+Q_SIGNALS:
+    void countChanged();
+
+public:
+    enum BarcodeRoles {
+        DataRole = Qt::UserRole + 1,
+        FormatRole,
+        EncodingRole,
+        EccRole,
+        DateRole,
+        LatitudeRole,
+        LongitudeRole,
+        StarredRole,
+        MatrixRole,
+        LinearRole,
+        PositionRole,
+        ContentRole,
+        LastBarcodeRole, //!< first free role id, for models extending these roles
+    };
+
+    explicit BarcodeHistoryModel(QObject *parent = nullptr);
+    ~BarcodeHistoryModel() = default;
+
+    void setEntries(std::vector<Barcode> &&entries);
+    void append(const Barcode &bc);
+    bool remove(const QString &data);
+
+    bool contains(const QString &data) const { return m_positions.contains(data); }
+    int rowOf(const QString &data) const;
+
+    //! Visit the entries in row order (newest first).
+    template <typename Fn> void forEachEntry(Fn fn) const
+    {
+        for (auto it = m_entries.crbegin(); it != m_entries.crend(); ++it)
+        {
+            if (!it->getData().isEmpty()) fn(*it);
+        }
+    }
+
+    int getCount() const { return m_alive; }
+    Q_INVOKABLE QVariantMap get(const int row) const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    //! Shared with the other barcode models
+    static QVariant barcodeData(const Barcode &bc, const int role);
+    static QHash<int, QByteArray> barcodeRoleNames();
+};
+
+/* ************************************************************************** */
+#endif // BARCODE_HISTORY_MODEL_H
@@ -24,24 +24,20 @@
 #include "DatabaseManager.h"
 
 #include <QRandomGenerator>
+#include <QDateTime>
 
 #include <QSqlDatabase>
 #include <QSqlDriver>
 #include <QSqlError>
 #include <QSqlQuery>
 
-#include <QNetworkAccessManager>
-#include <QNetworkRequest>
-#include <QNetworkReply>
-
-#include <QJsonArray>
-#include <QJsonObject>
-#include <QJsonDocument>
-
 #if defined(QMS_USE_ZXINGCPP)
 #include <ZXingQt>
 #endif
 
+#include <algorithm>
+#include <limits>
+
 /* ************************************************************************** */
 
 BarcodeManager *BarcodeManager::instance = nullptr;
@@ -59,52 +55,19 @@ BarcodeManager *BarcodeManager::getInstance()
 
 BarcodeManager::BarcodeManager()
 {
-    // Database
-    DatabaseManager *db = DatabaseManager::getInstance();
-    if (db && db->hasDatabaseInternal())
-    {
-        // Load saved barcodes
-        QSqlQuery loadBarcodes;
-        bool status = loadBarcodes.exec("SELECT data, format, encoding, ecc, date, lat, long, starred FROM barcodes");
-        if (status)
-        {
-            while (loadBarcodes.next())
-            {
-                QString barcodeData = loadBarcodes.value(0).toString();
-                QString barcodeFormat = loadBarcodes.value(1).toString();
-                QString barcodeEncoding = loadBarcodes.value(2).toString();
-                QString barcodeEcc = loadBarcodes.value(3).toString();
-                QDateTime barcodeDateTime = QDateTime::fromMSecsSinceEpoch(loadBarcodes.value(4).toULongLong());
-                double barcodeLatitude = loadBarcodes.value(5).toDouble();
-                double barcodeLongitude = loadBarcodes.value(6).toDouble();
-                bool barcodeStarred = loadBarcodes.value(7).toBool();
+    m_barcodes_onscreen = new BarcodeOnScreenModel(this);
+    m_barcodes_history = new BarcodeHistoryModel(this);
+    m_historySearch = new HistorySearchModel(&m_historyIndex, m_barcodes_history, this);
 
-                Barcode *bc = new Barcode(barcodeData, barcodeFormat, barcodeEncoding, barcodeEcc,
-                                          barcodeDateTime, barcodeLatitude, barcodeLongitude, barcodeStarred, this);
-                if (bc) m_barcodes_history.push_front(bc);
-            }
-        }
-        else
-        {
-            qWarning() << "> loadBarcodes.exec() ERROR"
-                       << loadBarcodes.lastError().type() << ":" << loadBarcodes.lastError().text();
-        }
-    }
+    // Database
+    loadHistory();
 
     // Colors
     m_colorsLeft = m_colorsAvailable;
-}
-
-BarcodeManager::~BarcodeManager()
-{
-    qDeleteAll(m_barcodes_onscreen);
-    m_barcodes_onscreen.clear();
-
-    qDeleteAll(m_barcodes_history);
-    m_barcodes_history.clear();
 
-    delete m_nwManager;
-    delete firmwareReply;
+    // Onscreen barcodes expiry
+    m_expiryTimer.setSingleShot(true);
+    connect(&m_expiryTimer, &QTimer::timeout, this, &BarcodeManager::processExpiry);
 }
 
 /* ************************************************************************** */
@@ -117,8 +80,9 @@ bool BarcodeManager::loadImage(const QUrl &fileUrl)
     QImage img;
     if (img.load(fileUrl.toLocalFile()))
     {
-        qDeleteAll(m_barcodes_onscreen);
-        m_barcodes_onscreen.clear();
+        clearExpiry();
+        m_barcodes_onscreen->clear();
+        Q_EMIT barcodesChanged();
 
         const QList<BarcodeQml> results = ZXingQt::loadImage(fileUrl);
         for (const auto &r: results)
@@ -172,42 +136,52 @@ bool BarcodeManager::addBarcode(const QString &data, const QString &format,
                                 const QString &enc, const QString &ecc,
                                 const QPointF &p1, const QPointF &p2, const QPointF &p3, const QPointF &p4,
                                 const bool fromVideo)
+{
+    return addBarcode(data, format, enc, ecc, QPolygonF({p1, p2, p3, p4}), fromVideo);
+}
+
+//! Same, with the four corners already mapped into the video item (see ZXingQtVideoFilter)
+bool BarcodeManager::addBarcode(const QString &data, const QString &format,
+                                const QString &enc, const QString &ecc,
+                                const QPolygonF &quad,
+                                const bool fromVideo)
 {
     if (!data.isEmpty())
     {
-        // check if exists
-        for (auto bc: std::as_const(m_barcodes_onscreen)) // barcode already exists
+        // barcode already exists, only refresh its row
+        const int row = m_barcodes_onscreen->rowOf(data);
+        if (row >= 0)
         {
-            Barcode *bbc = qobject_cast<Barcode*>(bc);
-            if (bbc && (bbc->getData() == data))
-            {
-                //qDebug() << "addBarcode(" << data << ") EXIST ALREADY";
-
-                bbc->setLastSeen(QDateTime::currentDateTime());
-                bbc->setLastCoordinates(p1, p2, p3, p4);
+            const bool wasOnScreen = m_barcodes_onscreen->isOnScreen(row);
+            m_barcodes_onscreen->update(row, quad);
 
-                Q_EMIT barcodesChanged();
-                return false;
+            // visible barcodes already have a pending expiry
+            if (!wasOnScreen)
+            {
+                const qint64 lastSeen = m_barcodes_onscreen->lastSeen(row);
+                scheduleExpiry({lastSeen + s_onScreenTimeoutMs, lastSeen, data, false});
             }
-        }
 
-        QDateTime dt;
-        if (fromVideo) dt = QDateTime::currentDateTime();
+            return false;
+        }
 
         // add barcode to the onscreen list
-        Barcode *bc = new Barcode(data, format, enc, ecc,
-                                  dt, getAvailableColor(), this);
-        if (bc)
-        {
-            qDebug() << "addBarcode(" << data << ")";
+        qDebug() << "addBarcode(" << data << ")";
 
-            bc->setLastSeen(QDateTime::currentDateTime());
-            bc->setLastCoordinates(p1, p2, p3, p4);
+        // barcodes from the camera are dated, as the details screen shows when they were scanned
+        const qint64 date = fromVideo ? QDateTime::currentMSecsSinceEpoch() : 0;
+        m_barcodes_onscreen->add(Barcode(data, format, enc, ecc, date),
+                                 QColor(getAvailableColor()),
+                                 quad);
+        Q_EMIT barcodesChanged();
 
-            m_barcodes_onscreen.push_back(bc);
-            Q_EMIT barcodesChanged();
-            return true;
+        // barcodes from still images stay on screen
+        if (fromVideo)
+        {
+            const qint64 lastSeen = m_barcodes_onscreen->lastSeen(m_barcodes_onscreen->getCount() - 1);
+            scheduleExpiry({lastSeen + s_onScreenTimeoutMs, lastSeen, data, false});
         }
+        return true;
     }
 
     return false;
@@ -215,90 +189,227 @@ bool BarcodeManager::addBarcode(const QString &data, const QString &format,
 
 /* ************************************************************************** */
 
-void BarcodeManager::addHistory(const QString &data, const QString &format,
-                                const QString &enc, const QString &ecc,
-                                const QGeoCoordinate &coord)
+//! std heap functions build max-heaps, reversed to pop the earliest deadline first
+static constexpr auto expiresLater = [](const auto &a, const auto &b) { return a.deadline > b.deadline; };
+
+void BarcodeManager::setStaleBarcodeTtl(const int ttl)
 {
-    if (!data.isEmpty())
+    // 0 disables eviction, otherwise barcodes have to be hidden before being evicted
+    const int value = (ttl > 0) ? std::max(ttl, s_onScreenTimeoutMs) : 0;
+    if (m_staleBarcodeTtl != value)
     {
-        // check if exists
-        for (auto bc: std::as_const(m_barcodes_history)) // barcode already exists
-        {
-            Barcode *bbc = qobject_cast<Barcode*>(bc);
-            if (bbc && (bbc->getData() == data))
-            {
-                //qDebug() << "addHistory(" << data << ") EXIST ALREADY";
-                return;
-            }
-        }
+        m_staleBarcodeTtl = value;
+        Q_EMIT staleBarcodeTtlChanged();
+    }
+}
+
+void BarcodeManager::scheduleExpiry(ExpiryEvent &&ev)
+{
+    m_expiryQueue.push_back(std::move(ev));
+    std::push_heap(m_expiryQueue.begin(), m_expiryQueue.end(), expiresLater);
+
+    const qint64 delay = m_expiryQueue.front().deadline - QDateTime::currentMSecsSinceEpoch();
+    m_expiryTimer.start(int(std::clamp<qint64>(delay, 0, std::numeric_limits<int>::max())));
+}
+
+void BarcodeManager::clearExpiry()
+{
+    m_expiryTimer.stop();
+    m_expiryQueue.clear();
+}
+
+void BarcodeManager::processExpiry()
+{
+    // everything due within the coalescing window is handled in one batch
+    const qint64 horizon = QDateTime::currentMSecsSinceEpoch() + s_expiryCoalesceMs;
 
-        Barcode *bc = new Barcode(data, format, enc, ecc,
-                                  QDateTime::currentDateTime(),
-                                  coord.latitude(), coord.longitude(),
-                                  false, this);
-        if (bc)
+    std::vector<int> hidden;
+    std::vector<int> evicted;
+    std::vector<ExpiryEvent> rescheduled;
+
+    while (!m_expiryQueue.empty() && m_expiryQueue.front().deadline <= horizon)
+    {
+        std::pop_heap(m_expiryQueue.begin(), m_expiryQueue.end(), expiresLater);
+        ExpiryEvent ev = std::move(m_expiryQueue.back());
+        m_expiryQueue.pop_back();
+
+        const int row = m_barcodes_onscreen->rowOf(ev.data);
+        if (row < 0) continue;
+
+        const qint64 lastSeen = m_barcodes_onscreen->lastSeen(row);
+
+        if (ev.evict)
         {
-            qDebug() << "addHistory(" << data << ")";
+            // seen again since it was hidden
+            if (m_barcodes_onscreen->isOnScreen(row) || lastSeen != ev.lastSeen) continue;
 
-            // add barcode to the history list
-            m_barcodes_history.push_front(bc);
-            Q_EMIT historyChanged();
+            evicted.push_back(row);
+        }
+        else
+        {
+            if (!m_barcodes_onscreen->isOnScreen(row)) continue;
 
-            // add barcode to the history database
-            QSqlQuery addBarcode;
-            if (coord.isValid() && (coord.latitude() != 0.0 || coord.longitude() != 0.0))
+            // still visible, push the deadline back
+            if (lastSeen + s_onScreenTimeoutMs > horizon)
             {
-                addBarcode.prepare("INSERT INTO barcodes (data, format, date, lat, long) VALUES (:data, :format, :date, :latitude, :longitude)");
-                addBarcode.bindValue(":latitude", coord.latitude());
-                addBarcode.bindValue(":longitude", coord.longitude());
+                ev.deadline = lastSeen + s_onScreenTimeoutMs;
+                rescheduled.push_back(std::move(ev));
+                continue;
             }
-            else
+
+            hidden.push_back(row);
+            if (m_staleBarcodeTtl > 0)
             {
-                addBarcode.prepare("INSERT INTO barcodes (data, format, date) VALUES (:data, :format, :date)");
+                rescheduled.push_back({lastSeen + m_staleBarcodeTtl, lastSeen, ev.data, true});
             }
-            addBarcode.bindValue(":data", data);
-            addBarcode.bindValue(":format", format);
-            addBarcode.bindValue(":date", QDateTime::currentMSecsSinceEpoch());
+        }
+    }
+
+    for (auto &ev: rescheduled)
+    {
+        m_expiryQueue.push_back(std::move(ev));
+        std::push_heap(m_expiryQueue.begin(), m_expiryQueue.end(), expiresLater);
+    }
+
+    m_barcodes_onscreen->setOffScreen(hidden);
+    if (!evicted.empty())
+    {
+        m_barcodes_onscreen->remove(std::move(evicted));
+        Q_EMIT barcodesChanged();
+    }
+
+    if (!m_expiryQueue.empty())
+    {
+        const qint64 delay = m_expiryQueue.front().deadline - QDateTime::currentMSecsSinceEpoch();
+        m_expiryTimer.start(int(std::clamp<qint64>(delay, 0, std::numeric_limits<int>::max())));
+    }
+}
+
+/* ************************************************************************** */
+
+void BarcodeManager::loadHistory()
+{
+    std::vector<Barcode> entries;
+    m_historyIndex.clear();
 
-            if (addBarcode.exec() == false)
+    DatabaseManager *db = DatabaseManager::getInstance();
+    if (db && db->hasDatabaseInternal())
+    {
+        // Load saved barcodes
+        QSqlQuery loadBarcodes;
+        bool status = loadBarcodes.exec("SELECT data, format, encoding, ecc, date, lat, long, starred FROM barcodes");
+        if (status)
+        {
+            while (loadBarcodes.next())
             {
-                qWarning() << "> addBarcode.exec() ERROR"
-                           << addBarcode.lastError().type() << ":" << addBarcode.lastError().text();
+                QString barcodeData = loadBarcodes.value(0).toString();
+                QString barcodeFormat = loadBarcodes.value(1).toString();
+                QString barcodeEncoding = loadBarcodes.value(2).toString();
+                QString barcodeEcc = loadBarcodes.value(3).toString();
+                qint64 barcodeDate = loadBarcodes.value(4).toLongLong();
+                double barcodeLatitude = loadBarcodes.value(5).toDouble();
+                double barcodeLongitude = loadBarcodes.value(6).toDouble();
+                bool barcodeStarred = loadBarcodes.value(7).toBool();
+
+                entries.emplace_back(barcodeData, barcodeFormat, barcodeEncoding, barcodeEcc,
+                                     barcodeDate, barcodeLatitude, barcodeLongitude, barcodeStarred);
+                m_historyIndex.add(barcodeData, entries.back().getContent(), barcodeFormat);
             }
         }
+        else
+        {
+            qWarning() << "> loadBarcodes.exec() ERROR"
+                       << loadBarcodes.lastError().type() << ":" << loadBarcodes.lastError().text();
+        }
     }
+
+    m_barcodes_history->setEntries(std::move(entries));
+    m_historySearch->refresh();
+    Q_EMIT historyChanged();
 }
 
-void BarcodeManager::removeHistory(const QString &data)
+void BarcodeManager::addHistory(const QString &data, const QString &format,
+                                const QString &enc, const QString &ecc,
+                                const QGeoCoordinate &coord)
 {
     if (!data.isEmpty())
     {
-        for (auto bc: std::as_const(m_barcodes_history)) // barcode already exists
+        // check if exists
+        if (m_barcodes_history->contains(data))
         {
-            Barcode *bbc = qobject_cast<Barcode*>(bc);
-            if (bbc && (bbc->getData() == data))
-            {
-                qDebug() << "removeHistory(" << data << ")";
+            //qDebug() << "addHistory(" << data << ") EXIST ALREADY";
+            return;
+        }
 
-                // remove barcode from the history list
-                m_barcodes_history.removeAll(bbc);
-                Q_EMIT historyChanged();
+        qDebug() << "addHistory(" << data << ")";
 
-                // remove barcode from the history database
-                QSqlQuery removeBarcode;
-                removeBarcode.prepare("DELETE FROM barcodes WHERE data = :data");
-                removeBarcode.bindValue(":data", bbc->getData());
+        const Barcode bc(data, format, enc, ecc,
+                         QDateTime::currentMSecsSinceEpoch(),
+                         coord.latitude(), coord.longitude());
 
-                if (removeBarcode.exec() == false)
-                {
-                    qWarning() << "> removeBarcode.exec() ERROR"
-                               << removeBarcode.lastError().type() << ":" << removeBarcode.lastError().text();
-                }
+        // add barcode to the history list
+        m_barcodes_history->append(bc);
+        m_historyIndex.add(data, bc.getContent(), format);
+        m_historySearch->refresh();
+        Q_EMIT historyChanged();
 
-                return;
-            }
+        // add barcode to the history database
+        QSqlQuery addBarcode;
+        if (coord.isValid() && (coord.latitude() != 0.0 || coord.longitude() != 0.0))
+        {
+            addBarcode.prepare("INSERT INTO barcodes (data, format, date, lat, long) VALUES (:data, :format, :date, :latitude, :longitude)");
+            addBarcode.bindValue(":latitude", coord.latitude());
+            addBarcode.bindValue(":longitude", coord.longitude());
+        }
+        else
+        {
+            addBarcode.prepare("INSERT INTO barcodes (data, format, date) VALUES (:data, :format, :date)");
+        }
+        addBarcode.bindValue(":data", data);
+        addBarcode.bindValue(":format", format);
+        addBarcode.bindValue(":date", bc.getDateMs());
+
+        if (addBarcode.exec() == false)
+        {
+            qWarning() << "> addBarcode.exec() ERROR"
+                       << addBarcode.lastError().type() << ":" << addBarcode.lastError().text();
         }
     }
 }
 
+void BarcodeManager::removeHistory(const QString &data)
+{
+    if (!data.isEmpty() && m_barcodes_history->remove(data))
+    {
+        qDebug() << "removeHistory(" << data << ")";
+
+        m_historyIndex.remove(data);
+        m_historySearch->refresh();
+        Q_EMIT historyChanged();
+
+        // remove barcode from the history database
+        QSqlQuery removeBarcode;
+        removeBarcode.prepare("DELETE FROM barcodes WHERE data = :data");
+        removeBarcode.bindValue(":data", data);
+
+        if (removeBarcode.exec() == false)
+        {
+            qWarning() << "> removeBarcode.exec() ERROR"
+                       << removeBarcode.lastError().type() << ":" << removeBarcode.lastError().text();
+        }
+    }
+}
+
+QVariantList BarcodeManager::searchHistory(const QString &query, const int limit) const
+{
+    QVariantList results;
+
+    for (const auto &m: m_historyIndex.search(query, limit))
+    {
+        results.push_back(m_barcodes_history->get(m_barcodes_history->rowOf(m_historyIndex.key(m.id))));
+    }
+
+    return results;
+}
+
 /* ************************************************************************** */
@@ -23,16 +23,20 @@
 #define BARCODE_MANAGER_H
 /* ************************************************************************** */
 
+#include "BarcodeHistoryModel.h"
+#include "BarcodeOnScreenModel.h"
+#include "HistorySearchIndex.h"
+#include "HistorySearchModel.h"
+
 #include <QObject>
+#include <QTimer>
 #include <QUrl>
+#include <QPolygonF>
 #include <QString>
 #include <QDateTime>
 #include <QGeoCoordinate>
 
-class QNetworkAccessManager;
-class QNetworkReply;
-
-class Barcode;
+#include <vector>
 
 /* ************************************************************************** */
 
@@ -45,17 +49,40 @@ class BarcodeManager: public QObject
 
     Q_PROPERTY(bool hasBarcodes READ hasBarcodes NOTIFY barcodesChanged)
     Q_PROPERTY(int barcodesCount READ getBarcodesCount NOTIFY barcodesChanged)
-    Q_PROPERTY(QVariant barcodes READ getBarcodes NOTIFY barcodesChanged)
+    Q_PROPERTY(BarcodeOnScreenModel *barcodes READ getBarcodes CONSTANT)
+    Q_PROPERTY(int staleBarcodeTtl READ getStaleBarcodeTtl WRITE setStaleBarcodeTtl NOTIFY staleBarcodeTtlChanged)
 
     Q_PROPERTY(bool hasBarcodesHistory READ hasBarcodesHistory NOTIFY historyChanged)
     Q_PROPERTY(int barcodesHistoryCount READ getBarcodesHistoryCount NOTIFY historyChanged)
-    Q_PROPERTY(QVariant barcodesHistory READ getBarcodesHistory NOTIFY historyChanged)
+    Q_PROPERTY(BarcodeHistoryModel *barcodesHistory READ getBarcodesHistory CONSTANT)
+    Q_PROPERTY(HistorySearchModel *historySearch READ getHistorySearch CONSTANT)
+
+    BarcodeOnScreenModel *m_barcodes_onscreen = nullptr;
+    BarcodeHistoryModel *m_barcodes_history = nullptr;
+
+    //! Onscreen barcodes expiry: a min-heap of deadlines, served by a single timer
+    //! armed on the earliest one. Events are validated (and possibly pushed back)
+    //! when they are due, so detections never touch the heap.
+    struct ExpiryEvent
+    {
+        qint64 deadline = 0;
+        qint64 lastSeen = 0;    //!< eviction is dropped if the barcode has been seen since
+        QString data;
+        bool evict = false;
+    };
+    std::vector<ExpiryEvent> m_expiryQueue;
+    QTimer m_expiryTimer;
 
-    QList <QObject *> m_barcodes_onscreen;
-    QList <QObject *> m_barcodes_history;
+    static const int s_onScreenTimeoutMs = 1000;
+    static const int s_expiryCoalesceMs = 50;
+    int m_staleBarcodeTtl = 30000;
 
-    QNetworkAccessManager *m_nwManager = nullptr;
-    QNetworkReply *firmwareReply = nullptr;
+    void scheduleExpiry(ExpiryEvent &&ev);
+    void clearExpiry();
+    void processExpiry();
+
+    HistorySearchIndex m_historyIndex;
+    HistorySearchModel *m_historySearch = nullptr;
 
     QStringList m_colorsAvailable = {
         "HotPink", "Tomato", "Yellow", "Orange", "OrangeRed", "DarkOrange",
@@ -68,11 +95,12 @@ class BarcodeManager: public QObject
 
     static BarcodeManager *instance;
     BarcodeManager();
-    ~BarcodeManager();
+    ~BarcodeManager() = default;
 
 Q_SIGNALS:
     void barcodesChanged();
     void historyChanged();
+    void staleBarcodeTtlChanged();
 
 public:
     static BarcodeManager *getInstance();
@@ -83,19 +111,30 @@ public:
                                 const QString &enc, const QString &ecc,
                                 const QPointF &p1, const QPointF &p2,  const QPointF &p3, const QPointF &p4,
                                 const bool fromVideo = true);
+    Q_INVOKABLE bool addBarcode(const QString &data, const QString &format,
+                                const QString &enc, const QString &ecc,
+                                const QPolygonF &quad,
+                                const bool fromVideo = true);
+
+    void loadHistory();
 
     Q_INVOKABLE void addHistory(const QString &data, const QString &format,
                                 const QString &enc, const QString &ecc,
                                 const QGeoCoordinate &coord);
     Q_INVOKABLE void removeHistory(const QString &data);
-
-    bool hasBarcodes() const { return !m_barcodes_onscreen.isEmpty(); }
-    int getBarcodesCount() const { return m_barcodes_onscreen.size(); }
-    QVariant getBarcodes() const { return QVariant::fromValue(m_barcodes_onscreen); };
-
-    bool hasBarcodesHistory() const { return !m_barcodes_history.isEmpty(); }
-    int getBarcodesHistoryCount() const { return m_barcodes_history.size(); }
-    QVariant getBarcodesHistory() const { return QVariant::fromValue(m_barcodes_history); };
+    Q_INVOKABLE QVariantList searchHistory(const QString &query, const int limit = 32) const;
+
+    bool hasBarcodes() const { return m_barcodes_onscreen->getCount() > 0; }
+    int getBarcodesCount() const { return m_barcodes_onscreen->getCount(); }
+    BarcodeOnScreenModel *getBarcodes() const { return m_barcodes_onscreen; }
+    int getStaleBarcodeTtl() const { return m_staleBarcodeTtl; }
+    void setStaleBarcodeTtl(const int ttl);
+
+    bool hasBarcodesHistory() const { return m_barcodes_history->getCount() > 0; }
+    int getBarcodesHistoryCount() const { return m_barcodes_history->getCount(); }
+    BarcodeHistoryModel *getBarcodesHistory() const { return m_barcodes_history; }
+    const BarcodeHistoryModel *getHistoryModel() const { return m_barcodes_history; }
+    HistorySearchModel *getHistorySearch() const { return m_historySearch; }
 };
 
 /* ************************************************************************** */
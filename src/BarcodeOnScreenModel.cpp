@@ -0,0 +1,176 @@
+/*!
+ * This file is part of QmlMobileScanner.
+ * Copyright (c) 2023 Emeric Grange - All Rights Reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \date      2026
+ * \author    Emeric Grange <emeric.grange@gmail.com>
+ */
+
+#include "BarcodeOnScreenModel.h"
+
+#include <QDateTime>
+
+#include <algorithm>
+
+/* ************************************************************************** */
+
+BarcodeOnScreenModel::BarcodeOnScreenModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+    //
+}
+
+/* ************************************************************************** */
+
+void BarcodeOnScreenModel::clear()
+{
+    beginResetModel();
+    m_entries.clear();
+    m_rows.clear();
+    endResetModel();
+
+    Q_EMIT countChanged();
+}
+
+void BarcodeOnScreenModel::add(const Barcode &bc, const QColor &color, const QPolygonF &quad)
+{
+    const int row = int(m_entries.size());
+
+    beginInsertRows(QModelIndex(), row, row);
+    m_entries.push_back({bc, color, quad, QDateTime::currentMSecsSinceEpoch(), true});
+    m_rows.insert(bc.getData(), row);
+    endInsertRows();
+
+    Q_EMIT countChanged();
+}
+
+void BarcodeOnScreenModel::update(const int row, const QPolygonF &quad)
+{
+    if (row < 0 || row >= int(m_entries.size())) return;
+
+    Entry &e = m_entries[row];
+    e.coordinates = quad;
+    e.lastSeen = QDateTime::currentMSecsSinceEpoch();
+    e.onScreen = true;
+
+    const QModelIndex idx = index(row);
+    Q_EMIT dataChanged(idx, idx, {OnScreenRole, LastSeenRole, LastCoordinatesRole});
+}
+
+void BarcodeOnScreenModel::setOffScreen(const std::vector<int> &rows)
+{
+    int first = int(m_entries.size());
+    int last = -1;
+
+    for (const int row: rows)
+    {
+        if (row < 0 || row >= int(m_entries.size())) continue;
+
+        m_entries[row].onScreen = false;
+        first = std::min(first, row);
+        last = std::max(last, row);
+    }
+
+    // one notification covering the whole batch
+    if (last >= first)
+    {
+        Q_EMIT dataChanged(index(first), index(last), {OnScreenRole});
+    }
+}
+
+void BarcodeOnScreenModel::remove(std::vector<int> rows)
+{
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+    rows.erase(std::remove_if(rows.begin(), rows.end(),
+                              [this](int r) { return r < 0 || r >= int(m_entries.size()); }), rows.end());
+    if (rows.empty()) return;
+
+    // a single contiguous range is removed as such, anything else resets the model
+    const bool contiguous = (rows.back() - rows.front() + 1 == int(rows.size()));
+    if (contiguous) beginRemoveRows(QModelIndex(), rows.front(), rows.back());
+    else beginResetModel();
+
+    size_t next = 0, out = 0;
+    for (size_t i = 0; i < m_entries.size(); i++)
+    {
+        if (next < rows.size() && rows[next] == int(i)) { next++; continue; }
+        if (out != i) m_entries[out] = std::move(m_entries[i]);
+        out++;
+    }
+    m_entries.resize(out);
+
+    m_rows.clear();
+    for (size_t i = 0; i < m_entries.size(); i++)
+    {
+        m_rows.insert(m_entries[i].barcode.getData(), int(i));
+    }
+
+    if (contiguous) endRemoveRows();
+    else endResetModel();
+
+    Q_EMIT countChanged();
+}
+
+QVariantMap BarcodeOnScreenModel::get(const int row) const
+{
+    if (row < 0 || row >= int(m_entries.size())) return QVariantMap();
+
+    const Entry &e = m_entries[row];
+    QVariantMap map = e.barcode.toVariantMap();
+    map.insert("isOnScreen", e.onScreen);
+    map.insert("lastSeen", QDateTime::fromMSecsSinceEpoch(e.lastSeen));
+    map.insert("color", e.color);
+
+    return map;
+}
+
+/* ************************************************************************** */
+
+int BarcodeOnScreenModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) return 0;
+    return int(m_entries.size());
+}
+
+QVariant BarcodeOnScreenModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= int(m_entries.size())) return QVariant();
+
+    const Entry &e = m_entries[index.row()];
+    switch (role)
+    {
+        case OnScreenRole: return e.onScreen;
+        case LastSeenRole: return QDateTime::fromMSecsSinceEpoch(e.lastSeen);
+        case LastCoordinatesRole: return QVariant::fromValue(e.coordinates); // implicitly shared, no copy
+        case ColorRole: return e.color;
+    }
+
+    return BarcodeHistoryModel::barcodeData(e.barcode, role);
+}
+
+QHash<int, QByteArray> BarcodeOnScreenModel::roleNames() const
+{
+    QHash<int, QByteArray> roles = BarcodeHistoryModel::barcodeRoleNames();
+    roles.insert(OnScreenRole, "isOnScreen");
+    roles.insert(LastSeenRole, "lastSeen");
+    roles.insert(LastCoordinatesRole, "lastCoordinates");
+    roles.insert(ColorRole, "color");
+
+    return roles;
+}
+
+/* ************************************************************************** */
@@ -0,0 +1,99 @@
+/*!
+ * This file is part of QmlMobileScanner.
+ * Copyright (c) 2023 Emeric Grange - All Rights Reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \date      2026
+ * \author    Emeric Grange <emeric.grange@gmail.com>
+ */
+
+#ifndef BARCODE_ONSCREEN_MODEL_H
+#define BARCODE_ONSCREEN_MODEL_H
+/* ************************************************************************** */
+
+#include "Barcode.h"
+#include "BarcodeHistoryModel.h"
+
+#include <QAbstractListModel>
+#include <QColor>
+#include <QPolygonF>
+#include <QHash>
+
+#include <vector>
+
+/* ************************************************************************** */
+
+/*!
+ * \brief The BarcodeOnScreenModel class
+ *
+ * Barcodes currently (or recently) detected by the reader, in detection order.
+ * Repeated detections only update their row. Expiry is driven from outside
+ * (see BarcodeManager), which hides and evicts entries in batches.
+ */
+class BarcodeOnScreenModel: public QAbstractListModel
+{
+    Q_OBJECT
+
+    Q_PROPERTY(int count READ getCount NOTIFY countChanged)
+
+    struct Entry
+    {
+        Barcode barcode;
+        QColor color;
+        QPolygonF coordinates;      //!< the four corners, as received
+        qint64 lastSeen = 0;
+        bool onScreen = true;
+    };
+
+    std::vector<Entry> m_entries;
+    QHash<QString, int> m_rows;
+
+Q_SIGNALS:
+    void countChanged();
+
+public:
+    enum OnScreenRoles {
+        OnScreenRole = BarcodeHistoryModel::LastBarcodeRole,
+        LastSeenRole,
+        LastCoordinatesRole,
+        ColorRole,
+    };
+
+    explicit BarcodeOnScreenModel(QObject *parent = nullptr);
+    ~BarcodeOnScreenModel() = default;
+
+    void clear();
+    void add(const Barcode &bc, const QColor &color, const QPolygonF &quad);
+    void update(const int row, const QPolygonF &quad);
+
+    //! Batched expiry, each call emits a single change notification.
+    void setOffScreen(const std::vector<int> &rows);
+    void remove(std::vector<int> rows);
+
+    int rowOf(const QString &data) const { return m_rows.value(data, -1); }
+    const QString &dataAt(const int row) const { return m_entries[row].barcode.getData(); }
+    qint64 lastSeen(const int row) const { return m_entries[row].lastSeen; }
+    bool isOnScreen(const int row) const { return m_entries[row].onScreen; }
+
+    int getCount() const { return int(m_entries.size()); }
+    Q_INVOKABLE QVariantMap get(const int row) const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+};
+
+/* ************************************************************************** */
+#endif // BARCODE_ONSCREEN_MODEL_H
@@ -266,6 +266,16 @@ void DatabaseManager::createDatabase()
                        << createBarcodes.lastError().type() << ":" << createBarcodes.lastError().text();
         }
     }
+
+    {
+        // history entries are looked up by payload (deduplication, removal, imports)
+        QSqlQuery createBarcodesIndex;
+        if (createBarcodesIndex.exec("CREATE INDEX IF NOT EXISTS barcodes_data ON barcodes (data);") == false)
+        {
+            qWarning() << "> createBarcodesIndex.exec() ERROR"
+                       << createBarcodesIndex.lastError().type() << ":" << createBarcodesIndex.lastError().text();
+        }
+    }
 }
 
 /* ************************************************************************** */
@@ -0,0 +1,234 @@
+/*!
+ * This file is part of QmlMobileScanner.
+ * Copyright (c) 2023 Emeric Grange - All Rights Reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \date      2026
+ * \author    Emeric Grange <emeric.grange@gmail.com>
+ */
+
+#include "HistorySearchIndex.h"
+
+#include <algorithm>
+
+/* ************************************************************************** */
+
+std::vector<quint64> HistorySearchIndex::trigrams(const QString &text)
+{
+    std::vector<quint64> grams;
+    if (text.size() < 3) return grams;
+
+    grams.reserve(text.size() - 2);
+    for (qsizetype i = 0; i + 2 < text.size(); i++)
+    {
+        grams.push_back((quint64(text.at(i).unicode()) << 32) |
+                        (quint64(text.at(i+1).unicode()) << 16) |
+                         quint64(text.at(i+2).unicode()));
+    }
+
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+
+    return grams;
+}
+
+/* ************************************************************************** */
+
+void HistorySearchIndex::clear()
+{
+    m_docs.clear();
+    m_ids.clear();
+    m_postings.clear();
+    m_alive = 0;
+}
+
+void HistorySearchIndex::add(const QString &data, const QString &content, const QString &format)
+{
+    if (m_ids.contains(data)) remove(data);
+
+    Document doc;
+    doc.key = data;
+    doc.text = data.toLower() + QChar(0x1f) + content.toLower() + QChar(0x1f) + format.toLower();
+    doc.dataLength = data.size();
+
+    const quint32 id = quint32(m_docs.size());
+    for (const quint64 gram: trigrams(doc.text))
+    {
+        m_postings[gram].push_back(id);
+    }
+
+    m_docs.push_back(std::move(doc));
+    m_ids.insert(data, id);
+    m_alive++;
+}
+
+void HistorySearchIndex::remove(const QString &data)
+{
+    auto it = m_ids.find(data);
+    if (it == m_ids.end()) return;
+
+    const quint32 id = it.value();
+    m_ids.erase(it);
+
+    Document &doc = m_docs[id];
+    for (const quint64 gram: trigrams(doc.text))
+    {
+        auto pit = m_postings.find(gram);
+        if (pit == m_postings.end()) continue;
+
+        std::vector<quint32> &ids = pit.value();
+        auto iit = std::lower_bound(ids.begin(), ids.end(), id);
+        if (iit != ids.end() && *iit == id) ids.erase(iit);
+        if (ids.empty()) m_postings.erase(pit);
+    }
+
+    // the slot is not reused, ids must keep growing: tombstones are compacted once they add up
+    doc = Document();
+    m_alive--;
+
+    const int tombstones = int(m_docs.size()) - m_alive;
+    if (tombstones > std::max(s_minTombstones, m_alive / 2)) compact();
+}
+
+void HistorySearchIndex::compact()
+{
+    // renumbering in order keeps the posting lists sorted
+    std::vector<quint32> newIds(m_docs.size(), 0);
+    std::vector<Document> docs;
+    docs.reserve(m_alive);
+    for (size_t id = 0; id < m_docs.size(); id++)
+    {
+        if (m_docs[id].key.isEmpty()) continue;
+
+        newIds[id] = quint32(docs.size());
+        docs.push_back(std::move(m_docs[id]));
+    }
+    m_docs.swap(docs);
+
+    // removed ids are already gone from the posting lists
+    for (auto it = m_ids.begin(); it != m_ids.end(); ++it)
+    {
+        it.value() = newIds[it.value()];
+    }
+    for (auto &ids: m_postings)
+    {
+        for (quint32 &id: ids) id = newIds[id];
+    }
+}
+
+QString HistorySearchIndex::key(const quint32 id) const
+{
+    if (id >= m_docs.size()) return QString();
+    return m_docs[id].key;
+}
+
+/* ************************************************************************** */
+
+QStringList HistorySearchIndex::parseQuery(const QString &query)
+{
+    QStringList terms = query.toLower().split(QChar(' '), Qt::SkipEmptyParts);
+    terms.removeDuplicates();
+    return terms;
+}
+
+std::vector<quint32> HistorySearchIndex::candidates(const QStringList &terms) const
+{
+    std::vector<quint32> result;
+
+    // gather the posting lists of every query trigram, the shortest one drives the intersection
+    std::vector<const std::vector<quint32> *> lists;
+    for (const QString &term: terms)
+    {
+        for (const quint64 gram: trigrams(term))
+        {
+            auto pit = m_postings.constFind(gram);
+            if (pit == m_postings.constEnd()) return result; // cannot match anything
+            lists.push_back(&pit.value());
+        }
+    }
+
+    if (lists.empty())
+    {
+        // query too short for trigrams, every entry is a candidate
+        result.reserve(m_alive);
+        for (qsizetype id = qsizetype(m_docs.size()) - 1; id >= 0; id--)
+        {
+            if (!m_docs[id].key.isEmpty()) result.push_back(quint32(id));
+        }
+        return result;
+    }
+
+    std::sort(lists.begin(), lists.end(),
+              [](const auto *a, const auto *b) { return a->size() < b->size(); });
+
+    result.reserve(lists.front()->size());
+    for (auto it = lists.front()->rbegin(); it != lists.front()->rend(); ++it)
+    {
+        const quint32 id = *it;
+        bool inAll = true;
+        for (size_t i = 1; i < lists.size() && inAll; i++)
+        {
+            inAll = std::binary_search(lists[i]->begin(), lists[i]->end(), id);
+        }
+        if (inAll) result.push_back(id);
+    }
+
+    return result;
+}
+
+int HistorySearchIndex::score(const quint32 id, const QStringList &terms) const
+{
+    if (id >= m_docs.size() || m_docs[id].key.isEmpty()) return 0;
+
+    const Document &doc = m_docs[id];
+    int total = 0;
+
+    for (const QString &term: terms)
+    {
+        const qsizetype pos = doc.text.indexOf(term);
+        if (pos < 0) return 0;
+
+        if (pos == 0 && term.size() == doc.dataLength) total += 100;    // exact match
+        else if (pos == 0) total += 50;                                 // prefix match
+        else if (pos < doc.dataLength && !doc.text.at(pos-1).isLetterOrNumber()) total += 20; // word prefix
+        else if (pos < doc.dataLength) total += 10;                     // data substring
+        else total += 5;                                                // content type or format
+    }
+
+    return total;
+}
+
+std::vector<HistorySearchIndex::Match> HistorySearchIndex::search(const QString &query, const int limit) const
+{
+    std::vector<Match> matches;
+
+    const QStringList terms = parseQuery(query);
+    if (terms.isEmpty() || limit <= 0) return matches;
+
+    for (const quint32 id: candidates(terms))
+    {
+        const int s = score(id, terms);
+        if (s > 0) matches.push_back({id, s});
+    }
+
+    // candidates are newest first, a stable sort keeps that order between equal scores
+    std::stable_sort(matches.begin(), matches.end(),
+                     [](const Match &a, const Match &b) { return a.score > b.score; });
+    if (matches.size() > size_t(limit)) matches.resize(limit);
+
+    return matches;
+}
+
+/* ************************************************************************** */
@@ -0,0 +1,96 @@
+/*!
+ * This file is part of QmlMobileScanner.
+ * Copyright (c) 2023 Emeric Grange - All Rights Reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \date      2026
+ * \author    Emeric Grange <emeric.grange@gmail.com>
+ */
+
+#ifndef HISTORY_SEARCH_INDEX_H
+#define HISTORY_SEARCH_INDEX_H
+/* ************************************************************************** */
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+
+#include <vector>
+
+/* ************************************************************************** */
+
+/*!
+ * \brief In-process trigram index over the scan history.
+ *
+ * Each entry indexes its data, content type and format (lowercased).
+ * Query terms of 3+ characters are narrowed down through the trigram posting
+ * lists, candidates are then verified and ranked with score().
+ *
+ * Document ids follow the insertion order, so posting lists stay sorted,
+ * newest entries having the highest ids (the history order). Removed entries
+ * leave a tombstone, compacted away once they outnumber half the alive entries:
+ * ids are only valid until the next add() or remove().
+ */
+class HistorySearchIndex
+{
+public:
+    struct Match
+    {
+        quint32 id;
+        int score;
+    };
+
+    void clear();
+
+    //! Entries are identified by their data (history payloads are unique).
+    void add(const QString &data, const QString &content, const QString &format);
+    void remove(const QString &data);
+
+    int size() const { return m_alive; }
+    QString key(const quint32 id) const;
+
+    //! Split a user query into lowercased terms (all terms must match).
+    static QStringList parseQuery(const QString &query);
+
+    //! Candidate ids for a query, newest first. Every alive entry if no term is long enough.
+    std::vector<quint32> candidates(const QStringList &terms) const;
+
+    //! Rank an entry against query terms, 0 meaning no match.
+    int score(const quint32 id, const QStringList &terms) const;
+
+    //! Synchronous search, best matches first.
+    std::vector<Match> search(const QString &query, const int limit) const;
+
+private:
+    struct Document
+    {
+        QString key;
+        QString text;               //!< "data \x1f content \x1f format", lowercased
+        qsizetype dataLength = 0;
+    };
+
+    std::vector<Document> m_docs;
+    QHash<QString, quint32> m_ids;
+    QHash<quint64, std::vector<quint32>> m_postings;
+    int m_alive = 0;
+
+    static constexpr int s_minTombstones = 64;
+
+    void compact();
+    static std::vector<quint64> trigrams(const QString &text);
+};
+
+/* ************************************************************************** */
+#endif // HISTORY_SEARCH_INDEX_H
@@ -0,0 +1,177 @@
+/*!
+ * This file is part of QmlMobileScanner.
+ * Copyright (c) 2023 Emeric Grange - All Rights Reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \date      2026
+ * \author    Emeric Grange <emeric.grange@gmail.com>
+ */
+
+#include "HistorySearchModel.h"
+#include "BarcodeHistoryModel.h"
+
+#include <QElapsedTimer>
+
+#include <algorithm>
+
+/* ************************************************************************** */
+
+HistorySearchModel::HistorySearchModel(const HistorySearchIndex *index, const BarcodeHistoryModel *history,
+                                       QObject *parent)
+    : QAbstractListModel(parent), m_index(index), m_history(history)
+{
+    m_sliceTimer.setSingleShot(true);
+    m_sliceTimer.setInterval(0);
+    connect(&m_sliceTimer, &QTimer::timeout, this, &HistorySearchModel::processSlice);
+}
+
+/* ************************************************************************** */
+
+void HistorySearchModel::setQuery(const QString &query)
+{
+    if (m_query != query)
+    {
+        m_query = query;
+        Q_EMIT queryChanged();
+
+        refresh();
+    }
+}
+
+void HistorySearchModel::setSearching(const bool value)
+{
+    if (m_searching != value)
+    {
+        m_searching = value;
+        Q_EMIT searchingChanged();
+    }
+}
+
+void HistorySearchModel::refresh()
+{
+    m_sliceTimer.stop();
+    m_terms = HistorySearchIndex::parseQuery(m_query);
+
+    beginResetModel();
+    m_results.clear();
+    endResetModel();
+    Q_EMIT countChanged();
+
+    m_pending.clear();
+    m_pendingPos = 0;
+
+    if (m_terms.isEmpty() || !m_index)
+    {
+        setSearching(false);
+        return;
+    }
+
+    m_pending = m_index->candidates(m_terms);
+    setSearching(true);
+
+    // first slice right away, so the best matches are visible on the next frame
+    processSlice();
+}
+
+void HistorySearchModel::processSlice()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    std::vector<HistorySearchIndex::Match> found;
+    while (m_pendingPos < m_pending.size())
+    {
+        const quint32 id = m_pending[m_pendingPos++];
+        const int s = m_index->score(id, m_terms);
+        if (s > 0) found.push_back({id, s});
+
+        if ((m_pendingPos % 64) == 0 && timer.nsecsElapsed() > s_sliceBudgetNs) break;
+    }
+
+    insertResults(found);
+
+    if (m_pendingPos < m_pending.size())
+    {
+        m_sliceTimer.start();
+    }
+    else
+    {
+        m_pending.clear();
+        m_pendingPos = 0;
+        setSearching(false);
+    }
+}
+
+void HistorySearchModel::insertResults(std::vector<HistorySearchIndex::Match> &found)
+{
+    if (found.empty()) return;
+
+    // candidates come newest first, a stable sort keeps that order between equal scores
+    std::stable_sort(found.begin(), found.end(),
+                     [](const auto &a, const auto &b) { return a.score > b.score; });
+
+    for (const auto &m: found)
+    {
+        auto it = std::upper_bound(m_results.begin(), m_results.end(), m,
+                                   [](const auto &a, const auto &b) { return a.score > b.score; });
+        const int row = int(it - m_results.begin());
+        if (row >= s_maxResults) continue;
+
+        beginInsertRows(QModelIndex(), row, row);
+        m_results.insert(it, m);
+        endInsertRows();
+
+        if (m_results.size() > size_t(s_maxResults))
+        {
+            beginRemoveRows(QModelIndex(), s_maxResults, s_maxResults);
+            m_results.pop_back();
+            endRemoveRows();
+        }
+    }
+
+    Q_EMIT countChanged();
+}
+
+/* ************************************************************************** */
+
+int HistorySearchModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) return 0;
+    return int(m_results.size());
+}
+
+QVariant HistorySearchModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= int(m_results.size())) return QVariant();
+
+    const int row = m_history->rowOf(m_index->key(m_results[index.row()].id));
+    if (row < 0) return QVariant();
+
+    return m_history->data(m_history->index(row), role);
+}
+
+QHash<int, QByteArray> HistorySearchModel::roleNames() const
+{
+    return BarcodeHistoryModel::barcodeRoleNames();
+}
+
+QVariantMap HistorySearchModel::get(const int row) const
+{
+    if (row < 0 || row >= int(m_results.size())) return QVariantMap();
+
+    return m_history->get(m_history->rowOf(m_index->key(m_results[row].id)));
+}
+
+/* ************************************************************************** */
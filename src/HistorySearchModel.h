@@ -0,0 +1,100 @@
+/*!
+ * This file is part of QmlMobileScanner.
+ * Copyright (c) 2023 Emeric Grange - All Rights Reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \date      2026
+ * \author    Emeric Grange <emeric.grange@gmail.com>
+ */
+
+#ifndef HISTORY_SEARCH_MODEL_H
+#define HISTORY_SEARCH_MODEL_H
+/* ************************************************************************** */
+
+#include "HistorySearchIndex.h"
+
+class BarcodeHistoryModel;
+
+#include <QAbstractListModel>
+#include <QTimer>
+
+#include <vector>
+
+/* ************************************************************************** */
+
+/*!
+ * \brief Ranked search results over the scan history, for QML.
+ *
+ * Setting the query restarts the search. Candidates are verified in time
+ * slices, so rows are streamed into the model (in rank order) without ever
+ * blocking a frame, even on very large histories.
+ *
+ * Rows expose the same roles as the BarcodeHistoryModel they search into.
+ */
+class HistorySearchModel: public QAbstractListModel
+{
+    Q_OBJECT
+
+    Q_PROPERTY(QString query READ getQuery WRITE setQuery NOTIFY queryChanged)
+    Q_PROPERTY(bool searching READ isSearching NOTIFY searchingChanged)
+    Q_PROPERTY(int count READ getCount NOTIFY countChanged)
+
+    static const int s_maxResults = 256;
+    static const qint64 s_sliceBudgetNs = 4000000; // 4 ms
+
+    const HistorySearchIndex *m_index = nullptr;
+    const BarcodeHistoryModel *m_history = nullptr;
+
+    QString m_query;
+    QStringList m_terms;
+    bool m_searching = false;
+
+    std::vector<HistorySearchIndex::Match> m_results;
+
+    std::vector<quint32> m_pending;
+    size_t m_pendingPos = 0;
+    QTimer m_sliceTimer;
+
+    void processSlice();
+    void insertResults(std::vector<HistorySearchIndex::Match> &found);
+    void setSearching(const bool value);
+
+Q_SIGNALS:
+    void queryChanged();
+    void searchingChanged();
+    void countChanged();
+
+public:
+    explicit HistorySearchModel(const HistorySearchIndex *index, const BarcodeHistoryModel *history,
+                                QObject *parent = nullptr);
+    ~HistorySearchModel() = default;
+
+    QString getQuery() const { return m_query; }
+    void setQuery(const QString &query);
+    bool isSearching() const { return m_searching; }
+    int getCount() const { return int(m_results.size()); }
+
+    //! Restart the current query, after the history changed.
+    void refresh();
+
+    Q_INVOKABLE QVariantMap get(const int row) const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+};
+
+/* ************************************************************************** */
+#endif // HISTORY_SEARCH_MODEL_H
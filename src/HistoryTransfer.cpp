@@ -0,0 +1,480 @@
+/*!
+ * This file is part of QmlMobileScanner.
+ * Copyright (c) 2023 Emeric Grange - All Rights Reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \date      2026
+ * \author    Emeric Grange <emeric.grange@gmail.com>
+ */
+
+#include "HistoryTransfer.h"
+#include "BarcodeManager.h"
+#include "DatabaseManager.h"
+#include "utils_csv.h"
+
+#include <QFile>
+#include <QSaveFile>
+#include <QThread>
+#include <QDateTime>
+#include <QTimeZone>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonDocument>
+#include <QDebug>
+
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+
+/* ************************************************************************** */
+
+static const int s_chunkSize = 1000; //!< rows per write chunk / per import transaction
+
+enum class TransferFormat { CSV, JSONL, GeoJSON };
+
+static TransferFormat formatFromPath(const QString &path)
+{
+    if (path.endsWith(".jsonl", Qt::CaseInsensitive) || path.endsWith(".ndjson", Qt::CaseInsensitive))
+        return TransferFormat::JSONL;
+    if (path.endsWith(".geojson", Qt::CaseInsensitive) || path.endsWith(".json", Qt::CaseInsensitive))
+        return TransferFormat::GeoJSON;
+
+    return TransferFormat::CSV;
+}
+
+struct HistoryRow
+{
+    QString data;
+    QString format;
+    QString encoding;
+    QString ecc;
+    qint64 date = 0;
+    double lat = 0.0;
+    double lon = 0.0;
+    bool starred = false;
+
+    bool hasPosition() const { return (lat != 0.0 || lon != 0.0); }
+};
+
+/*!
+ * \brief Database connection owned by the worker thread.
+ *
+ * Qt SQL connections can only be used from the thread that created them.
+ */
+class WorkerConnection
+{
+    const QString m_name = QStringLiteral("HistoryTransfer");
+
+public:
+    explicit WorkerConnection(const QString &dbPath)
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", m_name);
+        db.setDatabaseName(dbPath);
+        if (!db.open()) qWarning() << "WorkerConnection() cannot open database" << db.lastError();
+    }
+    ~WorkerConnection()
+    {
+        {
+            QSqlDatabase db = QSqlDatabase::database(m_name, false);
+            db.close();
+        }
+        QSqlDatabase::removeDatabase(m_name);
+    }
+
+    QSqlDatabase database() const { return QSqlDatabase::database(m_name, false); }
+};
+
+/* ************************************************************************** */
+
+static QString dateToString(const qint64 msecs)
+{
+    return QDateTime::fromMSecsSinceEpoch(msecs, QTimeZone::UTC).toString(Qt::ISODateWithMs);
+}
+
+static qint64 dateFromString(const QString &str)
+{
+    bool isNumber = false;
+    const qint64 msecs = str.toLongLong(&isNumber);
+    if (isNumber) return msecs;
+
+    const QDateTime dt = QDateTime::fromString(str, Qt::ISODateWithMs);
+    if (dt.isValid()) return dt.toMSecsSinceEpoch();
+
+    return QDateTime::currentMSecsSinceEpoch();
+}
+
+static QJsonObject rowToJson(const HistoryRow &r)
+{
+    QJsonObject obj;
+    obj.insert("data", r.data);
+    obj.insert("format", r.format);
+    obj.insert("encoding", r.encoding);
+    obj.insert("ecc", r.ecc);
+    obj.insert("date", dateToString(r.date));
+    obj.insert("starred", r.starred);
+    return obj;
+}
+
+static void rowFromJson(const QJsonObject &obj, HistoryRow &r)
+{
+    r.data = obj.value("data").toString();
+    r.format = obj.value("format").toString();
+    r.encoding = obj.value("encoding").toString();
+    r.ecc = obj.value("ecc").toString();
+    r.date = obj.value("date").isDouble() ? obj.value("date").toInteger()
+                                          : dateFromString(obj.value("date").toString());
+    r.starred = obj.value("starred").toBool();
+    if (obj.contains("latitude")) r.lat = obj.value("latitude").toDouble();
+    if (obj.contains("longitude")) r.lon = obj.value("longitude").toDouble();
+}
+
+static QByteArray serializeRow(const HistoryRow &r, const TransferFormat fmt)
+{
+    if (fmt == TransferFormat::CSV)
+    {
+        QByteArray line = quoteCsvField(r.data) + ',' + quoteCsvField(r.format) + ',' +
+                          quoteCsvField(r.encoding) + ',' + quoteCsvField(r.ecc) + ',' +
+                          dateToString(r.date).toLatin1() + ',';
+        if (r.hasPosition()) line += QByteArray::number(r.lat, 'g', 10) + ',' + QByteArray::number(r.lon, 'g', 10);
+        else line += ',';
+        line += r.starred ? ",1\n" : ",0\n";
+        return line;
+    }
+
+    if (fmt == TransferFormat::JSONL)
+    {
+        QJsonObject obj = rowToJson(r);
+        if (r.hasPosition())
+        {
+            obj.insert("latitude", r.lat);
+            obj.insert("longitude", r.lon);
+        }
+        return QJsonDocument(obj).toJson(QJsonDocument::Compact) + '\n';
+    }
+
+    // GeoJSON feature, one per line so that imports can stream it back
+    QJsonObject feature;
+    feature.insert("type", "Feature");
+    if (r.hasPosition())
+    {
+        QJsonObject point;
+        point.insert("type", "Point");
+        point.insert("coordinates", QJsonArray{r.lon, r.lat});
+        feature.insert("geometry", point);
+    }
+    else
+    {
+        feature.insert("geometry", QJsonValue::Null);
+    }
+    feature.insert("properties", rowToJson(r));
+
+    return QJsonDocument(feature).toJson(QJsonDocument::Compact);
+}
+
+/* ************************************************************************** */
+
+static int exportRows(const QString &dbPath, const QString &filePath,
+                      const std::function<void(qint64, qint64)> &progress)
+{
+    const TransferFormat fmt = formatFromPath(filePath);
+
+    WorkerConnection connection(dbPath);
+    QSqlDatabase db = connection.database();
+    if (!db.isOpen()) return -1;
+
+    qint64 total = 0;
+    {
+        QSqlQuery countRows(db);
+        if (countRows.exec("SELECT COUNT(*) FROM barcodes") && countRows.next())
+            total = countRows.value(0).toLongLong();
+    }
+
+    QSaveFile out(filePath);
+    if (!out.open(QIODevice::WriteOnly))
+    {
+        qWarning() << "exportRows() cannot write" << filePath;
+        return -1;
+    }
+
+    // forward only: rows are stepped through, not cached by the driver
+    QSqlQuery rows(db);
+    rows.setForwardOnly(true);
+    if (!rows.exec("SELECT data, format, encoding, ecc, date, lat, long, starred FROM barcodes ORDER BY rowid"))
+    {
+        qWarning() << "> rows.exec() ERROR"
+                   << rows.lastError().type() << ":" << rows.lastError().text();
+        return -1;
+    }
+
+    QByteArray chunk;
+    if (fmt == TransferFormat::CSV) chunk = "data,format,encoding,ecc,date,latitude,longitude,starred\n";
+    else if (fmt == TransferFormat::GeoJSON) chunk = "{\"type\":\"FeatureCollection\",\"features\":[\n";
+
+    int count = 0;
+    while (rows.next())
+    {
+        HistoryRow r;
+        r.data = rows.value(0).toString();
+        r.format = rows.value(1).toString();
+        r.encoding = rows.value(2).toString();
+        r.ecc = rows.value(3).toString();
+        r.date = rows.value(4).toLongLong();
+        r.lat = rows.value(5).toDouble();
+        r.lon = rows.value(6).toDouble();
+        r.starred = rows.value(7).toBool();
+
+        if (fmt == TransferFormat::GeoJSON && count > 0) chunk += ",\n";
+        chunk += serializeRow(r, fmt);
+
+        if ((++count % s_chunkSize) == 0)
+        {
+            out.write(chunk);
+            chunk.clear();
+            progress(count, total);
+        }
+    }
+
+    if (fmt == TransferFormat::GeoJSON) chunk += "\n]}\n";
+    out.write(chunk);
+
+    if (!out.commit())
+    {
+        qWarning() << "exportRows() cannot commit" << filePath << out.errorString();
+        return -1;
+    }
+
+    progress(total, total);
+    return count;
+}
+
+static int importRows(const QString &dbPath, const QString &filePath,
+                      const std::function<void(qint64, qint64)> &progress)
+{
+    const TransferFormat fmt = formatFromPath(filePath);
+
+    QFile in(filePath);
+    if (!in.open(QIODevice::ReadOnly))
+    {
+        qWarning() << "importRows() cannot open" << filePath;
+        return -1;
+    }
+
+    // CSV columns, by name
+    int colData = -1, colFormat = -1, colEncoding = -1, colEcc = -1;
+    int colDate = -1, colLat = -1, colLon = -1, colStarred = -1;
+    if (fmt == TransferFormat::CSV)
+    {
+        const QList<QByteArray> columns = splitCsvRecord(readCsvRecord(in));
+        for (int i = 0; i < columns.size(); i++)
+        {
+            const QByteArray col = columns.at(i).trimmed().toLower();
+            if (col == "data") colData = i;
+            else if (col == "format") colFormat = i;
+            else if (col == "encoding") colEncoding = i;
+            else if (col == "ecc") colEcc = i;
+            else if (col == "date") colDate = i;
+            else if (col == "latitude" || col == "lat") colLat = i;
+            else if (col == "longitude" || col == "long" || col == "lon") colLon = i;
+            else if (col == "starred") colStarred = i;
+        }
+
+        if (colData < 0)
+        {
+            qWarning() << "importRows() no 'data' column in" << filePath;
+            return -1;
+        }
+    }
+
+    WorkerConnection connection(dbPath);
+    QSqlDatabase db = connection.database();
+    if (!db.isOpen()) return -1;
+
+    // the history holds unique payloads
+    QSqlQuery insert(db);
+    insert.prepare("INSERT INTO barcodes (data, format, encoding, ecc, date, lat, long, starred) " \
+                   "SELECT :data, :format, :encoding, :ecc, :date, :latitude, :longitude, :starred " \
+                   "WHERE NOT EXISTS (SELECT 1 FROM barcodes WHERE data = :existing)");
+
+    int count = 0;
+    int batch = 0;
+    db.transaction();
+
+    while (!in.atEnd())
+    {
+        HistoryRow r;
+
+        if (fmt == TransferFormat::CSV)
+        {
+            const QList<QByteArray> fields = splitCsvRecord(readCsvRecord(in));
+            auto field = [&fields](int col) {
+                return (col >= 0 && col < fields.size()) ? QString::fromUtf8(fields.at(col)) : QString();
+            };
+
+            r.data = field(colData);
+            r.format = field(colFormat);
+            r.encoding = field(colEncoding);
+            r.ecc = field(colEcc);
+            r.date = dateFromString(field(colDate));
+            r.lat = field(colLat).toDouble();
+            r.lon = field(colLon).toDouble();
+            r.starred = (field(colStarred) == "1" || field(colStarred) == "true");
+        }
+        else
+        {
+            QByteArray line = in.readLine().trimmed();
+            if (line.endsWith(',')) line.chop(1);
+
+            const QJsonObject obj = QJsonDocument::fromJson(line).object();
+            if (obj.value("type").toString() == "Feature")
+            {
+                rowFromJson(obj.value("properties").toObject(), r);
+
+                const QJsonArray coordinates = obj.value("geometry").toObject().value("coordinates").toArray();
+                if (coordinates.size() >= 2)
+                {
+                    r.lon = coordinates.at(0).toDouble();
+                    r.lat = coordinates.at(1).toDouble();
+                }
+            }
+            else
+            {
+                rowFromJson(obj, r);
+            }
+        }
+
+        if (r.data.isEmpty()) continue;
+
+        insert.bindValue(":data", r.data);
+        insert.bindValue(":format", r.format);
+        insert.bindValue(":encoding", r.encoding);
+        insert.bindValue(":ecc", r.ecc);
+        insert.bindValue(":date", r.date);
+        insert.bindValue(":latitude", r.hasPosition() ? QVariant(r.lat) : QVariant());
+        insert.bindValue(":longitude", r.hasPosition() ? QVariant(r.lon) : QVariant());
+        insert.bindValue(":starred", r.starred);
+        insert.bindValue(":existing", r.data);
+
+        if (insert.exec())
+        {
+            if (insert.numRowsAffected() > 0) count++;
+        }
+        else
+        {
+            qWarning() << "> insert.exec() ERROR"
+                       << insert.lastError().type() << ":" << insert.lastError().text();
+        }
+
+        if (++batch >= s_chunkSize)
+        {
+            db.commit();
+            db.transaction();
+            batch = 0;
+            progress(in.pos(), in.size());
+        }
+    }
+
+    db.commit();
+    progress(in.size(), in.size());
+
+    return count;
+}
+
+/* ************************************************************************** */
+
+HistoryTransfer *HistoryTransfer::instance = nullptr;
+
+HistoryTransfer *HistoryTransfer::getInstance()
+{
+    if (instance == nullptr)
+    {
+        instance = new HistoryTransfer();
+    }
+
+    return instance;
+}
+
+HistoryTransfer::~HistoryTransfer()
+{
+    if (m_thread) m_thread->wait();
+}
+
+/* ************************************************************************** */
+
+void HistoryTransfer::start(std::function<int (const std::function<void(qint64, qint64)> &)> job,
+                            std::function<void (int)> finished)
+{
+    m_thread = QThread::create([this, job, finished]() {
+        const int count = job([this](qint64 done, qint64 total) {
+            const float progress = (total > 0) ? float(done) / float(total) : 0.f;
+            QMetaObject::invokeMethod(this, [this, progress]() {
+                m_progress = progress;
+                Q_EMIT progressChanged();
+            }, Qt::QueuedConnection);
+        });
+
+        QMetaObject::invokeMethod(this, [this, count, finished]() {
+            m_thread = nullptr;
+            m_progress = 1.f;
+            Q_EMIT progressChanged();
+            Q_EMIT busyChanged();
+            finished(count);
+        }, Qt::QueuedConnection);
+    });
+    connect(m_thread, &QThread::finished, m_thread, &QObject::deleteLater);
+
+    m_progress = 0.f;
+    m_thread->start(QThread::LowPriority);
+    Q_EMIT progressChanged();
+    Q_EMIT busyChanged();
+}
+
+bool HistoryTransfer::exportHistory(const QUrl &fileUrl)
+{
+    DatabaseManager *db = DatabaseManager::getInstance();
+    if (m_thread || !db || !db->hasDatabaseInternal()) return false;
+
+    const QString dbPath = QSqlDatabase::database().databaseName();
+    const QString filePath = fileUrl.isLocalFile() ? fileUrl.toLocalFile() : fileUrl.toString();
+
+    start([dbPath, filePath](const std::function<void(qint64, qint64)> &progress) {
+        return exportRows(dbPath, filePath, progress);
+    }, [this, filePath](int count) {
+        qDebug() << "HistoryTransfer::exportHistory()" << count << "rows to" << filePath;
+        Q_EMIT exportFinished(count >= 0, count, filePath);
+    });
+
+    return true;
+}
+
+bool HistoryTransfer::importHistory(const QUrl &fileUrl)
+{
+    DatabaseManager *db = DatabaseManager::getInstance();
+    if (m_thread || !db || !db->hasDatabaseInternal()) return false;
+
+    const QString dbPath = QSqlDatabase::database().databaseName();
+    const QString filePath = fileUrl.isLocalFile() ? fileUrl.toLocalFile() : fileUrl.toString();
+
+    start([dbPath, filePath](const std::function<void(qint64, qint64)> &progress) {
+        return importRows(dbPath, filePath, progress);
+    }, [this](int count) {
+        qDebug() << "HistoryTransfer::importHistory()" << count << "new rows";
+        if (count > 0) BarcodeManager::getInstance()->loadHistory();
+        Q_EMIT importFinished(count >= 0, count);
+    });
+
+    return true;
+}
+
+/* ************************************************************************** */
@@ -0,0 +1,81 @@
+/*!
+ * This file is part of QmlMobileScanner.
+ * Copyright (c) 2023 Emeric Grange - All Rights Reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \date      2026
+ * \author    Emeric Grange <emeric.grange@gmail.com>
+ */
+
+#ifndef HISTORY_TRANSFER_H
+#define HISTORY_TRANSFER_H
+/* ************************************************************************** */
+
+#include <QObject>
+#include <QUrl>
+#include <QString>
+
+#include <functional>
+
+class QThread;
+
+/* ************************************************************************** */
+
+/*!
+ * \brief Streaming export and import of the scan history.
+ *
+ * Everything runs on a worker thread with its own database connection.
+ * Exports walk a forward-only SQL cursor and write the file in chunks,
+ * imports insert rows in batched transactions. The history is never
+ * materialized in memory, whatever its size.
+ *
+ * Supported formats: CSV, JSONL and GeoJSON (one feature per line).
+ */
+class HistoryTransfer: public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(bool busy READ isBusy NOTIFY busyChanged)
+    Q_PROPERTY(float progress READ getProgress NOTIFY progressChanged)
+
+    QThread *m_thread = nullptr;
+    float m_progress = 0.f;
+
+    void start(std::function<int (const std::function<void(qint64, qint64)> &)> job,
+               std::function<void (int)> finished);
+
+    static HistoryTransfer *instance;
+    HistoryTransfer() = default;
+    ~HistoryTransfer();
+
+Q_SIGNALS:
+    void busyChanged();
+    void progressChanged();
+    void exportFinished(bool success, int count, const QString &filePath);
+    void importFinished(bool success, int count);
+
+public:
+    static HistoryTransfer *getInstance();
+
+    //! Export format is deduced from the file extension (.csv, .jsonl, .geojson).
+    Q_INVOKABLE bool exportHistory(const QUrl &fileUrl);
+    Q_INVOKABLE bool importHistory(const QUrl &fileUrl);
+
+    bool isBusy() const { return m_thread; }
+    float getProgress() const { return m_progress; }
+};
+
+/* ************************************************************************** */
+#endif // HISTORY_TRANSFER_H
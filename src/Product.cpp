@@ -0,0 +1,40 @@
+/*!
+ * This file is part of QmlMobileScanner.
+ * Copyright (c) 2023 Emeric Grange - All Rights Reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \date      2026
+ * \author    Emeric Grange <emeric.grange@gmail.com>
+ */
+
+#include "Product.h"
+
+/* ************************************************************************** */
+
+Product::Product(const QString &gtin, const QString &format, const QDateTime &date,
+                 const bool known, const QString &name, const QString &brand, const QString &quantity,
+                 QObject *parent) : QObject(parent)
+{
+    m_gtin = gtin;
+    m_format = format;
+    m_date = date;
+
+    m_known = known;
+    m_name = name;
+    m_brand = brand;
+    m_quantity = quantity;
+}
+
+/* ************************************************************************** */
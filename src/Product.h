@@ -0,0 +1,74 @@
+/*!
+ * This file is part of QmlMobileScanner.
+ * Copyright (c) 2023 Emeric Grange - All Rights Reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \date      2026
+ * \author    Emeric Grange <emeric.grange@gmail.com>
+ */
+
+#ifndef PRODUCT_H
+#define PRODUCT_H
+/* ************************************************************************** */
+
+#include <QObject>
+#include <QString>
+#include <QDateTime>
+
+/* ************************************************************************** */
+
+/*!
+ * \brief The Product class
+ */
+class Product: public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(QString gtin READ getGtin CONSTANT)
+    Q_PROPERTY(QString format READ getFormat CONSTANT)
+    Q_PROPERTY(QDateTime date READ getDate CONSTANT)
+
+    Q_PROPERTY(bool isKnown READ isKnown CONSTANT)
+    Q_PROPERTY(QString name READ getName CONSTANT)
+    Q_PROPERTY(QString brand READ getBrand CONSTANT)
+    Q_PROPERTY(QString quantity READ getQuantity CONSTANT)
+
+    QString m_gtin;
+    QString m_format;
+    QDateTime m_date;
+
+    bool m_known = false;
+    QString m_name;
+    QString m_brand;
+    QString m_quantity;
+
+public:
+    Product(const QString &gtin, const QString &format, const QDateTime &date,
+            const bool known, const QString &name, const QString &brand, const QString &quantity,
+            QObject *parent = nullptr);
+    ~Product() = default;
+
+    QString getGtin() const { return m_gtin; }
+    QString getFormat() const { return m_format; }
+    QDateTime getDate() const { return m_date; }
+
+    bool isKnown() const { return m_known; }
+    QString getName() const { return m_name; }
+    QString getBrand() const { return m_brand; }
+    QString getQuantity() const { return m_quantity; }
+};
+
+/* ************************************************************************** */
+#endif // PRODUCT_H
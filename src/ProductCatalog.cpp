@@ -0,0 +1,329 @@
+/*!
+ * This file is part of QmlMobileScanner.
+ * Copyright (c) 2023 Emeric Grange - All Rights Reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \date      2026
+ * \author    Emeric Grange <emeric.grange@gmail.com>
+ */
+
+#include "ProductCatalog.h"
+#include "utils_csv.h"
+
+#include <QSaveFile>
+#include <QTemporaryFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QDebug>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <string_view>
+#include <vector>
+
+/* ************************************************************************** */
+
+ProductCatalog::~ProductCatalog()
+{
+    close();
+}
+
+bool ProductCatalog::open(const QString &indexPath)
+{
+    close();
+
+    m_file.setFileName(indexPath);
+    if (!m_file.open(QIODevice::ReadOnly)) return false;
+
+    const qint64 fileSize = m_file.size();
+    if (fileSize >= qint64(sizeof(Header)))
+    {
+        m_map = m_file.map(0, fileSize);
+    }
+
+    if (m_map)
+    {
+        Header h;
+        std::memcpy(&h, m_map, sizeof(Header));
+
+        const quint64 maxCount = quint64(fileSize - sizeof(Header)) / sizeof(Record);
+        if (std::memcmp(h.magic, s_magic, sizeof(s_magic)) == 0 &&
+            h.version == s_version && h.count <= maxCount &&
+            h.blobOffset == sizeof(Header) + h.count * sizeof(Record))
+        {
+            m_records = reinterpret_cast<const Record *>(m_map + sizeof(Header));
+            m_blob = reinterpret_cast<const char *>(m_map + h.blobOffset);
+            m_count = qint64(h.count);
+            m_blobSize = fileSize - qint64(h.blobOffset);
+            return true;
+        }
+
+        qWarning() << "ProductCatalog::open() invalid index file" << indexPath;
+    }
+
+    close();
+    return false;
+}
+
+void ProductCatalog::close()
+{
+    if (m_map) m_file.unmap(m_map);
+    if (m_file.isOpen()) m_file.close();
+
+    m_map = nullptr;
+    m_records = nullptr;
+    m_blob = nullptr;
+    m_count = 0;
+    m_blobSize = 0;
+}
+
+/* ************************************************************************** */
+
+bool ProductCatalog::lookup(const quint64 gtin, Product &product) const
+{
+    if (!m_records || gtin == 0) return false;
+
+    const Record *end = m_records + m_count;
+    const Record *it = std::lower_bound(m_records, end, gtin,
+                                        [](const Record &r, quint64 v) { return r.gtin < v; });
+    if (it == end || it->gtin != gtin) return false;
+    if (qint64(it->offset) + it->size > m_blobSize) return false;
+
+    const std::string_view entry(m_blob + it->offset, it->size);
+    const size_t t1 = entry.find('\t');
+    const size_t t2 = (t1 == std::string_view::npos) ? t1 : entry.find('\t', t1 + 1);
+
+    auto field = [&entry](size_t from, size_t to) {
+        if (from >= entry.size()) return QString();
+        const std::string_view f = entry.substr(from, (to == std::string_view::npos) ? to : to - from);
+        return QString::fromUtf8(f.data(), qsizetype(f.size()));
+    };
+
+    product.name = field(0, t1);
+    product.brand = (t1 == std::string_view::npos) ? QString() : field(t1 + 1, t2);
+    product.quantity = (t2 == std::string_view::npos) ? QString() : field(t2 + 1, std::string_view::npos);
+
+    return true;
+}
+
+/* ************************************************************************** */
+
+quint64 ProductCatalog::normalizeGtin(const QString &code, const QString &format)
+{
+    QString digits;
+    digits.reserve(14);
+
+    for (const QChar c: code)
+    {
+        if (c >= u'0' && c <= u'9') digits += c;
+        else if (c != u' ' && c != u'-') return 0;
+    }
+
+    if (digits.size() == 8 && (format == "UPC-E" || format == "UPC_E" || format == "UPCE"))
+    {
+        // expand UPC-E to UPC-A, the check digit stays the same
+        const QString d = digits;
+        digits = d.left(1);
+        switch (d.at(6).digitValue())
+        {
+        case 0: case 1: case 2:
+            digits += d.mid(1, 2) + d.at(6) + "0000" + d.mid(3, 3); break;
+        case 3:
+            digits += d.mid(1, 3) + "00000" + d.mid(4, 2); break;
+        case 4:
+            digits += d.mid(1, 4) + "00000" + d.at(5); break;
+        default:
+            digits += d.mid(1, 5) + "0000" + d.at(6); break;
+        }
+        digits += d.at(7);
+    }
+
+    const int N = digits.size();
+    if (N != 8 && N != 12 && N != 13 && N != 14) return 0;
+
+    // check digit, same computation as ZXing::GTIN::ComputeCheckDigit()
+    // (which is only available to zxing-cpp internals, and we may build with QZXing)
+    int sum = 0;
+    for (int i = N - 2; i >= 0; i -= 2) sum += digits.at(i).digitValue();
+    sum *= 3;
+    for (int i = N - 3; i >= 0; i -= 2) sum += digits.at(i).digitValue();
+    if ((10 - (sum % 10)) % 10 != digits.at(N - 1).digitValue()) return 0;
+
+    // leading zeros make EAN-8 / UPC-A / EAN-13 / GTIN-14 share the same key
+    return digits.toULongLong();
+}
+
+/* ************************************************************************** */
+
+//! Numbers are left-padded with zeros to 'width' digits, a numeric GTIN loses its leading zeros.
+static QByteArray jsonField(const QJsonObject &obj, std::initializer_list<const char *> keys, const int width = 0)
+{
+    for (const char *key: keys)
+    {
+        const QJsonValue v = obj.value(QLatin1StringView(key));
+        if (v.isString()) return v.toString().toUtf8();
+        if (v.isDouble()) return QByteArray::number(v.toInteger()).rightJustified(width, '0');
+    }
+
+    return QByteArray();
+}
+
+qint64 ProductCatalog::importCatalog(const QString &sourcePath, const QString &indexPath,
+                                     const std::function<void(qint64, qint64)> &progress)
+{
+    QFile source(sourcePath);
+    if (!source.open(QIODevice::ReadOnly))
+    {
+        qWarning() << "ProductCatalog::importCatalog() cannot open" << sourcePath;
+        return -1;
+    }
+
+    // product strings are streamed into a temporary blob, only the records stay in memory
+    QTemporaryFile blob;
+    if (!blob.open())
+    {
+        qWarning() << "ProductCatalog::importCatalog() cannot create temporary file";
+        return -1;
+    }
+
+    const bool jsonl = sourcePath.endsWith(".jsonl", Qt::CaseInsensitive) ||
+                       sourcePath.endsWith(".ndjson", Qt::CaseInsensitive) ||
+                       sourcePath.endsWith(".json", Qt::CaseInsensitive);
+
+    char sep = ',';
+    int colCode = -1, colName = -1, colBrand = -1, colQuantity = -1;
+
+    if (!jsonl)
+    {
+        const QByteArray header = source.readLine();
+        if (header.contains('\t')) sep = '\t';
+        else if (header.count(';') > header.count(',')) sep = ';';
+
+        const QList<QByteArray> columns = splitCsvRecord(header, sep);
+        for (int i = 0; i < columns.size(); i++)
+        {
+            const QByteArray col = columns.at(i).trimmed().toLower();
+            if (colCode < 0 && (col == "code" || col == "gtin" || col == "ean" || col == "barcode")) colCode = i;
+            else if (colName < 0 && (col == "product_name" || col == "name")) colName = i;
+            else if (colBrand < 0 && (col == "brands" || col == "brand")) colBrand = i;
+            else if (colQuantity < 0 && col == "quantity") colQuantity = i;
+        }
+
+        if (colCode < 0)
+        {
+            qWarning() << "ProductCatalog::importCatalog() no GTIN column in" << sourcePath;
+            return -1;
+        }
+    }
+
+    std::vector<Record> records;
+    quint64 blobSize = 0;
+
+    auto sanitize = [](QByteArray field) {
+        return field.replace('\t', ' ').replace('\n', ' ').replace('\r', ' ').trimmed();
+    };
+
+    while (!source.atEnd())
+    {
+        const QByteArray line = source.readLine();
+        QByteArray code, name, brand, quantity;
+
+        if (jsonl)
+        {
+            const QJsonObject obj = QJsonDocument::fromJson(line).object();
+            if (obj.isEmpty()) continue;
+
+            // padded to GTIN-14: same key and same check digit as the shorter forms
+            code = jsonField(obj, {"code", "gtin", "ean", "barcode"}, 14);
+            name = jsonField(obj, {"product_name", "name"});
+            brand = jsonField(obj, {"brands", "brand"});
+            quantity = jsonField(obj, {"quantity"});
+        }
+        else
+        {
+            const QList<QByteArray> fields = splitCsvRecord(line, sep);
+            if (colCode >= fields.size()) continue;
+
+            code = fields.at(colCode);
+            if (colName >= 0 && colName < fields.size()) name = fields.at(colName);
+            if (colBrand >= 0 && colBrand < fields.size()) brand = fields.at(colBrand);
+            if (colQuantity >= 0 && colQuantity < fields.size()) quantity = fields.at(colQuantity);
+        }
+
+        const quint64 gtin = normalizeGtin(QString::fromLatin1(code.trimmed()));
+        if (gtin == 0) continue;
+
+        const QByteArray entry = sanitize(name) + '\t' + sanitize(brand) + '\t' + sanitize(quantity);
+        if (blobSize + entry.size() > std::numeric_limits<quint32>::max())
+        {
+            qWarning() << "ProductCatalog::importCatalog() catalog too large, truncated";
+            break;
+        }
+
+        records.push_back({gtin, quint32(blobSize), quint32(entry.size())});
+        blob.write(entry);
+        blobSize += entry.size();
+
+        if (progress && (records.size() % 65536) == 0) progress(source.pos(), source.size());
+    }
+
+    // sort by GTIN, and keep the last occurrence of duplicated entries
+    std::stable_sort(records.begin(), records.end(),
+                     [](const Record &a, const Record &b) { return a.gtin < b.gtin; });
+    size_t count = 0;
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        if (count > 0 && records[count - 1].gtin == records[i].gtin) records[count - 1] = records[i];
+        else records[count++] = records[i];
+    }
+    records.resize(count);
+
+    // write the index
+    QSaveFile index(indexPath);
+    if (!index.open(QIODevice::WriteOnly))
+    {
+        qWarning() << "ProductCatalog::importCatalog() cannot write" << indexPath;
+        return -1;
+    }
+
+    Header h = {};
+    std::memcpy(h.magic, s_magic, sizeof(s_magic));
+    h.version = s_version;
+    h.count = count;
+    h.blobOffset = sizeof(Header) + count * sizeof(Record);
+
+    index.write(reinterpret_cast<const char *>(&h), sizeof(Header));
+    index.write(reinterpret_cast<const char *>(records.data()), qint64(count * sizeof(Record)));
+
+    blob.seek(0);
+    while (!blob.atEnd())
+    {
+        index.write(blob.read(1024*1024));
+    }
+
+    if (!index.commit())
+    {
+        qWarning() << "ProductCatalog::importCatalog() cannot commit" << indexPath << index.errorString();
+        return -1;
+    }
+
+    if (progress) progress(source.size(), source.size());
+
+    return qint64(count);
+}
+
+/* ************************************************************************** */
@@ -0,0 +1,106 @@
+/*!
+ * This file is part of QmlMobileScanner.
+ * Copyright (c) 2023 Emeric Grange - All Rights Reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \date      2026
+ * \author    Emeric Grange <emeric.grange@gmail.com>
+ */
+
+#ifndef PRODUCT_CATALOG_H
+#define PRODUCT_CATALOG_H
+/* ************************************************************************** */
+
+#include <QFile>
+#include <QString>
+
+#include <functional>
+
+/* ************************************************************************** */
+
+/*!
+ * \brief Offline GTIN product catalog, backed by a memory-mapped sorted index.
+ *
+ * Index file layout (native endianness, everything 8 bytes aligned):
+ * - header (32 bytes): magic, version, record count, blob offset
+ * - records (16 bytes each): GTIN-14 as integer, blob offset, blob size, sorted by GTIN
+ * - blob: UTF-8 "name\tbrand\tquantity" strings, referenced by the records
+ *
+ * Opening the catalog only maps the file, so it costs nothing on cold start.
+ * Lookups are a binary search over the mapped records, no parsing involved.
+ */
+class ProductCatalog
+{
+public:
+    struct Product
+    {
+        QString name;
+        QString brand;
+        QString quantity;
+    };
+
+    ProductCatalog() = default;
+    ~ProductCatalog();
+
+    bool open(const QString &indexPath);
+    void close();
+
+    bool isOpen() const { return m_records != nullptr; }
+    qint64 count() const { return m_count; }
+
+    bool lookup(const quint64 gtin, Product &product) const;
+
+    //! Convert an EAN-8 / UPC-E / UPC-A / EAN-13 / GTIN-14 string into a GTIN-14 integer key.
+    //! Returns 0 if the code is not a GTIN or if its check digit is invalid.
+    //! `format` is required to expand UPC-E codes (8 digits, like EAN-8).
+    static quint64 normalizeGtin(const QString &code, const QString &format = QString());
+
+    //! Build an index file out of a CSV/TSV or JSONL catalog dump.
+    //! `progress` is called with (bytes read, bytes total) from the calling thread.
+    //! Returns the number of products indexed, or -1 on error.
+    static qint64 importCatalog(const QString &sourcePath, const QString &indexPath,
+                                const std::function<void(qint64, qint64)> &progress = {});
+
+private:
+    struct Header
+    {
+        char magic[8];
+        quint32 version;
+        quint32 reserved;
+        quint64 count;
+        quint64 blobOffset;
+    };
+    struct Record
+    {
+        quint64 gtin;
+        quint32 offset;
+        quint32 size;
+    };
+    static_assert(sizeof(Header) == 32);
+    static_assert(sizeof(Record) == 16);
+
+    static constexpr char s_magic[8] = {'Q','M','S','P','C','A','T','\0'};
+    static constexpr quint32 s_version = 1;
+
+    QFile m_file;
+    uchar *m_map = nullptr;
+    const Record *m_records = nullptr;
+    const char *m_blob = nullptr;
+    qint64 m_count = 0;
+    qint64 m_blobSize = 0;
+};
+
+/* ************************************************************************** */
+#endif // PRODUCT_CATALOG_H
@@ -0,0 +1,184 @@
+/*!
+ * This file is part of QmlMobileScanner.
+ * Copyright (c) 2023 Emeric Grange - All Rights Reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \date      2026
+ * \author    Emeric Grange <emeric.grange@gmail.com>
+ */
+
+#include "ProductsManager.h"
+#include "Product.h"
+#include "BarcodeManager.h"
+#include "Barcode.h"
+
+#include <QDir>
+#include <QFile>
+#include <QThread>
+#include <QStandardPaths>
+#include <QDebug>
+
+/* ************************************************************************** */
+
+ProductsManager *ProductsManager::instance = nullptr;
+
+ProductsManager *ProductsManager::getInstance()
+{
+    if (instance == nullptr)
+    {
+        instance = new ProductsManager();
+    }
+
+    return instance;
+}
+
+ProductsManager::ProductsManager()
+{
+    // The catalog index lives next to the database
+    QString dataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    if (!dataPath.isEmpty())
+    {
+        QDir().mkpath(dataPath);
+        m_catalogPath = dataPath + "/products.idx";
+
+        // Only maps the file, lookups are available right away
+        if (QFile::exists(m_catalogPath)) m_catalog.open(m_catalogPath);
+    }
+
+    // Keep the product list in sync with the history
+    connect(BarcodeManager::getInstance(), &BarcodeManager::historyChanged, this, [this]() {
+        if (m_productsLoaded) loadProductsList();
+    });
+}
+
+ProductsManager::~ProductsManager()
+{
+    if (m_importThread) m_importThread->wait();
+
+    qDeleteAll(m_products);
+    m_products.clear();
+}
+
+/* ************************************************************************** */
+
+void ProductsManager::loadProductsList()
+{
+    qDeleteAll(m_products);
+    m_products.clear();
+
+    // history row order, the newest products first
+    BarcodeManager::getInstance()->getHistoryModel()->forEachEntry([this](const Barcode &bc) {
+        if (bc.isMatrix()) return;
+
+        const quint64 gtin = ProductCatalog::normalizeGtin(bc.getData(), bc.getFormat());
+        if (gtin == 0) return;
+
+        ProductCatalog::Product p;
+        const bool known = m_catalog.lookup(gtin, p);
+
+        m_products.push_back(new Product(bc.getData(), bc.getFormat(), bc.getDate(),
+                                         known, p.name, p.brand, p.quantity, this));
+    });
+
+    m_productsLoaded = true;
+    Q_EMIT productsChanged();
+}
+
+QVariantMap ProductsManager::lookup(const QString &code, const QString &format) const
+{
+    QVariantMap result;
+
+    ProductCatalog::Product p;
+    if (m_catalog.lookup(ProductCatalog::normalizeGtin(code, format), p))
+    {
+        result.insert("gtin", code);
+        result.insert("name", p.name);
+        result.insert("brand", p.brand);
+        result.insert("quantity", p.quantity);
+    }
+
+    return result;
+}
+
+/* ************************************************************************** */
+
+bool ProductsManager::importCatalog(const QUrl &fileUrl)
+{
+    if (m_importThread || m_catalogPath.isEmpty()) return false;
+
+    const QString sourcePath = fileUrl.isLocalFile() ? fileUrl.toLocalFile() : fileUrl.toString();
+    const QString importPath = m_catalogPath + ".new";
+
+    // Import millions of rows off the GUI thread, the current catalog stays usable meanwhile
+    m_importThread = QThread::create([this, sourcePath, importPath]() {
+        const qint64 count = ProductCatalog::importCatalog(sourcePath, importPath, [this](qint64 done, qint64 total) {
+            const float progress = (total > 0) ? float(done) / float(total) : 0.f;
+            QMetaObject::invokeMethod(this, [this, progress]() {
+                m_importProgress = progress;
+                Q_EMIT importChanged();
+            }, Qt::QueuedConnection);
+        });
+
+        QMetaObject::invokeMethod(this, [this, count, importPath]() {
+            finishImport(count, importPath);
+        }, Qt::QueuedConnection);
+    });
+    connect(m_importThread, &QThread::finished, m_importThread, &QObject::deleteLater);
+
+    m_importProgress = 0.f;
+    m_importThread->start(QThread::LowPriority);
+    Q_EMIT importChanged();
+
+    return true;
+}
+
+void ProductsManager::finishImport(const qint64 count, const QString &importPath)
+{
+    qDebug() << "ProductsManager::finishImport()" << count << "products";
+
+    if (count >= 0)
+    {
+        // swap the index files (the old one must be unmapped first)
+        m_catalog.close();
+        QFile::remove(m_catalogPath);
+        QFile::rename(importPath, m_catalogPath);
+        m_catalog.open(m_catalogPath);
+
+        Q_EMIT catalogChanged();
+        if (m_productsLoaded) loadProductsList();
+    }
+    else
+    {
+        QFile::remove(importPath);
+    }
+
+    m_importThread = nullptr;
+    m_importProgress = 1.f;
+    Q_EMIT importChanged();
+    Q_EMIT importFinished(count >= 0);
+}
+
+void ProductsManager::removeCatalog()
+{
+    if (m_importThread) return;
+
+    m_catalog.close();
+    QFile::remove(m_catalogPath);
+
+    Q_EMIT catalogChanged();
+    if (m_productsLoaded) loadProductsList();
+}
+
+/* ************************************************************************** */
@@ -0,0 +1,96 @@
+/*!
+ * This file is part of QmlMobileScanner.
+ * Copyright (c) 2023 Emeric Grange - All Rights Reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \date      2026
+ * \author    Emeric Grange <emeric.grange@gmail.com>
+ */
+
+#ifndef PRODUCTS_MANAGER_H
+#define PRODUCTS_MANAGER_H
+/* ************************************************************************** */
+
+#include "ProductCatalog.h"
+
+#include <QObject>
+#include <QUrl>
+#include <QString>
+#include <QVariant>
+#include <QVariantMap>
+
+class QThread;
+
+/* ************************************************************************** */
+
+/*!
+ * \brief The ProductsManager class
+ *
+ * Resolves scanned EAN/UPC codes against the offline product catalog.
+ * No network access is involved, the catalog must be imported first.
+ */
+class ProductsManager: public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(bool catalogAvailable READ isCatalogAvailable NOTIFY catalogChanged)
+    Q_PROPERTY(qint64 catalogCount READ getCatalogCount NOTIFY catalogChanged)
+    Q_PROPERTY(bool catalogImporting READ isCatalogImporting NOTIFY importChanged)
+    Q_PROPERTY(float catalogImportProgress READ getCatalogImportProgress NOTIFY importChanged)
+
+    Q_PROPERTY(int productListCount READ getProductListCount NOTIFY productsChanged)
+    Q_PROPERTY(QVariant productsList READ getProductsList NOTIFY productsChanged)
+
+    ProductCatalog m_catalog;
+    QString m_catalogPath;
+
+    QThread *m_importThread = nullptr;
+    float m_importProgress = 0.f;
+    void finishImport(const qint64 count, const QString &importPath);
+
+    bool m_productsLoaded = false;
+    QList <QObject *> m_products;
+
+    static ProductsManager *instance;
+    ProductsManager();
+    ~ProductsManager();
+
+Q_SIGNALS:
+    void catalogChanged();
+    void importChanged();
+    void importFinished(bool success);
+    void productsChanged();
+
+public:
+    static ProductsManager *getInstance();
+
+    Q_INVOKABLE void loadProductsList();
+
+    Q_INVOKABLE bool importCatalog(const QUrl &fileUrl);
+    Q_INVOKABLE void removeCatalog();
+
+    Q_INVOKABLE QVariantMap lookup(const QString &code, const QString &format = QString()) const;
+
+    bool isCatalogAvailable() const { return m_catalog.isOpen(); }
+    qint64 getCatalogCount() const { return m_catalog.count(); }
+    bool isCatalogImporting() const { return m_importThread; }
+    float getCatalogImportProgress() const { return m_importProgress; }
+
+    int getProductListCount() const { return m_products.size(); }
+    QVariant getProductsList() const { return QVariant::fromValue(m_products); }
+};
+
+/* ************************************************************************** */
+#endif // PRODUCTS_MANAGER_H
@@ -22,6 +22,8 @@
 #include "DatabaseManager.h"
 #include "SettingsManager.h"
 #include "BarcodeManager.h"
+#include "ProductsManager.h"
+#include "HistoryTransfer.h"
 #include "utils_camera.h"
 #include "utils_barcode.h"
 
@@ -43,11 +45,15 @@
 #endif
 
 #include <QtGlobal>
+#include <QCommandLineParser>
+#include <QCoreApplication>
 #include <QGuiApplication>
 #include <QIcon>
 #include <QQmlApplicationEngine>
 #include <QQmlContext>
 #include <QQuickWindow>
+#include <QTextStream>
+#include <QUrl>
 
 #if QT_CONFIG(permissions)
 #include <QPermissions>
@@ -68,6 +74,44 @@ int main(int argc, char *argv[])
     //qputenv("QT_MEDIA_BACKEND", "gstreamer"); // deprecated
     //qputenv("QT_MEDIA_BACKEND", "android"); // deprecated
 
+#if defined(QMS_USE_ZXINGCPP) && !defined(Q_OS_ANDROID) && !defined(Q_OS_IOS)
+    // Command line scan ///////////////////////////////////////////////////////
+
+    // Checked before the GUI application is created, so it runs without a display
+    bool scanRequested = false;
+    for (int i = 1; i < argc; i++)
+    {
+        const QByteArray arg(argv[i]);
+        if (arg == "--scan" || arg.startsWith("--scan=")) scanRequested = true;
+    }
+
+    if (scanRequested)
+    {
+        QCoreApplication app(argc, argv);
+        app.setApplicationName("QmlMobileScanner");
+
+        // Large images are decoded in tiles
+        QCommandLineParser parser;
+        QCommandLineOption scanOption("scan", "Decode the barcodes of an image file, print them and exit.", "image");
+        parser.addOption(scanOption);
+        parser.parse(app.arguments()); // unknown options are ignored
+
+        const QList<BarcodeQml> barcodes = ZXingQt::loadImage(QUrl::fromLocalFile(parser.value(scanOption)));
+
+        QTextStream out(stdout);
+        for (const BarcodeQml &bc: barcodes)
+        {
+            const Position &p = bc.position();
+            out << bc.formatName() << '\t' << bc.text() << '\t'
+                << p.topLeft().x() << 'x' << p.topLeft().y() << ' ' << p.topRight().x() << 'x' << p.topRight().y() << ' '
+                << p.bottomRight().x() << 'x' << p.bottomRight().y() << ' ' << p.bottomLeft().x() << 'x' << p.bottomLeft().y()
+                << Qt::endl;
+        }
+
+        return barcodes.isEmpty() ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+#endif
+
     // GUI application /////////////////////////////////////////////////////////
 
     QGuiApplication app(argc, argv);
@@ -77,6 +121,7 @@ int main(int argc, char *argv[])
     app.setApplicationDisplayName("QmlMobileScanner");
     app.setOrganizationName("emeric");
     app.setOrganizationDomain("emeric");
+    app.setApplicationVersion(APP_VERSION);
 
     app.setWindowIcon(QIcon(":/assets/gfx/logos/logo_black.svg"));
 
@@ -90,6 +135,12 @@ int main(int argc, char *argv[])
     BarcodeManager *bch = BarcodeManager::getInstance();
     if (!bch) return EXIT_FAILURE;
 
+    ProductsManager *pdm = ProductsManager::getInstance();
+    if (!pdm) return EXIT_FAILURE;
+
+    HistoryTransfer *htr = HistoryTransfer::getInstance();
+    if (!htr) return EXIT_FAILURE;
+
     // Init app utils
     UtilsApp *utilsApp = UtilsApp::getInstance();
     if (!utilsApp) return EXIT_FAILURE;
@@ -102,6 +153,7 @@ int main(int argc, char *argv[])
 
     UtilsCamera *utilsCamera = UtilsCamera::getInstance();
     if (!utilsCamera) return EXIT_FAILURE;
+    utilsCamera->calibrate(); // in the background, usually done before the camera opens
 
     UtilsBarcode *utilsBarcode = UtilsBarcode::getInstance();
     if (!utilsBarcode) return EXIT_FAILURE;
@@ -111,6 +163,8 @@ int main(int argc, char *argv[])
     QQmlContext *engine_context = engine.rootContext();
     engine_context->setContextProperty("settingsManager", stm);
     engine_context->setContextProperty("barcodeManager", bch);
+    engine_context->setContextProperty("productsManager", pdm);
+    engine_context->setContextProperty("historyTransfer", htr);
     engine_context->setContextProperty("utilsApp", utilsApp);
     engine_context->setContextProperty("utilsScreen", utilsScreen);
     engine_context->setContextProperty("utilsCamera", utilsCamera);
@@ -20,12 +20,32 @@
  */
 
 #include "utils_camera.h"
+#include "SettingsManager.h"
+
+#include <QCoreApplication>
+#include <QSettings>
+#include <QSysInfo>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QThread>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QDebug>
 
 #include <QImage>
 #include <QVideoFrame>
 #include <QCameraFormat>
 #include <QMediaDevices>
 
+#include <algorithm>
+#include <limits>
+
+#if defined(QMS_USE_ZXINGCPP)
+#include <ZXingQt>
+#elif defined(QMS_USE_QZXING)
+#include <QZXing>
+#endif
+
 /* ************************************************************************** */
 
 UtilsCamera *UtilsCamera::instance = nullptr;
@@ -40,79 +60,263 @@ UtilsCamera *UtilsCamera::getInstance()
     return instance;
 }
 
+UtilsCamera::UtilsCamera()
+{
+    // the decoding cost depends on the scan settings
+    SettingsManager *stm = SettingsManager::getInstance();
+    connect(stm, &SettingsManager::formatsEnabledChanged, this, &UtilsCamera::calibrate);
+    connect(stm, &SettingsManager::tryHarderChanged, this, &UtilsCamera::calibrate);
+    connect(stm, &SettingsManager::tryRotateChanged, this, &UtilsCamera::calibrate);
+    connect(stm, &SettingsManager::tryInvertChanged, this, &UtilsCamera::calibrate);
+    connect(stm, &SettingsManager::tryDownscaleChanged, this, &UtilsCamera::calibrate);
+}
+
+UtilsCamera::~UtilsCamera()
+{
+    if (m_calibrationThread) m_calibrationThread->wait();
+}
+
 /* ************************************************************************** */
 
-QCameraFormat UtilsCamera::selectCameraFormat(int idx)
+//! Extra cost of a pixel format, relative to the decoding itself
+double UtilsCamera::pixelFormatPenalty(QVideoFrameFormat::PixelFormat format)
 {
-    QList <QCameraFormat> formats = QMediaDevices::defaultVideoInput().videoFormats();
+    switch (format)
+    {
+    // luminance plane read in place
+    case QVideoFrameFormat::Format_NV12:
+    case QVideoFrameFormat::Format_NV21:
+    case QVideoFrameFormat::Format_Y8:
+    case QVideoFrameFormat::Format_YUYV:
+    case QVideoFrameFormat::Format_UYVY:
+    case QVideoFrameFormat::Format_YUV420P:
+    case QVideoFrameFormat::Format_YUV422P:
+    case QVideoFrameFormat::Format_YV12:
+    case QVideoFrameFormat::Format_IMC1:
+    case QVideoFrameFormat::Format_IMC2:
+    case QVideoFrameFormat::Format_IMC3:
+    case QVideoFrameFormat::Format_IMC4:
+    case QVideoFrameFormat::Format_AYUV:
+    case QVideoFrameFormat::Format_AYUV_Premultiplied:
+    case QVideoFrameFormat::Format_P010:
+    case QVideoFrameFormat::Format_P016:
+    case QVideoFrameFormat::Format_Y16:
+        return 0.0;
 
-    if (idx > 0 && idx < QMediaDevices::videoInputs().size())
+    // grayscale conversion of every frame
+    case QVideoFrameFormat::Format_ARGB8888:
+    case QVideoFrameFormat::Format_ARGB8888_Premultiplied:
+    case QVideoFrameFormat::Format_XRGB8888:
+    case QVideoFrameFormat::Format_BGRA8888:
+    case QVideoFrameFormat::Format_BGRA8888_Premultiplied:
+    case QVideoFrameFormat::Format_BGRX8888:
+    case QVideoFrameFormat::Format_ABGR8888:
+    case QVideoFrameFormat::Format_XBGR8888:
+    case QVideoFrameFormat::Format_RGBA8888:
+    case QVideoFrameFormat::Format_RGBX8888:
+        return 0.5;
+
+    // decompression of every frame
+    case QVideoFrameFormat::Format_Jpeg:
+        return 1.5;
+
+    // GPU textures (and unknown formats), read back and converted through a QImage
+    default:
+        return 2.0;
+    }
+}
+
+//! Time to decode a synthetic frame with nothing to find (the worst case), in ns per pixel
+double UtilsCamera::calibrateDecodeCostPerPixel(unsigned formats, bool tryHarder, bool tryRotate,
+                                                bool tryInvert, bool tryDownscale)
+{
+    // random blocks, so that the detectors have edges to follow
+    QImage image(640, 480, QImage::Format_Grayscale8);
+    QRandomGenerator rng(42);
+    for (int y = 0; y < image.height(); y++)
     {
-        formats = QMediaDevices::videoInputs().at(idx).videoFormats();
+        uchar *line = image.scanLine(y);
+        for (int x = 0; x < image.width(); x++)
+        {
+            line[x] = (rng.bounded(8) == 0 || ((x / 6 + y / 6) & 1)) ? 30 : 220;
+        }
     }
 
-    int optimalPixelFormat = QVideoFrameFormat::Format_Invalid;
+    // the same settings as the camera readers
+#if defined(QMS_USE_ZXINGCPP)
+    ZXing::ReaderOptions opts;
+    opts.setFormats(ZXingQt::formatsFromBitmask(formats));
+    opts.setTryHarder(tryHarder);
+    opts.setTryRotate(tryRotate);
+    opts.setTryInvert(tryInvert);
+    opts.setTryDownscale(tryDownscale);
+    opts.setMaxNumberOfSymbols(4);
+    auto decode = [&]() { ZXingQt::ReadBarcodes(image, opts); };
+#elif defined(QMS_USE_QZXING)
+    Q_UNUSED(tryRotate);
+    Q_UNUSED(tryInvert);
+    Q_UNUSED(tryDownscale);
+    QZXing decoder(QZXing::DecoderFormat_QR_CODE);
+    decoder.setDecoder(formats);
+    decoder.setTryHarder(tryHarder);
+    auto decode = [&]() { decoder.decodeImage(image); };
+#else
+    Q_UNUSED(formats);
+    Q_UNUSED(tryHarder);
+    Q_UNUSED(tryRotate);
+    Q_UNUSED(tryInvert);
+    Q_UNUSED(tryDownscale);
+    auto decode = []() {};
+#endif
 
-    // square formats
-    for (const auto &format : std::as_const(formats))
+    // best of a few runs, the first one also pays for the decoder tables
+    qint64 best = std::numeric_limits<qint64>::max();
+    for (int i = 0; i < 4; i++)
     {
-        qWarning() << "QCameraFormat(" << idx << ") res: " << format.resolution() << " pix: " << format.pixelFormat();
+        QElapsedTimer t;
+        t.start();
+        decode();
+        best = std::min(best, t.nsecsElapsed());
+    }
 
-        if (format.resolution() == QSize(1440, 1440) &&
-            (!optimalPixelFormat || (optimalPixelFormat && format.pixelFormat() == optimalPixelFormat)))
-        {
-            qWarning() << "SELECTED FORMAT res: " << format.resolution() << " pix: " << format.pixelFormat();
-            return format;
-        }
-        if (format.resolution() == QSize(1200, 1200) &&
-            (!optimalPixelFormat || (optimalPixelFormat && format.pixelFormat() == optimalPixelFormat)))
-        {
-            qWarning() << "SELECTED FORMAT res: " << format.resolution() << " pix: " << format.pixelFormat();
-            return format;
-        }
-        if (format.resolution() == QSize(1080, 1080) &&
-            (!optimalPixelFormat || (optimalPixelFormat && format.pixelFormat() == optimalPixelFormat)))
+    return std::max(0.1, double(best) / (image.width() * image.height()));
+}
+
+//! The calibration is only valid for this device, this OS, this build of the decoders and these scan settings
+QString UtilsCamera::calibrationKey()
+{
+    // the binary is rewritten by every build, even when the application version stays the same
+    const QFileInfo binary(QCoreApplication::applicationFilePath());
+    const SettingsManager *stm = SettingsManager::getInstance();
+
+    return QSysInfo::productType() + " " + QSysInfo::productVersion() + " " +
+           QSysInfo::currentCpuArchitecture() + " " + QCoreApplication::applicationVersion() + " " +
+           QString::number(binary.lastModified().toSecsSinceEpoch()) + " " +
+           QString::number(stm->getFormatsEnabled(), 16) + " " +
+           QString::number(stm->getScanTryHarder()) + QString::number(stm->getScanTryRotate()) +
+           QString::number(stm->getScanTryInvert()) + QString::number(stm->getScanTryDownscale());
+}
+
+void UtilsCamera::calibrate()
+{
+    if (m_calibrationThread)
+    {
+        m_calibrationPending = true;
+        return;
+    }
+
+    const QString key = calibrationKey();
+    if (key == m_calibrationKey && m_decodeCostPerPixel > 0.0) return;
+
+    QSettings settings(QCoreApplication::organizationName(), QCoreApplication::applicationName());
+    if (settings.value("camera/calibrationKey").toString() == key)
+    {
+        const double cost = settings.value("camera/decodeCostPerPixel").toDouble();
+        if (cost > 0.0)
         {
-            qWarning() << "SELECTED FORMAT res: " << format.resolution() << " pix: " << format.pixelFormat();
-            return format;
+            finishCalibration(key, cost);
+            return;
         }
     }
 
-    // non square formats
-    for (const auto &format : std::as_const(formats))
+    const SettingsManager *stm = SettingsManager::getInstance();
+    const unsigned formats = stm->getFormatsEnabled();
+    const bool tryHarder = stm->getScanTryHarder();
+    const bool tryRotate = stm->getScanTryRotate();
+    const bool tryInvert = stm->getScanTryInvert();
+    const bool tryDownscale = stm->getScanTryDownscale();
+
+    // a few decodes of a VGA frame, up to a second with the slowest settings: not on the GUI thread
+    m_calibrationThread = QThread::create([this, key, formats, tryHarder, tryRotate, tryInvert, tryDownscale]() {
+        const double cost = calibrateDecodeCostPerPixel(formats, tryHarder, tryRotate, tryInvert, tryDownscale);
+
+        QMetaObject::invokeMethod(this, [this, key, cost]() {
+            QSettings settings(QCoreApplication::organizationName(), QCoreApplication::applicationName());
+            settings.setValue("camera/calibrationKey", key);
+            settings.setValue("camera/decodeCostPerPixel", cost);
+            qDebug() << "UtilsCamera::calibrate() calibrated:" << cost << "ns/px";
+
+            m_calibrationThread = nullptr;
+            finishCalibration(key, cost);
+
+            if (m_calibrationPending)
+            {
+                m_calibrationPending = false;
+                calibrate();
+            }
+        }, Qt::QueuedConnection);
+    });
+    connect(m_calibrationThread, &QThread::finished, m_calibrationThread, &QObject::deleteLater);
+
+    m_calibrationThread->start();
+}
+
+void UtilsCamera::finishCalibration(const QString &key, double costPerPixel)
+{
+    m_calibrationKey = key;
+
+    if (m_decodeCostPerPixel != costPerPixel)
     {
-        qWarning() << "QCameraFormat(" << idx << ") res: " << format.resolution() << " pix: " << format.pixelFormat();
+        m_decodeCostPerPixel = costPerPixel;
+        Q_EMIT decodeCostPerPixelChanged();
+    }
+}
 
-        if (format.resolution() == QSize(1280, 720) &&
-            (!optimalPixelFormat || (optimalPixelFormat && format.pixelFormat() == optimalPixelFormat)))
-        {
-            qWarning() << "SELECTED FORMAT res: " << format.resolution() << " pix: " << format.pixelFormat();
-            return format;
-        }
+/* ************************************************************************** */
 
-        if (format.resolution() == QSize(1440, 1080) &&
-            (!optimalPixelFormat || (optimalPixelFormat && format.pixelFormat() == optimalPixelFormat)))
-        {
-            qWarning() << "SELECTED FORMAT res: " << format.resolution() << " pix: " << format.pixelFormat();
-            return format;
-        }
+QCameraFormat UtilsCamera::selectCameraFormat(int idx)
+{
+    if (idx > 0 && idx < QMediaDevices::videoInputs().size())
+    {
+        return selectCameraFormat(QMediaDevices::videoInputs().at(idx));
+    }
 
-        if (format.resolution() == QSize(1920, 1080) &&
-            (!optimalPixelFormat || (optimalPixelFormat && format.pixelFormat() == optimalPixelFormat)))
-        {
-            qWarning() << "SELECTED FORMAT res: " << format.resolution() << " pix: " << format.pixelFormat();
-            return format;
-        }
+    return selectCameraFormat(QMediaDevices::defaultVideoInput());
+}
+
+QCameraFormat UtilsCamera::selectCameraFormat(const QCameraDevice &device)
+{
+    const QList <QCameraFormat> formats = device.videoFormats();
+    if (formats.isEmpty()) return QCameraFormat();
 
-        if (format.resolution() == QSize(2560, 1440) &&
-            (!optimalPixelFormat || (optimalPixelFormat && format.pixelFormat() == optimalPixelFormat)))
+    if (m_decodeCostPerPixel <= 0.0) calibrate();
+    const double costPerPixel = (m_decodeCostPerPixel > 0.0) ? m_decodeCostPerPixel : s_defaultCostPerPixel;
+
+    // enough resolution for small or distant codes, a decoding rate that feels instant, a smooth preview
+    constexpr double targetShortSide = 1080.0;
+    constexpr double targetDecodeRate = 15.0;
+    constexpr double targetFrameRate = 30.0;
+
+    QCameraFormat selected;
+    double selectedScore = -1.0;
+
+    for (const auto &format : formats)
+    {
+        const QSize res = format.resolution();
+        const double pixels = double(res.width()) * res.height();
+        if (pixels <= 0.0) continue;
+
+        const double frameRate = std::min(double(format.maxFrameRate()), targetFrameRate);
+        const double decodeMs = pixels * costPerPixel * (1.0 + pixelFormatPenalty(format.pixelFormat())) / 1e6;
+        const double decodeRate = std::min(frameRate, 1000.0 / decodeMs);
+
+        const double resolutionScore = std::min(double(std::min(res.width(), res.height())), targetShortSide) / targetShortSide;
+        const double score = resolutionScore * std::min(decodeRate, targetDecodeRate) / targetDecodeRate +
+                             0.1 * frameRate / targetFrameRate;
+
+        // on a tie, the smaller frame is cheaper to move around
+        if (score > selectedScore + 1e-6 ||
+            (score > selectedScore - 1e-6 && pixels < double(selected.resolution().width()) * selected.resolution().height()))
         {
-            qWarning() << "SELECTED FORMAT res: " << format.resolution() << " pix: " << format.pixelFormat();
-            return format;
+            selected = format;
+            selectedScore = score;
         }
     }
 
-    return QCameraFormat();
+    qDebug() << "UtilsCamera::selectCameraFormat()" << device.description() << "res:" << selected.resolution()
+             << "pix:" << selected.pixelFormat() << "fps:" << selected.maxFrameRate() << "score:" << selectedScore;
+
+    return selected;
 }
 
 /* ************************************************************************** */
@@ -25,6 +25,8 @@
 
 #include <QImage>
 #include <QVideoFrame>
+#include <QVideoFrameFormat>
+#include <QCameraDevice>
 #include <QCameraFormat>
 #include <QMediaDevices>
 
@@ -32,22 +34,54 @@
 
 /* ************************************************************************** */
 
+class QThread;
+
 /*!
  * \brief The UtilsCamera class
+ *
+ * The camera format is selected with a cost model: every format of the device gets an
+ * estimated decoding time per frame, from its pixel count, a penalty for the pixel formats
+ * the decoder cannot read in place (RGB, Jpeg, GPU textures), and the decoding cost per pixel
+ * of this device. That cost is measured on a synthetic frame with the scan settings, on a
+ * worker thread, and cached in the settings. A default cost is used until it is known.
  */
 class UtilsCamera: public QObject
 {
     Q_OBJECT
 
+    Q_PROPERTY(double decodeCostPerPixel READ getDecodeCostPerPixel NOTIFY decodeCostPerPixelChanged)
+
     // Singleton
     static UtilsCamera *instance;
-    UtilsCamera() = default;
-    ~UtilsCamera() = default;
+    UtilsCamera();
+    ~UtilsCamera();
+
+    double m_decodeCostPerPixel = 0.0; // ns, 0 until calibrated
+    QString m_calibrationKey; // the device, build and scan settings m_decodeCostPerPixel was measured with
+    QThread *m_calibrationThread = nullptr;
+    bool m_calibrationPending = false; // the scan settings changed during the calibration
+
+    static constexpr double s_defaultCostPerPixel = 20.0; // ns, until calibrated
+
+    static QString calibrationKey();
+    static double calibrateDecodeCostPerPixel(unsigned formats, bool tryHarder, bool tryRotate,
+                                              bool tryInvert, bool tryDownscale);
+    void finishCalibration(const QString &key, double costPerPixel);
+    static double pixelFormatPenalty(QVideoFrameFormat::PixelFormat format);
+
+Q_SIGNALS:
+    void decodeCostPerPixelChanged();
 
 public:
     static UtilsCamera *getInstance();
 
-    static Q_INVOKABLE QCameraFormat selectCameraFormat(int idx = 0);
+    double getDecodeCostPerPixel() const { return m_decodeCostPerPixel; }
+
+    //! Load the decoding cost for the current scan settings, or measure it on a worker thread
+    Q_INVOKABLE void calibrate();
+
+    Q_INVOKABLE QCameraFormat selectCameraFormat(int idx = 0);
+    Q_INVOKABLE QCameraFormat selectCameraFormat(const QCameraDevice &device);
 };
 
 /* ************************************************************************** */
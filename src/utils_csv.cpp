@@ -0,0 +1,75 @@
+/*!
+ * This file is part of QmlMobileScanner.
+ * Copyright (c) 2023 Emeric Grange - All Rights Reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \date      2026
+ * \author    Emeric Grange <emeric.grange@gmail.com>
+ */
+
+#include "utils_csv.h"
+
+#include <QIODevice>
+
+/* ************************************************************************** */
+
+QByteArray readCsvRecord(QIODevice &device)
+{
+    QByteArray record;
+    qsizetype quotes = 0;
+
+    do {
+        const QByteArray line = device.readLine();
+        if (line.isEmpty()) break;
+
+        record += line;
+        quotes += line.count('"');
+    } while ((quotes % 2) != 0 && !device.atEnd());
+
+    return record;
+}
+
+QList<QByteArray> splitCsvRecord(const QByteArray &record, const char sep)
+{
+    QList<QByteArray> fields;
+    QByteArray field;
+    bool quoted = false;
+
+    for (qsizetype i = 0; i < record.size(); i++)
+    {
+        const char c = record.at(i);
+        if (quoted)
+        {
+            if (c != '"') field += c;
+            else if (i+1 < record.size() && record.at(i+1) == '"') { field += '"'; i++; }
+            else quoted = false;
+        }
+        else if (c == '"' && sep != '\t') quoted = true; // TSV dumps are not quoted
+        else if (c == sep) { fields.push_back(field); field.clear(); }
+        else if (c != '\r' && c != '\n') field += c;
+    }
+    fields.push_back(field);
+
+    return fields;
+}
+
+QByteArray quoteCsvField(const QString &field)
+{
+    QByteArray quoted = field.toUtf8();
+    quoted.replace('"', "\"\"");
+    return '"' + quoted + '"';
+}
+
+/* ************************************************************************** */
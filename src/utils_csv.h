@@ -0,0 +1,44 @@
+/*!
+ * This file is part of QmlMobileScanner.
+ * Copyright (c) 2023 Emeric Grange - All Rights Reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \date      2026
+ * \author    Emeric Grange <emeric.grange@gmail.com>
+ */
+
+#ifndef CSV_UTILS_H
+#define CSV_UTILS_H
+/* ************************************************************************** */
+
+#include <QList>
+#include <QString>
+#include <QByteArray>
+
+class QIODevice;
+
+/* ************************************************************************** */
+
+//! Read one CSV record, which may span several lines if quoted fields contain line breaks
+QByteArray readCsvRecord(QIODevice &device);
+
+//! Split a CSV record into fields (quotes are ignored for tab separated values)
+QList<QByteArray> splitCsvRecord(const QByteArray &record, const char sep = ',');
+
+//! Quote a field for CSV output
+QByteArray quoteCsvField(const QString &field);
+
+/* ************************************************************************** */
+#endif // CSV_UTILS_H
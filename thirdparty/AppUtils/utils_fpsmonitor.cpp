@@ -23,11 +23,14 @@
 
 #include "utils_fpsmonitor.h"
 
-#include <QMutableListIterator>
 #include <QQuickWindow>
 #include <QTimer>
 #include <QDebug>
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
 /* ************************************************************************** */
 
 FrameRateMonitor::FrameRateMonitor(QQuickWindow *window, QObject *parent) : QObject(parent)
@@ -37,8 +40,8 @@ FrameRateMonitor::FrameRateMonitor(QQuickWindow *window, QObject *parent) : QObj
     m_refreshTimer = new QTimer(this);
     connect(m_refreshTimer, &QTimer::timeout, this, &FrameRateMonitor::refresh);
 
-    m_refreshTimer->setInterval(1000);
-    m_refreshTimer->setSingleShot(true);
+    m_refreshTimer->setInterval(s_refreshInterval);
+    m_refreshTimer->start();
 }
 
 /* ************************************************************************** */
@@ -47,7 +50,8 @@ void FrameRateMonitor::setQuickWindow(QQuickWindow *window)
 {
     if (window)
     {
-        connect(window, &QQuickWindow::frameSwapped, this, &FrameRateMonitor::registerSample);
+        // recorded from the render thread, no queued event per frame
+        connect(window, &QQuickWindow::frameSwapped, this, &FrameRateMonitor::registerSample, Qt::DirectConnection);
     }
     else
     {
@@ -55,31 +59,109 @@ void FrameRateMonitor::setQuickWindow(QQuickWindow *window)
     }
 }
 
+void FrameRateMonitor::setVideoSink(QObject *videoSink)
+{
+    if (m_videoSink == videoSink) return;
+    if (m_videoSink) disconnect(m_videoSink, nullptr, this, nullptr);
+
+    m_videoSink = videoSink;
+
+    // string based connection, so that AppUtils does not depend on QtMultimedia
+    if (m_videoSink)
+    {
+        connect(m_videoSink, SIGNAL(videoFrameChanged(QVideoFrame)),
+                this, SLOT(registerCameraFrame()), Qt::DirectConnection);
+    }
+}
+
+qint64 FrameRateMonitor::timestamp()
+{
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+/* ************************************************************************** */
+
 void FrameRateMonitor::registerSample()
 {
-    QMutexLocker locker(&m_mutex);
-    m_timestamps.append(QDateTime::currentDateTime());
-    QTimer::singleShot(0, this, &FrameRateMonitor::refresh);
+    m_renderFrames.push(timestamp());
+}
+
+void FrameRateMonitor::registerCameraFrame()
+{
+    m_cameraFrames.push(timestamp());
+}
+
+void FrameRateMonitor::registerDecoding(double decodeStart, double decodeEnd)
+{
+    m_decodeTimes.push(static_cast<qint64>(decodeEnd - decodeStart));
+}
+
+void FrameRateMonitor::registerResult(double frameTime)
+{
+    m_latencies.push(timestamp() - static_cast<qint64>(frameTime));
+}
+
+/* ************************************************************************** */
+
+//! Number of timestamps during the last second, timestamps are sorted oldest first
+static int countLastSecond(const qint64 *timestamps, int size, qint64 now)
+{
+    return static_cast<int>(timestamps + size - std::upper_bound(timestamps, timestamps + size, now - 1000000));
+}
+
+//! Value (in ms) under which are p percent of the samples (in µs), the samples are reordered
+static double percentile(qint64 *samples, int size, int p)
+{
+    if (size <= 0) return 0.0;
+
+    qint64 *nth = samples + (size - 1) * p / 100;
+    std::nth_element(samples, nth, samples + size);
+    return *nth / 1000.0;
 }
 
 void FrameRateMonitor::refresh()
 {
-    QMutexLocker locker(&m_mutex);
-    QDateTime now = QDateTime::currentDateTime();
-
-    QMutableListIterator <QDateTime> it(m_timestamps);
-    while (it.hasNext()) {
-        if (it.next().msecsTo(now) > 1000) {
-            it.remove();
-        } else {
-            break;
+    const qint64 now = timestamp();
+    qint64 *scratch = m_scratch.data();
+    int size = 0;
+
+    // render frames: rate and jitter (standard deviation of the frame intervals) during the last second
+    size = m_renderFrames.read(scratch);
+    m_fps = countLastSecond(scratch, size, now);
+    m_fpsJitter = 0.0;
+    if (m_fps > 2)
+    {
+        const qint64 *frames = scratch + size - m_fps;
+        const double mean = (frames[m_fps - 1] - frames[0]) / double(m_fps - 1);
+        double variance = 0.0;
+        for (int i = 1; i < m_fps; i++)
+        {
+            const double d = (frames[i] - frames[i - 1]) - mean;
+            variance += d * d;
         }
+        m_fpsJitter = std::sqrt(variance / (m_fps - 1)) / 1000.0;
     }
 
-    m_fps = m_timestamps.size();
-    Q_EMIT fpsChanged();
+    // camera frames: rate during the last second
+    size = m_cameraFrames.read(scratch);
+    m_cameraFps = countLastSecond(scratch, size, now);
 
-    m_refreshTimer->start();
+    // decoding: mean time of the last 60 decoded frames
+    size = m_decodeTimes.read(scratch);
+    const int decodeCount = std::min(size, 60);
+    qint64 decodeTotal = 0;
+    for (int i = size - decodeCount; i < size; i++) decodeTotal += scratch[i];
+    m_decodeTime = decodeCount ? (decodeTotal / 1000.0 / decodeCount) : 0.0;
+
+    // camera to result latency
+    size = m_latencies.read(scratch);
+    m_latencyP50 = percentile(scratch, size, 50);
+    m_latencyP90 = percentile(scratch, size, 90);
+    m_latencyP99 = percentile(scratch, size, 99);
+
+    Q_EMIT fpsChanged();
+    Q_EMIT telemetryChanged();
 }
 
 /* ************************************************************************** */
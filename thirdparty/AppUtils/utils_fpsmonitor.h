@@ -26,15 +26,52 @@
 /* ************************************************************************** */
 
 #include <QObject>
-#include <QList>
-#include <QMutex>
-#include <QDateTime>
+#include <QPointer>
+
+#include <array>
+#include <atomic>
 
 class QTimer;
 class QQuickWindow;
 
 /* ************************************************************************** */
 
+/*!
+ * \brief Fixed size ring buffer of timestamps, lock-free and without allocation.
+ *
+ * Any thread can push(), the readers (the GUI thread) only get the most recent values.
+ * A value overwritten while being read is only a wrong telemetry sample, not a crash.
+ */
+template <int N>
+class TimestampRing
+{
+    std::array<std::atomic<qint64>, N> m_values {};
+    std::atomic<quint32> m_count { 0 };
+
+public:
+    static constexpr int capacity() { return N; }
+
+    void push(qint64 value)
+    {
+        const quint32 i = m_count.fetch_add(1, std::memory_order_relaxed);
+        m_values[i % N].store(value, std::memory_order_release);
+    }
+
+    //! Copy the (up to N) most recent values into out, oldest first, return how many
+    int read(qint64 *out) const
+    {
+        const quint32 count = m_count.load(std::memory_order_acquire);
+        const int size = (count < quint32(N)) ? int(count) : N;
+        for (int i = 0; i < size; i++)
+        {
+            out[i] = m_values[(count - size + i) % N].load(std::memory_order_acquire);
+        }
+        return size;
+    }
+};
+
+/* ************************************************************************** */
+
 /*!
  * \brief The FrameRateMonitor class
  *
@@ -43,29 +80,73 @@ class QQuickWindow;
  *
  * The FrameMonitor widget uses a simpler and pure QML method from qnanopainter.
  * - https://github.com/QUItCoding/qnanopainter/blob/master/examples/qnanopainter_vs_qpainter_demo/qml/FpsItem.qml
+ *
+ * Render frames, camera frames, decoding times and camera-to-result latencies are recorded
+ * from their own threads into lock-free ring buffers, timestamped with timestamp() (steady
+ * clock, in microseconds). The statistics are only computed twice per second, on the GUI thread.
  */
 class FrameRateMonitor : public QObject
 {
     Q_OBJECT
 
     Q_PROPERTY(int fps READ fps NOTIFY fpsChanged)
+    Q_PROPERTY(double fpsJitter READ fpsJitter NOTIFY fpsChanged)
+    Q_PROPERTY(int cameraFps READ cameraFps NOTIFY telemetryChanged)
+    Q_PROPERTY(double decodeTime READ decodeTime NOTIFY telemetryChanged)
+    Q_PROPERTY(double latencyP50 READ latencyP50 NOTIFY telemetryChanged)
+    Q_PROPERTY(double latencyP90 READ latencyP90 NOTIFY telemetryChanged)
+    Q_PROPERTY(double latencyP99 READ latencyP99 NOTIFY telemetryChanged)
+
+    static constexpr int s_ringSize = 256; // about 2 seconds of 120 Hz rendering
+    static constexpr int s_refreshInterval = 500; // ms
+
+    TimestampRing <s_ringSize> m_renderFrames;
+    TimestampRing <s_ringSize> m_cameraFrames;
+    TimestampRing <s_ringSize> m_decodeTimes; // durations
+    TimestampRing <s_ringSize> m_latencies; // durations
+    std::array <qint64, s_ringSize> m_scratch; // for refresh(), only used from the GUI thread
 
-    QMutex m_mutex;
-    QList <QDateTime> m_timestamps;
     QTimer *m_refreshTimer = nullptr;
+    QPointer <QObject> m_videoSink;
 
     int m_fps = 0;
+    double m_fpsJitter = 0.0;
+    int m_cameraFps = 0;
+    double m_decodeTime = 0.0;
+    double m_latencyP50 = 0.0;
+    double m_latencyP90 = 0.0;
+    double m_latencyP99 = 0.0;
+
     int fps() const { return m_fps; }
+    double fpsJitter() const { return m_fpsJitter; }
+    int cameraFps() const { return m_cameraFps; }
+    double decodeTime() const { return m_decodeTime; }
+    double latencyP50() const { return m_latencyP50; }
+    double latencyP90() const { return m_latencyP90; }
+    double latencyP99() const { return m_latencyP99; }
 
 Q_SIGNALS:
     void fpsChanged();
+    void telemetryChanged();
 
 public:
     FrameRateMonitor(QQuickWindow *window = nullptr, QObject *parent = nullptr);
     Q_INVOKABLE void setQuickWindow(QQuickWindow *window);
 
+    //! Record the arrival of every camera frame, directly from the thread delivering them
+    Q_INVOKABLE void setVideoSink(QObject *videoSink);
+
+    //! Monotonic timestamp used by all the recordings, in microseconds
+    static qint64 timestamp();
+
+    //! Decoding start and end timestamps (from timestamp()) of a camera frame
+    Q_INVOKABLE void registerDecoding(double decodeStart, double decodeEnd);
+    //! A result from the camera frame with the given timestamp reached the UI
+    Q_INVOKABLE void registerResult(double frameTime);
+
 public slots:
     void registerSample();
+    void registerCameraFrame();
     void refresh();
 };
 
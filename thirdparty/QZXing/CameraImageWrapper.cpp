@@ -1,67 +1,8 @@
 #include "CameraImageWrapper.h"
 #include <QColor>
 
-//values based on http://entropymine.com/imageworsener/grayscale/
-//round(0,2127*R)
-const zxing::byte CameraImageWrapper::R_TO_GREYSCALE[256] =  {
-    0, 0, 0, 1, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4,
-    5, 5, 5, 5, 6, 6, 6, 6, 6, 7, 7, 7, 7, 7, 8, 8, 8, 8, 9, 9, 9, 9, 9,
-    10, 10, 10, 10, 10, 11, 11, 11, 11, 11, 12, 12, 12, 12, 13, 13, 13, 13, 13,
-    14, 14, 14, 14, 14, 15, 15, 15, 15, 16, 16, 16, 16, 16, 17, 17, 17, 17, 17,
-    18, 18, 18, 18, 18, 19, 19, 19, 19, 20, 20, 20, 20, 20, 21, 21, 21, 21, 21,
-    22, 22, 22, 22, 23, 23, 23, 23, 23, 24, 24, 24, 24, 24, 25, 25, 25, 25,
-    26, 26, 26, 26, 26, 27, 27, 27, 27, 27, 28, 28, 28, 28, 28, 29, 29, 29, 29,
-    30, 30, 30, 30, 30, 31, 31, 31, 31, 31, 32, 32, 32, 32, 33, 33, 33, 33, 33,
-    34, 34, 34, 34, 34, 35, 35, 35, 35, 36, 36, 36, 36, 36, 37, 37, 37, 37, 37,
-    38, 38, 38, 38, 38, 39, 39, 39, 39, 40, 40, 40, 40, 40, 41, 41, 41, 41, 41,
-    42, 42, 42, 42, 43, 43, 43, 43, 43, 44, 44, 44, 44, 44, 45, 45, 45, 45, 45,
-    46, 46, 46, 46, 47, 47, 47, 47, 47, 48, 48, 48, 48, 48, 49, 49, 49, 49,
-    50, 50, 50, 50, 50, 51, 51, 51, 51, 51, 52, 52, 52, 52, 53, 53, 53, 53, 53,
-    54, 54, 54, 54
-};
-
-//values based on http://entropymine.com/imageworsener/grayscale/
-//round(0,7152*G)
-const zxing::byte CameraImageWrapper::G_TO_GREYSCALE[256] = {
-    0, 1, 1, 2, 3, 4, 4, 5, 6, 6, 7, 8, 9, 9, 10, 11, 11, 12, 13,
-    14, 14, 15, 16, 16, 17, 18, 19, 19, 20, 21, 21, 22, 23, 24, 24,
-    25, 26, 26, 27, 28, 29, 29, 30, 31, 31, 32, 33, 34, 34, 35,
-    36, 36, 37, 38, 39, 39, 40, 41, 41, 42, 43, 44, 44, 45, 46, 46, 47,
-    48, 49, 49, 50, 51, 51, 52, 53, 54, 54, 55, 56, 57, 57, 58, 59, 59,
-    60, 61, 62, 62, 63, 64, 64, 65, 66, 67, 67, 68, 69, 69, 70, 71,
-    72, 72, 73, 74, 74, 75, 76, 77, 77, 78, 79, 79, 80, 81, 82, 82,
-    83, 84, 84, 85, 86, 87, 87, 88, 89, 89, 90, 91, 92, 92, 93, 94, 94,
-    95, 96, 97, 97, 98, 99, 99, 100, 101, 102, 102, 103, 104, 104, 105, 106,
-    107, 107, 108, 109, 109, 110, 111, 112, 112, 113, 114, 114, 115, 116,
-    117, 117, 118, 119, 119, 120, 121, 122, 122, 123, 124, 124, 125, 126,
-    127, 127, 128, 129, 129, 130, 131, 132, 132, 133, 134, 134, 135, 136,
-    137, 137, 138, 139, 139, 140, 141, 142, 142, 143, 144, 144, 145, 146,
-    147, 147, 148, 149, 149, 150, 151, 152, 152, 153, 154, 154, 155, 156,
-    157, 157, 158, 159, 159, 160, 161, 162, 162, 163, 164, 164, 165, 166,
-    167, 167, 168, 169, 170, 170, 171, 172, 172, 173, 174, 175, 175, 176,
-    177, 177, 178, 179, 180, 180, 181, 182, 182
-};
-
-//values based on http://entropymine.com/imageworsener/grayscale/
-//round(0,0722*B)
-const zxing::byte CameraImageWrapper::B_TO_GREYSCALE[256] = {
-    0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
-    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
-    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,
-    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
-    8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9,
-    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
-    11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11,
-    12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
-    13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13, 13,
-    14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14, 14,
-    15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
-    16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
-    17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17,
-    18, 18, 18, 18, 18, 18, 18, 18, 18, 18, 18, 18, 18
-};
-
-
+#include <algorithm>
+#include <cstring>
 
 CameraImageWrapper::CameraImageWrapper() : LuminanceSource(0,0)
 {
@@ -75,9 +16,33 @@ CameraImageWrapper::CameraImageWrapper(const QImage &sourceImage) : LuminanceSou
                 new GreyscaleLuminanceSource(getMatrixP(), sourceImage.width(), sourceImage.height(),0, 0, sourceImage.width(), sourceImage.height()));
 }
 
+CameraImageWrapper::CameraImageWrapper(const zxing::byte *origin, int width, int height, ptrdiff_t stepX, ptrdiff_t stepY) : LuminanceSource(width, height)
+{
+    imageBytes = QSharedPointer<std::vector<zxing::byte>>(new std::vector<zxing::byte>((size_t)height * (size_t)width));
+    zxing::byte* m = &(*imageBytes)[0];
+
+    for(int j=0; j<height; j++)
+    {
+        const zxing::byte *src = origin + j * stepY;
+        if(stepX == 1)
+        {
+            memcpy(m, src, width);
+        }
+        else
+        {
+            for(int i=0; i<width; i++)
+                m[i] = src[i * stepX];
+        }
+        m += width;
+    }
+
+    delegate = QSharedPointer<GreyscaleLuminanceSource>(
+                new GreyscaleLuminanceSource(getMatrixP(), width, height, 0, 0, width, height));
+}
+
 CameraImageWrapper::CameraImageWrapper(CameraImageWrapper& otherInstance) : LuminanceSource(otherInstance.getWidth(), otherInstance.getHeight())
 {
-    imageBytesPerRow = otherInstance.getOriginalImage();
+    imageBytes = otherInstance.getOriginalImage();
     delegate = otherInstance.getDelegate();
 }
 
@@ -101,9 +66,145 @@ QSharedPointer<CameraImageWrapper> CameraImageWrapper::Factory(const QImage &sou
         return QSharedPointer<CameraImageWrapper>(new CameraImageWrapper(sourceImage));
 }
 
-QSharedPointer<std::vector<QSharedPointer<std::vector<zxing::byte>>>> CameraImageWrapper::getOriginalImage()
+QSharedPointer<CameraImageWrapper> CameraImageWrapper::Factory(const zxing::byte *luma, int width, int height,
+                                                               ptrdiff_t rowStride, ptrdiff_t pixStride, int rotation,
+                                                               int maxWidth, int maxHeight)
 {
-    return imageBytesPerRow;
+    rotation = ((rotation % 360) + 360) % 360;
+    if(!luma || width <= 0 || height <= 0 || (rotation % 90) != 0)
+        return QSharedPointer<CameraImageWrapper>();
+
+    const bool transposed = (rotation == 90 || rotation == 270);
+    const int outWidth = transposed ? height : width;
+    const int outHeight = transposed ? width : height;
+
+    // output pixel (x, y) is read at origin + x * stepX + y * stepY
+    const zxing::byte *origin = luma;
+    ptrdiff_t stepX = pixStride;
+    ptrdiff_t stepY = rowStride;
+    switch(rotation)
+    {
+    case 90: // out(x, y) = in(width - 1 - y, x)
+        origin = luma + (width - 1) * pixStride;
+        stepX = rowStride;
+        stepY = -pixStride;
+        break;
+    case 180: // out(x, y) = in(width - 1 - x, height - 1 - y)
+        origin = luma + (height - 1) * rowStride + (width - 1) * pixStride;
+        stepX = -pixStride;
+        stepY = -rowStride;
+        break;
+    case 270: // out(x, y) = in(y, height - 1 - x)
+        origin = luma + (height - 1) * rowStride;
+        stepX = -rowStride;
+        stepY = pixStride;
+        break;
+    }
+
+    // fit in maxWidth x maxHeight, keeping the aspect ratio
+    int scaledWidth = outWidth;
+    int scaledHeight = outHeight;
+    if(maxWidth > 0 && scaledWidth > maxWidth)
+    {
+        scaledHeight = std::max(1, int(qint64(scaledHeight) * maxWidth / scaledWidth));
+        scaledWidth = maxWidth;
+    }
+    if(maxHeight > 0 && scaledHeight > maxHeight)
+    {
+        scaledWidth = std::max(1, int(qint64(scaledWidth) * maxHeight / scaledHeight));
+        scaledHeight = maxHeight;
+    }
+
+    if(scaledWidth == outWidth && scaledHeight == outHeight)
+        return QSharedPointer<CameraImageWrapper>(new CameraImageWrapper(origin, outWidth, outHeight, stepX, stepY));
+
+    std::vector<zxing::byte> scaled = areaScale(origin, outWidth, outHeight, stepX, stepY, scaledWidth, scaledHeight);
+    return QSharedPointer<CameraImageWrapper>(new CameraImageWrapper(scaled.data(), scaledWidth, scaledHeight, 1, scaledWidth));
+}
+
+std::vector<zxing::byte> CameraImageWrapper::areaScale(const zxing::byte *origin, int width, int height,
+                                                       ptrdiff_t stepX, ptrdiff_t stepY, int scaledWidth, int scaledHeight)
+{
+    // Input pixel i covers [i * dst, (i + 1) * dst) and output pixel x covers [x * src, (x + 1) * src),
+    // so the weights are integers and sum to src for every output pixel.
+    struct Weights
+    {
+        std::vector<int> first; // first input pixel of every output pixel
+        std::vector<int> offset; // of its weights in weights, one more entry than the output pixels
+        std::vector<int> weights;
+    };
+    auto areaWeights = [](int src, int dst) {
+        Weights w;
+        w.first.resize(dst);
+        w.offset.resize(dst + 1);
+        for(int x=0; x<dst; x++)
+        {
+            const qint64 begin = qint64(x) * src, end = qint64(x + 1) * src;
+            w.first[x] = int(begin / dst);
+            w.offset[x] = int(w.weights.size());
+            for(int i=w.first[x]; qint64(i) * dst < end; i++)
+                w.weights.push_back(int(std::min(qint64(i + 1) * dst, end) - std::max(qint64(i) * dst, begin)));
+        }
+        w.offset[dst] = int(w.weights.size());
+        return w;
+    };
+    const Weights wx = areaWeights(width, scaledWidth);
+    const Weights wy = areaWeights(height, scaledHeight);
+
+    const quint64 total = quint64(width) * quint64(height);
+    std::vector<zxing::byte> scaled((size_t)scaledWidth * (size_t)scaledHeight);
+    std::vector<quint32> row(scaledWidth); // one input row, scaled horizontally
+    std::vector<quint64> sum(scaledWidth);
+    int rowIndex = -1; // the input row in row, shared by two output rows when it straddles them
+
+    for(int y=0; y<scaledHeight; y++)
+    {
+        std::fill(sum.begin(), sum.end(), 0);
+        for(int k=wy.offset[y]; k<wy.offset[y + 1]; k++)
+        {
+            const int j = wy.first[y] + k - wy.offset[y];
+            if(j != rowIndex)
+            {
+                const zxing::byte *src = origin + j * stepY;
+                for(int x=0; x<scaledWidth; x++)
+                {
+                    quint32 v = 0;
+                    const zxing::byte *p = src + wx.first[x] * stepX;
+                    for(int l=wx.offset[x]; l<wx.offset[x + 1]; l++, p += stepX)
+                        v += quint32(wx.weights[l]) * *p;
+                    row[x] = v;
+                }
+                rowIndex = j;
+            }
+            for(int x=0; x<scaledWidth; x++)
+                sum[x] += quint64(wy.weights[k]) * row[x];
+        }
+
+        zxing::byte *dst = scaled.data() + (size_t)y * scaledWidth;
+        for(int x=0; x<scaledWidth; x++)
+            dst[x] = zxing::byte((sum[x] + total / 2) / total);
+    }
+
+    return scaled;
+}
+
+void CameraImageWrapper::rgbToGrayscale(const zxing::byte *src, int pixStride, int offsetR, int offsetG, int offsetB,
+                                        zxing::byte *dst, int count)
+{
+    const zxing::byte *r = src + offsetR;
+    const zxing::byte *g = src + offsetG;
+    const zxing::byte *b = src + offsetB;
+
+    if(pixStride == 4) // constant stride, the 32 bits formats are deinterleaved with vector loads
+    {
+        for(int i=0; i<count; i++)
+            dst[i] = gray(r[4 * i], g[4 * i], b[4 * i]);
+    }
+    else
+    {
+        for(int i=0; i<count; i++)
+            dst[i] = gray(r[i * pixStride], g[i * pixStride], b[i * pixStride]);
+    }
 }
 
 QSharedPointer<std::vector<zxing::byte>> CameraImageWrapper::getRow(int y, QSharedPointer<std::vector<zxing::byte>> row) const
@@ -166,12 +267,13 @@ QSharedPointer<std::vector<zxing::byte>> CameraImageWrapper::getRowP(int y, QSha
 {
     int width = getWidth();
 
-    if (row->size() != width)
+    if (!row || row->size() != width)
         row.reset(new std::vector<zxing::byte>(width));
 
     Q_ASSERT(y >= 0 && y < getHeight());
 
-    return (*imageBytesPerRow)[y];
+    memcpy(&(*row)[0], &(*imageBytes)[(size_t)y * width], width);
+    return row;
 }
 
 QSharedPointer<std::vector<zxing::byte>> CameraImageWrapper::getMatrixP() const
@@ -179,46 +281,36 @@ QSharedPointer<std::vector<zxing::byte>> CameraImageWrapper::getMatrixP() const
     return imageBytes;
 }
 
-zxing::byte CameraImageWrapper::gray(const unsigned int r, const unsigned int g, const unsigned int b)
-{
-    //the values are not masked with (x & 0xFF) because functions qRed, qGreen, qBlue already do it
-    return R_TO_GREYSCALE[r] + G_TO_GREYSCALE[g] + B_TO_GREYSCALE[b];
-}
-
 void CameraImageWrapper::updateImageAsGrayscale(const QImage &origin)
 {
-    bool needsConvesionToGrayscale = origin.format() != QImage::Format_Grayscale8;
-
-    QRgb pixel;
-    zxing::byte pixelGrayscale;
-
     const int width = getWidth();
     const int height = getHeight();
 
     imageBytes = QSharedPointer<std::vector<zxing::byte>>(new std::vector<zxing::byte>((size_t)height * (size_t)width));
-    imageBytesPerRow = QSharedPointer<std::vector<QSharedPointer<std::vector<zxing::byte>>>>(new std::vector<QSharedPointer<std::vector<zxing::byte>>>(height));
     zxing::byte* m = &(*imageBytes)[0];
 
+    // row by row on the image memory, the formats without a fast path are converted once beforehand
+    QImage image = origin;
+    if(image.format() != QImage::Format_Grayscale8 &&
+       image.format() != QImage::Format_RGB32 &&
+       image.format() != QImage::Format_ARGB32 &&
+       image.format() != QImage::Format_ARGB32_Premultiplied)
+    {
+        image = origin.convertToFormat(QImage::Format_RGB32);
+    }
+
+    // QRgb is 0xAARRGGBB in native endianness
+    const int offsetB = (Q_BYTE_ORDER == Q_LITTLE_ENDIAN) ? 0 : 3;
+    const int offsetG = (Q_BYTE_ORDER == Q_LITTLE_ENDIAN) ? 1 : 2;
+    const int offsetR = (Q_BYTE_ORDER == Q_LITTLE_ENDIAN) ? 2 : 1;
+
     for(int j=0; j<height; j++)
     {
-        QSharedPointer<std::vector<zxing::byte>> line(new std::vector<zxing::byte>(width));
-        for(int i=0; i<width; i++)
-        {
-            pixel = origin.pixel(i,j);
-            if(needsConvesionToGrayscale)
-                pixelGrayscale = gray(qRed(pixel),qGreen(pixel),qBlue(pixel));
-            else
-                pixelGrayscale = pixel & 0xFF;
-            (*line)[i] = pixelGrayscale;
-        }
-        (*imageBytesPerRow)[j] = line;
-
-#if __cplusplus > 199711L
-        memcpy(m, (*line).data(), width);  ///the below line is also usable
-#else
-        memcpy(m, &(*line)[0], width);
-#endif
-        m += width * sizeof(zxing::byte);
+        const zxing::byte *line = reinterpret_cast<const zxing::byte *>(image.constScanLine(j));
+        if(image.format() == QImage::Format_Grayscale8)
+            memcpy(m, line, width);
+        else
+            rgbToGrayscale(line, 4, offsetR, offsetG, offsetB, m, width);
+        m += width;
     }
 }
-
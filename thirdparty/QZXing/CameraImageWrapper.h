@@ -21,6 +21,8 @@
 #include <QString>
 #include <zxing/zxing/common/GreyscaleLuminanceSource.h>
 
+#include <cstddef>
+
 using namespace zxing;
 
 class CameraImageWrapper : public LuminanceSource
@@ -28,12 +30,30 @@ class CameraImageWrapper : public LuminanceSource
 public:
     CameraImageWrapper();
     CameraImageWrapper(const QImage& sourceImage);
+    CameraImageWrapper(const zxing::byte *origin, int width, int height, ptrdiff_t stepX, ptrdiff_t stepY);
     CameraImageWrapper(CameraImageWrapper& otherInstance);
     ~CameraImageWrapper();
 
     static QSharedPointer<CameraImageWrapper> Factory(const QImage& image, int maxWidth=-1, int maxHeight=-1, bool smoothTransformation=false);
-    
-    QSharedPointer<std::vector<QSharedPointer<std::vector<zxing::byte>> > > getOriginalImage();
+
+    /**
+      * Copy a luminance plane (any row and pixel stride, so the Y plane of a mapped video frame works too),
+      * rotated counter clockwise by a multiple of 90 degrees. The rotation only changes the order of the reads.
+      * An image larger than maxWidth or maxHeight is scaled down to fit, averaging the input pixels
+      * each output pixel covers (the smooth scale of the QImage path).
+      */
+    static QSharedPointer<CameraImageWrapper> Factory(const zxing::byte *luma, int width, int height,
+                                                      ptrdiff_t rowStride, ptrdiff_t pixStride, int rotation,
+                                                      int maxWidth=-1, int maxHeight=-1);
+
+    /**
+      * Grayscale conversion of count pixels with their R, G and B bytes at the given offsets, pixStride bytes apart.
+      * Plain integer arithmetic without table lookup, so that the compiler can vectorize it.
+      */
+    static void rgbToGrayscale(const zxing::byte *src, int pixStride, int offsetR, int offsetG, int offsetB,
+                               zxing::byte *dst, int count);
+
+    QSharedPointer<std::vector<zxing::byte>> getOriginalImage() { return imageBytes; }
     QSharedPointer<GreyscaleLuminanceSource> getDelegate() { return delegate; }
 
     QSharedPointer<std::vector<zxing::byte>> getRow(int y, QSharedPointer<std::vector<zxing::byte>> row) const;
@@ -45,20 +65,21 @@ public:
     QSharedPointer<LuminanceSource> invert() const;
     QSharedPointer<LuminanceSource> rotateCounterClockwise() const;
 
-    inline zxing::byte gray(const unsigned int r, const unsigned int g, const unsigned int b);
-  
+    static inline zxing::byte gray(const unsigned int r, const unsigned int g, const unsigned int b)
+    {
+        // BT.709 luma weights (0.2127, 0.7152, 0.0722), 8 bits fixed point
+        return static_cast<zxing::byte>((54 * r + 183 * g + 19 * b) >> 8);
+    }
+
 private:
     QSharedPointer<std::vector<zxing::byte>> getRowP(int y, QSharedPointer<std::vector<zxing::byte>> row) const;
     QSharedPointer<std::vector<zxing::byte>> getMatrixP() const;
     void updateImageAsGrayscale(const QImage &origin);
+    static std::vector<zxing::byte> areaScale(const zxing::byte *origin, int width, int height,
+                                              ptrdiff_t stepX, ptrdiff_t stepY, int scaledWidth, int scaledHeight);
 
     QSharedPointer<GreyscaleLuminanceSource> delegate;
-    QSharedPointer<std::vector<QSharedPointer<std::vector<zxing::byte>>>> imageBytesPerRow;
     QSharedPointer<std::vector<zxing::byte>> imageBytes;
-
-    static const zxing::byte B_TO_GREYSCALE[256];
-    static const zxing::byte G_TO_GREYSCALE[256];
-    static const zxing::byte R_TO_GREYSCALE[256];
 };
 
 #endif //CAMERAIMAGE_H
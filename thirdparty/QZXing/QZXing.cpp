@@ -352,7 +352,6 @@ QString QZXing::decodeImage(const QImage &image, int maxWidth, int maxHeight, bo
     QElapsedTimer t;
     t.start();
     processingTime = -1;
-    QSharedPointer<Result> res;
     emit decodingStarted();
 
     if (image.isNull())
@@ -369,6 +368,29 @@ QString QZXing::decodeImage(const QImage &image, int maxWidth, int maxHeight, bo
     else
         ciw = CameraImageWrapper::Factory(image, 999, 999, true);
 
+    return decodeWrapper(ciw, t);
+}
+
+QString QZXing::decodeLuminance(const QSharedPointer<CameraImageWrapper> &image)
+{
+    QElapsedTimer t;
+    t.start();
+    processingTime = -1;
+    emit decodingStarted();
+
+    if (!image)
+    {
+        processingTime = t.elapsed();
+        emit decodingFinished(false);
+        return "";
+    }
+
+    return decodeWrapper(image, t);
+}
+
+QString QZXing::decodeWrapper(const QSharedPointer<CameraImageWrapper> &ciw, QElapsedTimer &t)
+{
+    QSharedPointer<Result> res;
     QString errorMessage = "Unknown";
 
     QSharedPointer<LuminanceSource> imageRefOriginal = ciw;
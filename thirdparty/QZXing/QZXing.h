@@ -21,6 +21,7 @@
 #include <QImage>
 #include <QVariantList>
 #include <QElapsedTimer>
+#include <QSharedPointer>
 
 #include <set>
 
@@ -32,6 +33,7 @@ class ResultMetadata;
 
 class QQmlEngine;
 class ImageHandler;
+class CameraImageWrapper;
 
 #ifdef ENABLE_ENCODER_GENERIC
 struct QZXingEncoderConfig;
@@ -238,7 +240,15 @@ public slots:
       */
     void setDecoder(const uint &hint);
 
+    /**
+      * The decoding function for an image already converted to luminance, see CameraImageWrapper::Factory().
+      * Used by the video filter, which crops and rotates the camera frames without going through a QImage.
+      */
+    QString decodeLuminance(const QSharedPointer<CameraImageWrapper> &image);
+
 private:
+    QString decodeWrapper(const QSharedPointer<CameraImageWrapper> &ciw, QElapsedTimer &t);
+
     zxing::MultiFormatReader *decoder;
     DecoderFormatType enabledDecoders;
     TryHarderBehaviourType tryHarderType;
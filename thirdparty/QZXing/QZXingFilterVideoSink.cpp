@@ -1,7 +1,13 @@
 #include "QZXingFilterVideoSink.h"
+#include "CameraImageWrapper.h"
+
 #include <QDebug>
+#include <QScopeGuard>
 #include <QtConcurrent/QtConcurrent>
 
+#include <utility>
+#include <vector>
+
 QZXingFilter::QZXingFilter(QObject *parent) : QObject(parent)
 {
     connect(&m_decoder, &QZXing::decodingStarted, this, &QZXingFilter::handleDecodingStarted);
@@ -67,6 +73,133 @@ void QZXingFilter::handleDecodingFinished(bool succeeded)
     emit decodingFinished(succeeded, m_decoder.getProcessTimeOfLastDecoding());
 }
 
+/*!
+ * \brief Luminance of the capture rectangle of a camera frame, rotated counter clockwise by orientation.
+ *
+ * The frame is only mapped, the crop and the rotation are strides over its memory: the Y plane of
+ * the YUV formats is read as is, the RGB formats are converted over the capture rectangle only.
+ * The frame rotation and scan line direction are folded into the strides, as captureRect is in
+ * the orientation toImage() gives. Returns null for the formats without a CPU readable luminance
+ * (Jpeg, textures), for mirrored frames, and for orientations that are not a multiple of 90°.
+ */
+static QSharedPointer<CameraImageWrapper> frameLuminance(const QVideoFrame &frame, const QRect &captureRect, int orientation)
+{
+    if (orientation % 90) return {};
+
+    int pixStride = 1;
+    int pixOffset = 0;
+    int offsetR = -1, offsetG = -1, offsetB = -1; // RGB formats only
+
+    switch (frame.pixelFormat())
+    {
+    case QVideoFrameFormat::Format_ARGB8888:
+    case QVideoFrameFormat::Format_ARGB8888_Premultiplied:
+    case QVideoFrameFormat::Format_XRGB8888:
+        pixStride = 4, offsetR = 1, offsetG = 2, offsetB = 3; break;
+    case QVideoFrameFormat::Format_BGRA8888:
+    case QVideoFrameFormat::Format_BGRA8888_Premultiplied:
+    case QVideoFrameFormat::Format_BGRX8888:
+        pixStride = 4, offsetR = 2, offsetG = 1, offsetB = 0; break;
+    case QVideoFrameFormat::Format_ABGR8888:
+    case QVideoFrameFormat::Format_XBGR8888:
+        pixStride = 4, offsetR = 3, offsetG = 2, offsetB = 1; break;
+    case QVideoFrameFormat::Format_RGBA8888:
+    case QVideoFrameFormat::Format_RGBX8888:
+        pixStride = 4, offsetR = 0, offsetG = 1, offsetB = 2; break;
+
+    case QVideoFrameFormat::Format_YUV420P:
+    case QVideoFrameFormat::Format_YUV422P:
+    case QVideoFrameFormat::Format_YV12:
+    case QVideoFrameFormat::Format_NV12:
+    case QVideoFrameFormat::Format_NV21:
+    case QVideoFrameFormat::Format_IMC1:
+    case QVideoFrameFormat::Format_IMC2:
+    case QVideoFrameFormat::Format_IMC3:
+    case QVideoFrameFormat::Format_IMC4:
+    case QVideoFrameFormat::Format_Y8:
+        break;
+    case QVideoFrameFormat::Format_P010:
+    case QVideoFrameFormat::Format_P016:
+    case QVideoFrameFormat::Format_Y16:
+        pixStride = 2, pixOffset = 1; break; // most significant byte
+    case QVideoFrameFormat::Format_AYUV:
+    case QVideoFrameFormat::Format_AYUV_Premultiplied:
+        pixStride = 4, pixOffset = 1; break;
+    case QVideoFrameFormat::Format_UYVY:
+        pixStride = 2, pixOffset = 1; break;
+    case QVideoFrameFormat::Format_YUYV:
+        pixStride = 2; break;
+
+    default:
+        return {};
+    }
+
+    // a mirror combined with a quarter turn depends on the order toImage() applies them in, leave it to toImage()
+    if (frame.mirrored() || frame.surfaceFormat().isMirrored()) return {};
+
+    // shallow copy just to get access to the non-const map() function
+    QVideoFrame frame_ro = frame;
+    if (!frame_ro.map(QVideoFrame::ReadOnly)) return {};
+    auto unmap = qScopeGuard([&frame_ro] { frame_ro.unmap(); });
+
+    // the frame as toImage() shows it (captureRect is in that orientation): pixel (x, y) at origin + x * pixStep + y * rowStep
+    int width = frame_ro.width();
+    int height = frame_ro.height();
+    const zxing::byte *origin = frame_ro.bits(0);
+    ptrdiff_t pixStep = pixStride;
+    ptrdiff_t rowStep = frame_ro.bytesPerLine(0);
+    if (frame_ro.surfaceFormat().scanLineDirection() == QVideoFrameFormat::BottomToTop)
+    {
+        origin += (height - 1) * rowStep;
+        rowStep = -rowStep;
+    }
+    switch (frame_ro.rotation())
+    {
+    case QtVideo::Rotation::Clockwise90: // shown(x, y) = frame(y, height - 1 - x)
+        origin += (height - 1) * rowStep;
+        std::swap(width, height);
+        pixStep = std::exchange(rowStep, pixStep);
+        pixStep = -pixStep;
+        break;
+    case QtVideo::Rotation::Clockwise180: // shown(x, y) = frame(width - 1 - x, height - 1 - y)
+        origin += (height - 1) * rowStep + (width - 1) * pixStep;
+        pixStep = -pixStep;
+        rowStep = -rowStep;
+        break;
+    case QtVideo::Rotation::Clockwise270: // shown(x, y) = frame(width - 1 - y, x)
+        origin += (width - 1) * pixStep;
+        std::swap(width, height);
+        rowStep = -std::exchange(pixStep, rowStep);
+        break;
+    default:
+        break;
+    }
+
+    QRect rect(0, 0, width, height);
+    if (captureRect.isValid()) rect &= captureRect;
+    if (rect.isEmpty()) return {};
+
+    const zxing::byte *bits = origin + rect.top() * rowStep + rect.left() * pixStep;
+
+    // same size limit as QZXing::decodeImage()
+    constexpr int maxSize = 999;
+
+    if (offsetR < 0)
+    {
+        return CameraImageWrapper::Factory(bits + pixOffset, rect.width(), rect.height(), rowStep, pixStep,
+                                           orientation, maxSize, maxSize);
+    }
+
+    std::vector<zxing::byte> luma(size_t(rect.width()) * rect.height());
+    for (int y = 0; y < rect.height(); y++)
+    {
+        CameraImageWrapper::rgbToGrayscale(bits + y * rowStep, int(pixStep), offsetR, offsetG, offsetB,
+                                           luma.data() + size_t(y) * rect.width(), rect.width());
+    }
+    return CameraImageWrapper::Factory(luma.data(), rect.width(), rect.height(), rect.width(), 1,
+                                       orientation, maxSize, maxSize);
+}
+
 void QZXingFilter::processFrame(const QVideoFrame &frame)
 {
     if (m_decoder.getEnabledFormats() == QZXing::DecoderFormat_None) return;
@@ -76,6 +209,14 @@ void QZXingFilter::processFrame(const QVideoFrame &frame)
         //qWarning() << ">>> QZXingFilter::process() >>> surfaceFormat > " << frame.surfaceFormat() << " > rotation > " << frame.rotationAngle();
 
         m_processThread = QtConcurrent::run([=, this]() {
+            // crop and rotation straight from the frame memory, one copy of the capture rectangle
+            QSharedPointer<CameraImageWrapper> luminance = frameLuminance(frame, m_captureRect, m_orientation);
+            if (luminance)
+            {
+                m_decoder.decodeLuminance(luminance);
+                return;
+            }
+
             QImage image = frame.toImage(); // moved here, from outside the QtConcurrent::run()
             if (image.isNull())
             {
@@ -1041,15 +1041,6 @@ static void qr_populate_grid(unsigned char *grid, const int h_size, const int v_
 }
 
 #ifdef ZINTLOG
-static void append_log(const unsigned char log) {
-    FILE *file;
-
-    if ((file = fopen("zintlog.txt", "a+"))) {
-        fprintf(file, "%02X", log);
-        (void) fclose(file);
-    }
-}
-
 static void write_log(const char log[]) {
     FILE *file;
 
@@ -1060,221 +1051,124 @@ static void write_log(const char log[]) {
 }
 #endif
 
-static int qr_evaluate(unsigned char *local, const int size) {
-    static const unsigned char h1011101[7] = { 1, 0, 1, 1, 1, 0, 1 };
-
-    int x, y, r, k, block;
-    int result = 0;
-    char state;
-    int dark_mods;
-    double percentage;
-    int a, b, afterCount, beforeCount;
-#ifdef ZINTLOG
-    int result_b = 0;
-    char str[15];
-#endif
+/* Spread the 8 bits of `lanes` to the low bits of the 8 bytes of the result, so that per-mask counts can be
+   accumulated 8 at a time with one addition (each byte counts for one mask pattern, up to 255) */
+static uint64_t qr_spread_lanes(const unsigned char lanes) {
+    uint64_t spread = (lanes * (uint64_t) 0x0101010101010101) & (uint64_t) 0x8040201008040201; /* Bit i in byte i */
+    return ((spread + (uint64_t) 0x00406070787C7E7F) >> 7) & (uint64_t) 0x0101010101010101; /* Moved to bit 0 */
+}
 
-    /* Suppresses clang-tidy clang-analyzer-core.UndefinedBinaryOperatorResult warnings */
-    assert(size > 0);
+/* Add the per-mask counts accumulated by `qr_spread_lanes()` to `penalty`, times `weight` */
+static void qr_add_lane_counts(int penalty[8], const uint64_t counts, const int weight) {
+    int pattern;
 
-#ifdef ZINTLOG
-    /* bitmask output */
-    for (y = 0; y < size; y++) {
-        for (x = 0; x < size; x++) {
-            append_log(local[(y * size) + x]);
-        }
-        write_log("");
+    for (pattern = 0; pattern < 8; pattern++) {
+        penalty[pattern] += (int) ((counts >> (pattern * 8)) & 0xFF) * weight;
     }
-#endif
+}
 
-    /* Test 1: Adjacent modules in row/column in same colour */
-    /* Vertical */
-    for (x = 0; x < size; x++) {
-        block = 0;
-        state = 0;
-        for (y = 0; y < size; y++) {
-            if (local[(y * size) + x] == state) {
-                block++;
-            } else {
-                if (block >= 5) {
-                    result += block - 2;
-                }
-                block = 1;
-                state = local[(y * size) + x];
-            }
-        }
-        if (block >= 5) {
-            result += block - 2;
-        }
-    }
+/* Tests 1 and 3 of `qr_evaluate()` along the rows of `lanes` (the columns if `transposed`) */
+static void qr_evaluate_lines(const unsigned char *lanes, const int size, const int transposed, int penalty[8]) {
+    const int step = transposed ? size : 1; /* Between modules of a line */
+    const int stride = transposed ? 1 : size; /* Between lines */
+    unsigned char *line = (unsigned char *) z_alloca(size + 8);
+    unsigned char *diff = (unsigned char *) z_alloca(size);
+    int x, y;
+
+    /* The line is padded with 4 light modules each side, out of range modules count as light */
+    memset(line, 0, size + 8);
 
-    /* Horizontal */
-    dark_mods = 0; /* Count dark mods simultaneously (see Test 4 below) */
     for (y = 0; y < size; y++) {
-        r = y * size;
-        block = 0;
-        state = 0;
+        const unsigned char *l = line + 4;
+        uint64_t runs = 0, run_starts = 0, finders = 0;
+
         for (x = 0; x < size; x++) {
-            if (local[r + x] == state) {
-                block++;
-            } else {
-                if (block >= 5) {
-                    result += block - 2;
-                }
-                block = 1;
-                state = local[r + x];
-            }
-            if (state) {
-                dark_mods++;
-            }
+            line[x + 4] = lanes[y * stride + x * step];
         }
-        if (block >= 5) {
-            result += block - 2;
+        for (x = 0; x < size - 1; x++) {
+            diff[x] = l[x] ^ l[x + 1];
         }
-    }
 
-#ifdef ZINTLOG
-    /* output Test 1 */
-    sprintf(str, "%d", result);
-    result_b = result;
-    write_log(str);
-#endif
+        /* Test 1: Adjacent modules in row/column in same colour */
+        /* A run of length N >= 5 has N - 4 uniform windows of 5 modules, and costs N - 2 = (N - 4) + 2 */
+        for (x = 0; x <= size - 5; x++) {
+            const unsigned char uniform = ~(diff[x] | diff[x + 1] | diff[x + 2] | diff[x + 3]);
+            runs += qr_spread_lanes(uniform);
+            run_starts += qr_spread_lanes(x == 0 ? uniform : uniform & diff[x - 1]);
+        }
 
-    /* Test 2: Block of modules in same color */
-    for (x = 0; x < size - 1; x++) {
-        for (y = 0; y < size - 1; y++) {
-            k = local[(y * size) + x];
-            if (k == local[((y + 1) * size) + x] && k == local[(y * size) + (x + 1)]
-                    && k == local[((y + 1) * size) + (x + 1)]) {
-                result += 3;
+        /* Test 3: 1:1:3:1:1 ratio pattern in row/column, preceded or followed by light area 4 modules wide */
+        /* (two such patterns never start less than 4 modules apart, so each one counts once) */
+        for (x = 0; x <= size - 7; x++) {
+            const unsigned char pattern = l[x] & ~l[x + 1] & l[x + 2] & l[x + 3] & l[x + 4] & ~l[x + 5] & l[x + 6];
+            if (pattern) {
+                const unsigned char light_before = ~(l[x - 4] | l[x - 3] | l[x - 2] | l[x - 1]);
+                const unsigned char light_after = ~(l[x + 7] | l[x + 8] | l[x + 9] | l[x + 10]);
+                finders += qr_spread_lanes(pattern & (light_before | light_after));
             }
         }
+
+        qr_add_lane_counts(penalty, runs, 1);
+        qr_add_lane_counts(penalty, run_starts, 2);
+        qr_add_lane_counts(penalty, finders, 40);
     }
+}
 
+/* Evaluate the penalties of all 8 mask patterns at once, with `lanes` holding the masked symbol of pattern `p`
+   in bit `p` of each module (see ISO/IEC 18004:2015 7.8.3) */
+static void qr_evaluate(const unsigned char *lanes, const int size, int penalty[8]) {
+    int x, y, pattern, k;
+    int dark_mods[8] = {0};
+    double percentage;
 #ifdef ZINTLOG
-    /* output Test 2 */
-    sprintf(str, "%d", result - result_b);
-    result_b = result;
-    write_log(str);
+    char str[15];
 #endif
 
-    /* Test 3: 1:1:3:1:1 ratio pattern in row/column */
-    /* Vertical */
-    for (x = 0; x < size; x++) {
-        for (y = 0; y <= (size - 7); y++) {
-            if (local[y * size + x] && !local[(y + 1) * size + x] && local[(y + 2) * size + x]
-                    && local[(y + 3) * size + x] && local[(y + 4) * size + x]
-                    && !local[(y + 5) * size + x] && local[(y + 6) * size + x]) {
-                /* Pattern found, check before and after */
-                beforeCount = 0;
-                for (b = y - 1; b >= y - 4; b--) {
-                    if (b < 0) { /* Count < edge as whitespace */
-                        beforeCount = 4;
-                        break;
-                    }
-                    if (local[(b * size) + x]) {
-                        break;
-                    }
-                    beforeCount++;
-                }
-                if (beforeCount == 4) {
-                    /* Pattern is preceded by light area 4 modules wide */
-                    result += 40;
-                } else {
-                    afterCount = 0;
-                    for (a = y + 7; a <= y + 10; a++) {
-                        if (a >= size) { /* Count > edge as whitespace */
-                            afterCount = 4;
-                            break;
-                        }
-                        if (local[(a * size) + x]) {
-                            break;
-                        }
-                        afterCount++;
-                    }
-                    if (afterCount == 4) {
-                        /* Pattern is followed by light area 4 modules wide */
-                        result += 40;
-                    }
-                }
-                y += 3; /* Skip to next possible match */
-            }
-        }
-    }
+    /* Suppresses clang-tidy clang-analyzer-core.UndefinedBinaryOperatorResult warnings */
+    assert(size > 0);
 
-    /* Horizontal */
-    for (y = 0; y < size; y++) {
-        r = y * size;
-        for (x = 0; x <= (size - 7); x++) {
-            if (memcmp(local + r + x, h1011101, 7) == 0) {
-                /* Pattern found, check before and after */
-                beforeCount = 0;
-                for (b = x - 1; b >= x - 4; b--) {
-                    if (b < 0) { /* Count < edge as whitespace */
-                        beforeCount = 4;
-                        break;
-                    }
-                    if (local[r + b]) {
-                        break;
-                    }
-                    beforeCount++;
-                }
+    memset(penalty, 0, sizeof(int) * 8);
 
-                if (beforeCount == 4) {
-                    /* Pattern is preceded by light area 4 modules wide */
-                    result += 40;
-                } else {
-                    afterCount = 0;
-                    for (a = x + 7; a <= x + 10; a++) {
-                        if (a >= size) { /* Count > edge as whitespace */
-                            afterCount = 4;
-                            break;
-                        }
-                        if (local[r + a]) {
-                            break;
-                        }
-                        afterCount++;
-                    }
-                    if (afterCount == 4) {
-                        /* Pattern is followed by light area 4 modules wide */
-                        result += 40;
-                    }
-                }
-                x += 3; /* Skip to next possible match */
-            }
+    /* Tests 1 and 3, horizontal then vertical */
+    qr_evaluate_lines(lanes, size, 0 /*transposed*/, penalty);
+    qr_evaluate_lines(lanes, size, 1 /*transposed*/, penalty);
+
+    /* Test 2: Block of modules in same color */
+    for (y = 0; y < size - 1; y++) {
+        const unsigned char *r0 = lanes + (y * size);
+        const unsigned char *r1 = r0 + size;
+        uint64_t blocks = 0;
+        for (x = 0; x < size - 1; x++) {
+            k = r0[x];
+            blocks += qr_spread_lanes(~((k ^ r0[x + 1]) | (k ^ r1[x]) | (k ^ r1[x + 1])));
         }
+        qr_add_lane_counts(penalty, blocks, 3);
     }
 
-#ifdef ZINTLOG
-    /* output Test 3 */
-    sprintf(str, "%d", result - result_b);
-    result_b = result;
-    write_log(str);
-#endif
-
     /* Test 4: Proportion of dark modules in entire symbol */
-    percentage = (100.0 * dark_mods) / (size * size);
-    k = (int) (fabs(percentage - 50.0) / 5.0);
+    for (y = 0; y < size; y++) {
+        uint64_t darks = 0;
+        for (x = 0; x < size; x++) {
+            darks += qr_spread_lanes(lanes[(y * size) + x]);
+        }
+        qr_add_lane_counts(dark_mods, darks, 1);
+    }
+    for (pattern = 0; pattern < 8; pattern++) {
+        percentage = (100.0 * dark_mods[pattern]) / (size * size);
+        k = (int) (fabs(percentage - 50.0) / 5.0);
 
-    result += 10 * k;
+        penalty[pattern] += 10 * k;
 
 #ifdef ZINTLOG
-    /* output Test 4+summary */
-    sprintf(str, "%d", result - result_b);
-    write_log(str);
-    write_log("==========");
-    sprintf(str, "%d", result);
-    write_log(str);
+        sprintf(str, "%d", penalty[pattern]);
+        write_log(str);
 #endif
-
-    return result;
+    }
 }
 
-/* Add format information to grid */
-static void qr_add_format_info(unsigned char *grid, const int size, const int ecc_level, const int pattern) {
+/* Format information for `pattern`, as the 15-bit sequence from Annex C */
+static unsigned int qr_format_seq(const int ecc_level, const int pattern) {
     int format = pattern;
-    unsigned int seq;
-    int i;
 
     switch (ecc_level) {
         case QR_LEVEL_L: format |= 0x08; break;
@@ -1282,27 +1176,37 @@ static void qr_add_format_info(unsigned char *grid, const int size, const int ec
         case QR_LEVEL_H: format |= 0x10; break;
     }
 
-    seq = qr_annex_c[format];
+    return qr_annex_c[format];
+}
+
+/* Place format information sequence `seq` in bit `lane` of the grid modules */
+static void qr_place_format_info(unsigned char *grid, const int size, const unsigned int seq, const int lane) {
+    int i;
 
     for (i = 0; i < 6; i++) {
-        grid[(i * size) + 8] |= (seq >> i) & 0x01;
+        grid[(i * size) + 8] |= ((seq >> i) & 0x01) << lane;
     }
 
     for (i = 0; i < 8; i++) {
-        grid[(8 * size) + (size - i - 1)] |= (seq >> i) & 0x01;
+        grid[(8 * size) + (size - i - 1)] |= ((seq >> i) & 0x01) << lane;
     }
 
     for (i = 0; i < 6; i++) {
-        grid[(8 * size) + (5 - i)] |= (seq >> (i + 9)) & 0x01;
+        grid[(8 * size) + (5 - i)] |= ((seq >> (i + 9)) & 0x01) << lane;
     }
 
     for (i = 0; i < 7; i++) {
-        grid[(((size - 7) + i) * size) + 8] |= (seq >> (i + 8)) & 0x01;
+        grid[(((size - 7) + i) * size) + 8] |= ((seq >> (i + 8)) & 0x01) << lane;
     }
 
-    grid[(7 * size) + 8] |= (seq >> 6) & 0x01;
-    grid[(8 * size) + 8] |= (seq >> 7) & 0x01;
-    grid[(8 * size) + 7] |= (seq >> 8) & 0x01;
+    grid[(7 * size) + 8] |= ((seq >> 6) & 0x01) << lane;
+    grid[(8 * size) + 8] |= ((seq >> 7) & 0x01) << lane;
+    grid[(8 * size) + 7] |= ((seq >> 8) & 0x01) << lane;
+}
+
+/* Add format information to grid */
+static void qr_add_format_info(unsigned char *grid, const int size, const int ecc_level, const int pattern) {
+    qr_place_format_info(grid, size, qr_format_seq(ecc_level, pattern), 0 /*lane*/);
 }
 
 static int qr_apply_bitmask(unsigned char *grid, const int size, const int ecc_level, const int user_mask,
@@ -1314,7 +1218,7 @@ static int qr_apply_bitmask(unsigned char *grid, const int size, const int ecc_l
     int best_pattern;
     int size_squared = size * size;
     unsigned char *mask = (unsigned char *) z_alloca(size_squared);
-    unsigned char *local = (unsigned char *) z_alloca(size_squared);
+    unsigned char *lanes;
 #ifdef ZINTLOG
     char str[15];
 #endif
@@ -1364,26 +1268,23 @@ static int qr_apply_bitmask(unsigned char *grid, const int size, const int ecc_l
     if (user_mask) {
         best_pattern = user_mask - 1;
     } else {
-        /* all eight bitmask variants have been encoded in the 8 bits of the bytes
-         * that make up the mask array. select them for evaluation according to the
-         * desired pattern.*/
-        best_pattern = 0;
+        /* all eight bitmask variants are evaluated in one pass, each of them in its own bit ("lane") of the
+         * modules: the dark modules are the ones of the mask array inverted. */
+        lanes = (unsigned char *) z_alloca(size_squared);
+        for (k = 0; k < size_squared; k++) {
+            lanes[k] = (grid[k] & 0x01) ? mask[k] ^ 0xFF : mask[k];
+        }
         for (pattern = 0; pattern < 8; pattern++) {
-            if (fast_encode && pattern != 0 && pattern != 2 && pattern != 4 && pattern != 7) {
-                continue;
-            }
-            bit = 1 << pattern;
-            for (k = 0; k < size_squared; k++) {
-                if (mask[k] & bit) {
-                    local[k] = grid[k] ^ 0x01;
-                } else {
-                    local[k] = grid[k] & 0x0F;
-                }
-            }
-            qr_add_format_info(local, size, ecc_level, pattern);
+            qr_place_format_info(lanes, size, qr_format_seq(ecc_level, pattern), pattern);
+        }
 
-            penalty[pattern] = qr_evaluate(local, size);
+        qr_evaluate(lanes, size, penalty);
 
+        best_pattern = 0;
+        for (pattern = 1; pattern < 8; pattern++) {
+            if (fast_encode && pattern != 2 && pattern != 4 && pattern != 7) {
+                continue;
+            }
             if (penalty[pattern] < penalty[best_pattern]) {
                 best_pattern = pattern;
             }
@@ -1409,14 +1310,10 @@ static int qr_apply_bitmask(unsigned char *grid, const int size, const int ecc_l
 #endif
 
     /* Apply mask */
-    if (!user_mask && best_pattern == 7) { /* Reuse last */
-        memcpy(grid, local, size_squared);
-    } else {
-        bit = 1 << best_pattern;
-        for (y = 0; y < size_squared; y++) {
-            if (mask[y] & bit) {
-                grid[y] ^= 0x01;
-            }
+    bit = 1 << best_pattern;
+    for (k = 0; k < size_squared; k++) {
+        if (mask[k] & bit) {
+            grid[k] ^= 0x01;
         }
     }
 
@@ -2031,34 +1928,27 @@ static void microqr_populate_grid(unsigned char *grid, const int size, const cha
     } while (i < bp);
 }
 
-static int microqr_evaluate(const unsigned char *grid, const int size, const int pattern) {
-    int sum1, sum2, i, filter = 0, retval;
-
-    switch (pattern) {
-        case 0: filter = 0x01; break;
-        case 1: filter = 0x02; break;
-        case 2: filter = 0x04; break;
-        case 3: filter = 0x08; break;
-    }
+/* Evaluate the 4 mask patterns at once, with `lanes` holding pattern `p` in bit `p` of each module */
+static void microqr_evaluate(const unsigned char *lanes, const int size, int value[4]) {
+    int sum1[4] = {0}, sum2[4] = {0};
+    int i, pattern;
 
-    sum1 = 0;
-    sum2 = 0;
     for (i = 1; i < size; i++) {
-        if (grid[(i * size) + size - 1] & filter) {
-            sum1++;
-        }
-        if (grid[((size - 1) * size) + i] & filter) {
-            sum2++;
+        const unsigned char right = lanes[(i * size) + size - 1];
+        const unsigned char bottom = lanes[((size - 1) * size) + i];
+        for (pattern = 0; pattern < 4; pattern++) {
+            sum1[pattern] += (right >> pattern) & 0x01;
+            sum2[pattern] += (bottom >> pattern) & 0x01;
         }
     }
 
-    if (sum1 <= sum2) {
-        retval = (sum1 * 16) + sum2;
-    } else {
-        retval = (sum2 * 16) + sum1;
+    for (pattern = 0; pattern < 4; pattern++) {
+        if (sum1[pattern] <= sum2[pattern]) {
+            value[pattern] = (sum1[pattern] * 16) + sum2[pattern];
+        } else {
+            value[pattern] = (sum2[pattern] * 16) + sum1[pattern];
+        }
     }
-
-    return retval;
 }
 
 static int microqr_apply_bitmask(unsigned char *grid, const int size, const int user_mask, const int debug_print) {
@@ -2108,11 +1998,10 @@ static int microqr_apply_bitmask(unsigned char *grid, const int size, const int
             }
         }
 
-
         /* Evaluate result */
+        microqr_evaluate(eval, size, value);
         best_pattern = 0;
-        for (pattern = 0; pattern < 4; pattern++) {
-            value[pattern] = microqr_evaluate(eval, size, pattern);
+        for (pattern = 1; pattern < 4; pattern++) {
             if (value[pattern] > value[best_pattern]) {
                 best_pattern = pattern;
             }
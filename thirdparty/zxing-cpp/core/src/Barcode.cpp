@@ -168,6 +168,7 @@ bool Barcode::operator==(const Barcode& o) const
 	return *d == *o.d;
 }
 
+// Note: BarcodeIndex::duplicateCandidates() relies on the geometric conditions below, keep them in sync.
 bool BarcodeData::operator==(const BarcodeData& o) const
 {
 	if (format != o.format)
@@ -218,11 +219,27 @@ Barcode MergeStructuredAppendSequence(const Barcodes& barcodes)
 	std::list<Barcode> allBarcodes(barcodes.begin(), barcodes.end());
 	allBarcodes.sort([](const Barcode& r1, const Barcode& r2) { return r1.sequenceIndex() < r2.sequenceIndex(); });
 
-	Barcode res = allBarcodes.front();
+	// the parts share their data with the barcodes of the caller, so the merged one is built from a copy of the first
+	const BarcodeData& first = *allBarcodes.front().d;
+	Content content;
+	content.bytes = first.content.bytes;
+	content.encodings = first.content.encodings;
+	content.symbology = first.content.symbology;
+	content.defaultCharset = first.content.defaultCharset;
+	content.hasECI = first.content.hasECI;
 	for (auto i = std::next(allBarcodes.begin()); i != allBarcodes.end(); ++i)
-		res.d->content.append(i->d->content);
-
-	res.d->position = {};
+		content.append(i->d->content);
+
+	Barcode res(BarcodeData{.content = std::move(content),
+							.error = first.error,
+							.format = first.format,
+							.extra = first.extra,
+							.sai = first.sai,
+							.readerOpts = first.readerOpts,
+							.symbol = first.symbol.copy(),
+							.lineCount = first.lineCount,
+							.isMirrored = first.isMirrored,
+							.isInverted = first.isInverted});
 	res.d->sai.index = -1;
 
 	if (allBarcodes.back().sequenceSize() != Size(allBarcodes) ||
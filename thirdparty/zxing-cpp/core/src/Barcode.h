@@ -58,6 +58,7 @@ class Barcode
 
 	friend Barcode MergeStructuredAppendSequence(const Barcodes&);
 	friend Barcodes ReadBarcodes(const ImageView&, const ReaderOptions&);
+	friend Barcodes ReadBarcodes(int, int, const TileLoader&, const ReaderOptions&, int, int);
 	friend Barcode CreateBarcode(const void*, int, int, const CreatorOptions&);
 	friend Image WriteBarcodeToImage(const Barcode&, const WriterOptions&);
 	friend std::string WriteBarcodeToSVG(const Barcode&, const WriterOptions&);
@@ -0,0 +1,72 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#include "BarcodeIndex.h"
+
+#include "BarcodeData.h"
+
+#include <algorithm>
+
+namespace ZXing {
+
+static std::pair<PointF, PointF> Bounds(const Position& position, double margin = 0)
+{
+	auto bb = BoundingBox(position);
+	return {PointF(bb.topLeft()) - PointF(margin, margin), PointF(bb.bottomRight()) + PointF(margin, margin)};
+}
+
+std::vector<int> BarcodeIndex::collect(PointF min, PointF max) const
+{
+	std::vector<int> res;
+	_grid.any(min, max, [&res](int id) {
+		res.push_back(id);
+		return false;
+	});
+	std::sort(res.begin(), res.end());
+	res.erase(std::unique(res.begin(), res.end()), res.end());
+	return res;
+}
+
+void BarcodeIndex::insert(int id, const Position& position)
+{
+	auto [min, max] = Bounds(position);
+	_grid.insert(id, min, max);
+}
+
+void BarcodeIndex::remove(int id, const Position& position)
+{
+	auto [min, max] = Bounds(position);
+	_grid.remove(id, min, max);
+}
+
+void BarcodeIndex::update(int id, const Position& oldPosition, const Position& newPosition)
+{
+	if (oldPosition == newPosition)
+		return;
+	remove(id, oldPosition);
+	insert(id, newPosition);
+}
+
+std::vector<int> BarcodeIndex::duplicateCandidates(const BarcodeData& data) const
+{
+	// Matrix codes are equal if the center of one is inside the other, which both imply intersecting bounding boxes.
+	// Linear codes are also equal if the top left corner of the single line one is less than half its length away from
+	// the multi line one, with lengths that differ by less than 20%. So the search area is grown by 5/8 of the length.
+	double margin = 0;
+	if (data.format & BarcodeFormat::AllLinear) {
+		auto bb = BoundingBox(data.position);
+		margin = std::max(bb.bottomRight().x - bb.topLeft().x, bb.bottomRight().y - bb.topLeft().y) * 5. / 8 + 1;
+	}
+	auto [min, max] = Bounds(data.position, margin);
+	return collect(min, max);
+}
+
+std::vector<int> BarcodeIndex::overlapCandidates(const Position& position) const
+{
+	auto [min, max] = Bounds(position);
+	return collect(min, max);
+}
+
+} // ZXing
@@ -0,0 +1,44 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "Barcode.h"
+#include "SpatialGrid.h"
+
+#include <vector>
+
+namespace ZXing {
+
+struct BarcodeData;
+
+/**
+ * @brief Spatial index over the positions of a list of symbols.
+ *
+ * The symbols are referred to by their index in a list owned by the caller. Lookups only return candidates, i.e. the
+ * caller still has to run the exact test (operator== or HaveIntersectingBoundingBoxes) on them. Since the candidates
+ * are returned in ascending order, the first match is the same one a linear search through the list would find.
+ */
+class BarcodeIndex
+{
+	SpatialGrid _grid;
+
+	std::vector<int> collect(PointF min, PointF max) const;
+
+public:
+	explicit BarcodeIndex(double cellSize = 128) : _grid(cellSize) {}
+
+	void insert(int id, const Position& position);
+	void remove(int id, const Position& position);
+	void update(int id, const Position& oldPosition, const Position& newPosition);
+
+	/// Symbols that may compare equal to the given one, see BarcodeData::operator==()
+	std::vector<int> duplicateCandidates(const BarcodeData& data) const;
+
+	/// Symbols whose bounding box may intersect the one of the given position
+	std::vector<int> overlapCandidates(const Position& position) const;
+};
+
+} // ZXing
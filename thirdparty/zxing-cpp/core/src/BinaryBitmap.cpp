@@ -7,14 +7,25 @@
 
 #include "BitMatrix.h"
 
+#include <algorithm>
 #include <mutex>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ZX_TRANSPOSE_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define ZX_TRANSPOSE_NEON
+#endif
+
 namespace ZXing {
 
 struct BinaryBitmap::Cache
 {
 	std::once_flag once;
 	std::shared_ptr<const BitMatrix> matrix;
+	std::once_flag transposedOnce;
+	Image transposed;
 };
 
 BitMatrix BinaryBitmap::binarize(const uint8_t threshold) const
@@ -47,6 +58,105 @@ BitMatrix BinaryBitmap::binarize(const uint8_t threshold) const
 	return res;
 }
 
+// Transposes an 8x8 tile. The source rows are given bottom-up, so the result is the tile rotated by 90 degrees.
+static inline void Transpose8x8(const uint8_t* const src[8], uint8_t* dst, int dstStride)
+{
+#if defined(ZX_TRANSPOSE_SSE2)
+	auto load = [](const uint8_t* p) { return _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)); };
+	auto store = [](uint8_t* p, __m128i v) { _mm_storel_epi64(reinterpret_cast<__m128i*>(p), v); };
+
+	__m128i a0 = _mm_unpacklo_epi8(load(src[0]), load(src[1]));
+	__m128i a1 = _mm_unpacklo_epi8(load(src[2]), load(src[3]));
+	__m128i a2 = _mm_unpacklo_epi8(load(src[4]), load(src[5]));
+	__m128i a3 = _mm_unpacklo_epi8(load(src[6]), load(src[7]));
+
+	__m128i b0 = _mm_unpacklo_epi16(a0, a1);
+	__m128i b1 = _mm_unpackhi_epi16(a0, a1);
+	__m128i b2 = _mm_unpacklo_epi16(a2, a3);
+	__m128i b3 = _mm_unpackhi_epi16(a2, a3);
+
+	__m128i c[4] = {_mm_unpacklo_epi32(b0, b2), _mm_unpackhi_epi32(b0, b2), _mm_unpacklo_epi32(b1, b3),
+					_mm_unpackhi_epi32(b1, b3)};
+
+	for (int i = 0; i < 4; ++i) {
+		store(dst + (2 * i) * dstStride, c[i]);
+		store(dst + (2 * i + 1) * dstStride, _mm_unpackhi_epi64(c[i], c[i]));
+	}
+#elif defined(ZX_TRANSPOSE_NEON)
+	uint8x8x2_t t01 = vtrn_u8(vld1_u8(src[0]), vld1_u8(src[1]));
+	uint8x8x2_t t23 = vtrn_u8(vld1_u8(src[2]), vld1_u8(src[3]));
+	uint8x8x2_t t45 = vtrn_u8(vld1_u8(src[4]), vld1_u8(src[5]));
+	uint8x8x2_t t67 = vtrn_u8(vld1_u8(src[6]), vld1_u8(src[7]));
+
+	uint16x4x2_t u02 = vtrn_u16(vreinterpret_u16_u8(t01.val[0]), vreinterpret_u16_u8(t23.val[0]));
+	uint16x4x2_t u13 = vtrn_u16(vreinterpret_u16_u8(t01.val[1]), vreinterpret_u16_u8(t23.val[1]));
+	uint16x4x2_t u46 = vtrn_u16(vreinterpret_u16_u8(t45.val[0]), vreinterpret_u16_u8(t67.val[0]));
+	uint16x4x2_t u57 = vtrn_u16(vreinterpret_u16_u8(t45.val[1]), vreinterpret_u16_u8(t67.val[1]));
+
+	uint32x2x2_t v04 = vtrn_u32(vreinterpret_u32_u16(u02.val[0]), vreinterpret_u32_u16(u46.val[0]));
+	uint32x2x2_t v15 = vtrn_u32(vreinterpret_u32_u16(u13.val[0]), vreinterpret_u32_u16(u57.val[0]));
+	uint32x2x2_t v26 = vtrn_u32(vreinterpret_u32_u16(u02.val[1]), vreinterpret_u32_u16(u46.val[1]));
+	uint32x2x2_t v37 = vtrn_u32(vreinterpret_u32_u16(u13.val[1]), vreinterpret_u32_u16(u57.val[1]));
+
+	vst1_u8(dst + 0 * dstStride, vreinterpret_u8_u32(v04.val[0]));
+	vst1_u8(dst + 1 * dstStride, vreinterpret_u8_u32(v15.val[0]));
+	vst1_u8(dst + 2 * dstStride, vreinterpret_u8_u32(v26.val[0]));
+	vst1_u8(dst + 3 * dstStride, vreinterpret_u8_u32(v37.val[0]));
+	vst1_u8(dst + 4 * dstStride, vreinterpret_u8_u32(v04.val[1]));
+	vst1_u8(dst + 5 * dstStride, vreinterpret_u8_u32(v15.val[1]));
+	vst1_u8(dst + 6 * dstStride, vreinterpret_u8_u32(v26.val[1]));
+	vst1_u8(dst + 7 * dstStride, vreinterpret_u8_u32(v37.val[1]));
+#else
+	for (int x = 0; x < 8; ++x)
+		for (int y = 0; y < 8; ++y)
+			dst[x * dstStride + y] = src[y][x];
+#endif
+}
+
+// Builds the 90 degree rotation of a single channel image (see ImageView::rotated()) as a packed buffer:
+// dst(x, y) = src(y, height - 1 - x). The work is blocked in 64x64 pixel tiles to stay within the L1 cache.
+static Image RotateLum90(const ImageView& src)
+{
+	constexpr int TILE = 8;
+	constexpr int BLOCK = 64;
+
+	const int W = src.width(), H = src.height();
+	Image res(H, W);
+	auto* dst = const_cast<uint8_t*>(res.data());
+	auto pixel = [&src](int x, int y) { return *src.data(x, y); };
+
+	for (int by = 0; by < H; by += BLOCK)
+		for (int bx = 0; bx < W; bx += BLOCK)
+			for (int y = by; y < std::min(by + BLOCK, H); y += TILE)
+				for (int x = bx; x < std::min(bx + BLOCK, W); x += TILE) {
+					if (src.pixStride() == 1 && y + TILE <= H && x + TILE <= W) {
+						const uint8_t* rows[TILE];
+						for (int i = 0; i < TILE; ++i)
+							rows[i] = src.data(x, y + TILE - 1 - i);
+						Transpose8x8(rows, dst + x * H + (H - y - TILE), H);
+					} else {
+						for (int ty = y; ty < std::min(y + TILE, H); ++ty)
+							for (int tx = x; tx < std::min(x + TILE, W); ++tx)
+								dst[tx * H + (H - 1 - ty)] = pixel(tx, ty);
+					}
+				}
+
+	return res;
+}
+
+ImageView BinaryBitmap::rotatedBuffer(int rotation) const
+{
+	rotation = (rotation + 360) % 360;
+	if (rotation != 90 && rotation != 270)
+		return _buffer.rotated(rotation);
+
+	std::call_once(_cache->transposedOnce, [&]() { _cache->transposed = RotateLum90(_buffer); });
+
+	// the 270 degree rotation is the 90 degree one, upside down
+	const ImageView& transposed = _cache->transposed;
+	return rotation == 90 ? transposed : transposed.rotated(180);
+}
+
 BinaryBitmap::BinaryBitmap(const ImageView& buffer) : _cache(new Cache), _buffer(buffer) {}
 
 BinaryBitmap::~BinaryBitmap() = default;
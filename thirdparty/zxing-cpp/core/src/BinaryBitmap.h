@@ -42,6 +42,14 @@ protected:
 
 	BitMatrix binarize(uint8_t threshold) const;
 
+	/**
+	* Returns the luminance buffer rotated by `rotation` degrees, with rows stored contiguously in memory.
+	*
+	* The 90 and 270 degree views are backed by a transposed copy of the buffer that is built once (and thread-safe)
+	* per BinaryBitmap, so column scans don't pay a cache miss per pixel.
+	*/
+	ImageView rotatedBuffer(int rotation) const;
+
 public:
 	BinaryBitmap(const ImageView& buffer);
 	virtual ~BinaryBitmap();
@@ -105,25 +105,14 @@ static int EstimateBlackPoint(const Histogram& buckets)
 
 bool GlobalHistogramBinarizer::getPatternRow(int row, int rotation, PatternRow& res) const
 {
-	auto buffer = _buffer.rotated(rotation);
+	// Columns are read from a transposed copy of the buffer (built once per image), otherwise we would run into
+	// cache misses on every pixel access both during the histogram calculation and the sharpen+threshold operation.
+	auto buffer = rotatedBuffer(rotation);
 	auto lineView = RowView(buffer, row);
 
 	if (buffer.width() < 3)
 		return false; // special casing the code below for a width < 3 makes no sense
 
-#if defined(__AVX__) // or defined(__ARM_NEON)
-	// If we are extracting a column (instead of a row), we run into cache misses on every pixel access both
-	// during the histogram calculation and during the sharpen+threshold operation. Additionally, if we
-	// perform the ThresholdSharpened function on pixStride==1 data, the auto-vectorizer makes that part
-	// 8x faster on an AVX2 cpu which easily recovers the extra cost that we pay for the copying.
-	ZX_THREAD_LOCAL std::vector<uint8_t> line;
-	if (std::abs(buffer.pixStride()) > 4) {
-		line.resize(lineView.size());
-		std::copy(lineView.begin(), lineView.end(), line.begin());
-		lineView = {{line.data(), 1}, {line.data() + line.size(), 1}};
-	}
-#endif
-
 	auto threshold = EstimateBlackPoint(GenHistogram(lineView)) - 1;
 	if (threshold <= 0)
 		return false;
@@ -7,6 +7,9 @@
 
 #include "GridSampler.h"
 
+#include <algorithm>
+#include <vector>
+
 #ifdef PRINT_DEBUG
 #include "LogMatrix.h"
 #include "BitMatrixIO.h"
@@ -33,40 +36,45 @@ DetectorResult SampleGrid(const BitMatrix& image, int width, int height, const R
 	if (width <= 0 || height <= 0)
 		return {};
 
+	int maxRoiWidth = 0;
 	for (auto&& [x0, x1, y0, y1, mod2Pix] : rois) {
-		// Precheck the corners of every roi to bail out early if the grid is "obviously" not completely inside the image
+		// Check the corners of every roi to bail out early if the grid is not completely inside the image.
+		// Due to a "numerical instability" in the PerspectiveTransform generation/application it has been observed
+		// that even though all boundary grid points get projected inside the image, an inner grid point can still be
+		// outside, see #563. That happens when the roi crosses the line at infinity of mod2Pix, which is not a true
+		// perspective transformation of the grid then. Otherwise the inner grid points are inside the quadrilateral
+		// of the projected corners, hence inside the image, and need no further check.
 		auto isInside = [&mod2Pix = mod2Pix, &image](int x, int y) { return image.isIn(mod2Pix(centered(PointI(x, y)))); };
-		if (!mod2Pix.isValid() || !isInside(x0, y0) || !isInside(x1 - 1, y0) || !isInside(x1 - 1, y1 - 1) || !isInside(x0, y1 - 1))
+		if (!mod2Pix.isPerspectiveIn(centered(PointI(x0, y0)), centered(PointI(x1 - 1, y1 - 1))) || !isInside(x0, y0)
+			|| !isInside(x1 - 1, y0) || !isInside(x1 - 1, y1 - 1) || !isInside(x0, y1 - 1))
 			return {};
+		maxRoiWidth = std::max(maxRoiWidth, x1 - x0);
 	}
 
 	BitMatrix res(width, height);
+	std::vector<PointF> row(maxRoiWidth);
 	for (auto&& [x0, x1, y0, y1, mod2Pix] : rois) {
-		for (int y = y0; y < y1; ++y)
+		for (int y = y0; y < y1; ++y) {
+			mod2Pix(centered(PointI{x0, y}), x1 - x0, row.data());
 			for (int x = x0; x < x1; ++x) {
-				auto p = mod2Pix(centered(PointI{x, y}));
-				// Due to a "numerical instability" in the PerspectiveTransform generation/application it has been observed
-				// that even though all boundary grid points get projected inside the image, it can still happen that an
-				// inner grid points is not. See #563. A true perspective transformation cannot have this property.
-				// The following check takes 100% care of the issue and turned out to be less of a performance impact than feared.
-				// TODO: Check some mathematical/numercial property of mod2Pix to determine if it is a perspective transformation.
-				if (!image.isIn(p))
-					return {};
+				// the clamping only catches the rounding errors of points lying on the image border
+				auto p = PointI(std::clamp(int(row[x - x0].x), 0, image.width() - 1), std::clamp(int(row[x - x0].y), 0, image.height() - 1));
 
 #ifdef PRINT_DEBUG
-				log(p, 3);
+				log(row[x - x0], 3);
 #endif
 #if 0
 				int sum = 0;
 				for (int dy = -1; dy <= 1; ++dy)
 					for (int dx = -1; dx <= 1; ++dx)
-						sum += image.get(p + PointF(dx, dy));
+						sum += image.get(p + PointI(dx, dy));
 				if (sum >= 5)
 #else
 				if (image.get(p))
 #endif
 					res.set(x, y);
 			}
+		}
 	}
 
 #ifdef PRINT_DEBUG
@@ -7,7 +7,9 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <cstddef>
 #include <cstdio>
+#include <functional>
 #include <memory>
 #include <stdexcept>
 
@@ -106,7 +108,7 @@ public:
 	ImageFormat format() const { return _format; }
 
 	const uint8_t* data() const { return _data; }
-	const uint8_t* data(int x, int y) const { return _data + y * _rowStride + x * _pixStride; }
+	const uint8_t* data(int x, int y) const { return _data + std::ptrdiff_t(y) * _rowStride + std::ptrdiff_t(x) * _pixStride; }
 
 	ImageView cropped(int left, int top, int width, int height) const
 	{
@@ -144,5 +146,11 @@ public:
 	Image(int w, int h, ImageFormat f = ImageFormat::Lum) : Image(std::make_unique<uint8_t[]>(w * h * PixStride(f)), w, h, f) {}
 };
 
+/// Receives a view of one tile of an image, the view only needs to stay valid during the call
+using TileDecoder = std::function<void(const ImageView& tile)>;
+
+/// Provides the tile (left, top, width, height) of an image by calling decode with a view of it
+using TileLoader = std::function<void(int left, int top, int width, int height, const TileDecoder& decode)>;
+
 } // ZXing
 
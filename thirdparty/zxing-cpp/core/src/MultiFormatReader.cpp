@@ -35,41 +35,44 @@
 
 namespace ZXing {
 
-MultiFormatReader::MultiFormatReader(const ReaderOptions& opts) : _opts(opts)
+MultiFormatReader::MultiFormatReader(const ReaderOptions& opts) : _opts(opts), _validOpts(ReaderOptions(opts).returnErrors(false))
 {
 	using enum BarcodeFormat;
 
+	// the formats sharing a reader share its returnErrors setting, read() filters the others out
+	auto optsFor = [&](BarcodeFormat format) -> const ReaderOptions& { return opts.hasErrorFormat(format) ? opts : _validOpts; };
+
 	// Put linear readers upfront in "normal" mode
 #if ZXING_ENABLE_1D
 	if (!opts.tryHarder() && opts.hasAnyFormat(AllLinear))
-		_readers.emplace_back(new OneD::Reader(opts));
+		_readers.emplace_back(new OneD::Reader(optsFor(AllLinear)));
 #endif
 
 #if ZXING_ENABLE_QRCODE
 	if (opts.hasAnyFormat(QRCode))
-		_readers.emplace_back(new QRCode::Reader(opts, true));
+		_readers.emplace_back(new QRCode::Reader(optsFor(QRCode), true));
 #endif
 #if ZXING_ENABLE_DATAMATRIX
 	if (opts.hasAnyFormat(DataMatrix))
-		_readers.emplace_back(new DataMatrix::Reader(opts, true));
+		_readers.emplace_back(new DataMatrix::Reader(optsFor(DataMatrix), true));
 #endif
 #if ZXING_ENABLE_AZTEC
 	if (opts.hasAnyFormat(Aztec))
-		_readers.emplace_back(new Aztec::Reader(opts, true));
+		_readers.emplace_back(new Aztec::Reader(optsFor(Aztec), true));
 #endif
 #if ZXING_ENABLE_PDF417
 	if (opts.hasAnyFormat(PDF417))
-		_readers.emplace_back(new Pdf417::Reader(opts));
+		_readers.emplace_back(new Pdf417::Reader(optsFor(PDF417)));
 #endif
 #if ZXING_ENABLE_MAXICODE
 	if (opts.hasAnyFormat(MaxiCode))
-		_readers.emplace_back(new MaxiCode::Reader(opts));
+		_readers.emplace_back(new MaxiCode::Reader(optsFor(MaxiCode)));
 #endif
 
 	// At end in "try harder" mode
 #if ZXING_ENABLE_1D
 	if (opts.tryHarder() && opts.hasAnyFormat(AllLinear))
-		_readers.emplace_back(new OneD::Reader(opts));
+		_readers.emplace_back(new OneD::Reader(optsFor(AllLinear)));
 #endif
 }
 
@@ -83,8 +86,7 @@ Barcodes MultiFormatReader::read(const BinaryBitmap& image, int maxSymbols) cons
 		if (image.inverted() && !reader->supportsInversion)
 			continue;
 		auto r = reader->read(image, maxSymbols);
-		if (!_opts.returnErrors())
-			std::erase_if(r, [](auto&& s) { return !s.isValid(); });
+		std::erase_if(r, [this](auto&& s) { return !s.isValid() && !_opts.hasErrorFormat(s.format); });
 		maxSymbols -= Size(r);
 		res.insert(res.end(), std::move_iterator(r.begin()), std::move_iterator(r.end()));
 		if (maxSymbols <= 0)
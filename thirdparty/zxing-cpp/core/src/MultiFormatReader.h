@@ -7,6 +7,7 @@
 #pragma once
 
 #include "Barcode.h"
+#include "ReaderOptions.h"
 
 #include <vector>
 #include <memory>
@@ -15,7 +16,6 @@ namespace ZXing {
 
 class Reader;
 class BinaryBitmap;
-class ReaderOptions;
 
 class MultiFormatReader
 {
@@ -29,6 +29,7 @@ public:
 private:
 	std::vector<std::unique_ptr<Reader>> _readers;
 	const ReaderOptions& _opts;
+	ReaderOptions _validOpts; // for the readers of the formats not in _opts.errorFormats()
 };
 
 } // ZXing
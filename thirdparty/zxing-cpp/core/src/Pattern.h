@@ -14,9 +14,19 @@
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
+#include <iterator>
 #include <limits>
+#include <memory>
 #include <vector>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ZX_PATTERN_ROW_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define ZX_PATTERN_ROW_NEON
+#endif
+
 namespace ZXing {
 
 using PatternType = uint16_t;
@@ -369,44 +379,73 @@ void GetPatternRow(Range<I> b_row, PatternRow& p_row)
 	p_row.resize(b_row.size() + 2);
 	std::fill(p_row.begin(), p_row.end(), 0);
 
-	auto bitPos = b_row.begin();
-	const auto bitPosEnd = b_row.end();
 	auto intPos = p_row.data();
 
-	if (*bitPos)
+	if (*b_row.begin())
 		intPos++; // first value is number of white pixels, here 0
 
-	// The following code as been observed to cause a speedup of up to 30% on large images on an AVX cpu
-	// and on an a Google Pixel 3 Android phone. Your mileage may vary.
-	if constexpr (std::is_pointer_v<I> && sizeof(I) == 8 && sizeof(std::remove_pointer_t<I>) == 1) {
-		using simd_t = uint64_t;
-		while (bitPos < bitPosEnd - sizeof(simd_t)) {
-			auto asSimd0 = LoadU<simd_t>(bitPos);
-			auto asSimd1 = LoadU<simd_t>(bitPos + 1);
-			auto z = asSimd0 ^ asSimd1;
-			if (z) {
-#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
-				int step = std::countr_zero(z) / 8 + 1;
-#else
-				int step = std::countl_zero(z) / 8 + 1;
-#endif
-				(*intPos++) += step;
-				bitPos += step;
-			} else {
-				(*intPos) += sizeof(simd_t);
-				bitPos += sizeof(simd_t);
+	if constexpr (std::contiguous_iterator<I> && sizeof(std::iter_value_t<I>) == 1) {
+		// Byte rows (the binarizer output and the BitMatrix rows) are scanned for transitions 16 bytes at a time. Each
+		// transition directly emits the width of the run it terminates.
+		auto data = reinterpret_cast<const uint8_t*>(std::to_address(b_row.begin()));
+		const int size = narrow_cast<int>(b_row.size());
+		int runStart = 0;
+		int i = 0;
+
+		auto emitRuns = [&](uint64_t mask, int offset, int bitsPerByte) {
+			while (mask) {
+				int pos = offset + std::countr_zero(mask) / bitsPerByte + 1;
+				*intPos++ = narrow_cast<PatternType>(pos - std::exchange(runStart, pos));
+				mask &= mask - 1;
 			}
+		};
+
+#if defined(ZX_PATTERN_ROW_SSE2)
+		const __m128i zero = _mm_setzero_si128();
+		for (; i + 16 < size; i += 16) {
+			__m128i a = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)), zero);
+			__m128i b = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 1)), zero);
+			emitRuns(static_cast<uint32_t>(_mm_movemask_epi8(_mm_xor_si128(a, b))), i, 1);
 		}
-	}
+#elif defined(ZX_PATTERN_ROW_NEON)
+		for (; i + 16 < size; i += 16) {
+			uint8x16_t a = vceqzq_u8(vld1q_u8(data + i));
+			uint8x16_t b = vceqzq_u8(vld1q_u8(data + i + 1));
+			// there is no movemask on NEON, the narrowing shift leaves 4 bits per byte
+			uint8x8_t m = vshrn_n_u16(vreinterpretq_u16_u8(veorq_u8(a, b)), 4);
+			emitRuns(vget_lane_u64(vreinterpret_u64_u8(m), 0) & 0x8888888888888888ull, i, 4);
+		}
+#elif __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+		using simd_t = uint64_t;
+		for (; i + int(sizeof(simd_t)) < size; i += sizeof(simd_t)) {
+			auto z = LoadU<simd_t>(data + i) ^ LoadU<simd_t>(data + i + 1);
+			// set the top bit of every non-zero byte, i.e. of every transition
+			z = (((z & 0x7f7f7f7f7f7f7f7full) + 0x7f7f7f7f7f7f7f7full) | z) & 0x8080808080808080ull;
+			emitRuns(z, i, 8);
+		}
+#endif
+
+		for (; i + 1 < size; ++i)
+			if (bool(data[i]) != bool(data[i + 1]))
+				emitRuns(1, i, 1);
+
+		*intPos = narrow_cast<PatternType>(size - runStart);
 
-	while (++bitPos != bitPosEnd) {
+		if (data[size - 1])
+			intPos++;
+	} else {
+		auto bitPos = b_row.begin();
+		const auto bitPosEnd = b_row.end();
+
+		while (++bitPos != bitPosEnd) {
+			++(*intPos);
+			intPos += bitPos[0] != bitPos[-1];
+		}
 		++(*intPos);
-		intPos += bitPos[0] != bitPos[-1];
-	}
-	++(*intPos);
 
-	if (bitPos[-1])
-		intPos++;
+		if (bitPos[-1])
+			intPos++;
+	}
 
 	p_row.resize(intPos - p_row.data() + 1);
 #endif
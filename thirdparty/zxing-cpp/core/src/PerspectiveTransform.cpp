@@ -78,4 +78,25 @@ PointF PerspectiveTransform::operator()(PointF p) const
 	return {(a11 * p.x + a21 * p.y + a31) / denominator, (a12 * p.x + a22 * p.y + a32) / denominator};
 }
 
+void PerspectiveTransform::operator()(PointF p, int count, PointF* res) const
+{
+	// the terms not depending on x are the same for the whole row, what is left is independent for each point (vectorizable)
+	auto x0 = a21 * p.y + a31;
+	auto y0 = a22 * p.y + a32;
+	auto d0 = a23 * p.y + a33;
+	for (int i = 0; i < count; ++i) {
+		auto x = p.x + i;
+		auto invDenominator = 1 / (a13 * x + d0);
+		res[i] = {(a11 * x + x0) * invDenominator, (a12 * x + y0) * invDenominator};
+	}
+}
+
+bool PerspectiveTransform::isPerspectiveIn(PointF p0, PointF p1) const
+{
+	// the denominator is linear in p, so it keeps its sign over the rectangle if it has the same sign in its corners
+	auto denominator = [this](value_t x, value_t y) { return a13 * x + a23 * y + a33; };
+	auto d00 = denominator(p0.x, p0.y), d10 = denominator(p1.x, p0.y), d11 = denominator(p1.x, p1.y), d01 = denominator(p0.x, p1.y);
+	return isValid() && ((d00 > 0 && d10 > 0 && d11 > 0 && d01 > 0) || (d00 < 0 && d10 < 0 && d11 < 0 && d01 < 0));
+}
+
 } // ZXing
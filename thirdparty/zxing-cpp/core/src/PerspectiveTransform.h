@@ -41,7 +41,16 @@ public:
 	/// Project from the destination space (grid of modules) into the image space (bit matrix)
 	PointF operator()(PointF p) const;
 
+	/// Project the count points p, p + (1, 0), p + (2, 0)... of a grid row into res
+	void operator()(PointF p, int count, PointF* res) const;
+
 	bool isValid() const { return !std::isnan(a33); }
+
+	/**
+	 * Check that the rectangle spanned by p0 and p1 does not reach the line at infinity of the transformation,
+	 * i.e. that it gets mapped onto the convex quadrilateral of its projected corners, including every inner point.
+	 */
+	bool isPerspectiveIn(PointF p0, PointF p1) const;
 };
 
 } // ZXing
@@ -14,6 +14,7 @@
 #endif
 
 #ifdef ZXING_READERS
+#include "BarcodeIndex.h"
 #include "GlobalHistogramBinarizer.h"
 #include "HybridBinarizer.h"
 #include "MultiFormatReader.h"
@@ -21,9 +22,14 @@
 #include "ThresholdBinarizer.h"
 #endif
 
+#include <algorithm>
+#include <atomic>
 #include <climits>
+#include <exception>
 #include <memory>
+#include <mutex>
 #include <stdexcept>
+#include <thread>
 
 namespace ZXing {
 
@@ -53,6 +59,7 @@ struct ReaderOptions::Data
 	uint8_t maxNumberOfSymbols    = 0xff;
 	uint16_t downscaleThreshold   = 500;
 	BarcodeFormats formats        = {};
+	BarcodeFormats errorFormats   = {};
 };
 
 ReaderOptions::ReaderOptions() : d(std::make_unique<Data>()) {}
@@ -75,6 +82,10 @@ const BarcodeFormats& ReaderOptions::formats() const noexcept { return d->format
 ReaderOptions& ReaderOptions::formats(BarcodeFormats&& v) & { return (void)(d->formats = std::move(v)), *this; }
 ReaderOptions&& ReaderOptions::formats(BarcodeFormats&& v) && { return (void)(d->formats = std::move(v)), std::move(*this); }
 
+const BarcodeFormats& ReaderOptions::errorFormats() const noexcept { return d->errorFormats; }
+ReaderOptions& ReaderOptions::errorFormats(BarcodeFormats&& v) & { return (void)(d->errorFormats = std::move(v)), *this; }
+ReaderOptions&& ReaderOptions::errorFormats(BarcodeFormats&& v) && { return (void)(d->errorFormats = std::move(v)), std::move(*this); }
+
 #define ZX_PROPERTY(TYPE, NAME, SETTER) \
 	TYPE ReaderOptions::NAME() const noexcept { return d->NAME; } \
 	ReaderOptions& ReaderOptions::NAME(TYPE v) & { return (void)(d->NAME = std::move(v)), *this; } \
@@ -122,6 +133,11 @@ bool ReaderOptions::hasAnyFormat(const BarcodeFormats& formats) const noexcept
 	return d->formats.empty() || std::any_of(formats.begin(), formats.end(), [this](BarcodeFormat bt) { return bt & d->formats; });
 }
 
+bool ReaderOptions::hasErrorFormat(BarcodeFormat format) const noexcept
+{
+	return d->returnErrors && (d->errorFormats.empty() || format & d->errorFormats);
+}
+
 // ==============================================================================
 // ReadBarcode implementation
 // ==============================================================================
@@ -247,14 +263,30 @@ Barcode ReadBarcode(const ImageView& _iv, const ReaderOptions& opts)
 	return FirstOrDefault(ReadBarcodes(_iv, ReaderOptions(opts).maxNumberOfSymbols(1)));
 }
 
-Barcodes ReadBarcodes(const ImageView& _iv, const ReaderOptions& opts)
+// if symbols overlap and one is in error remove it
+static void RemoveOverlappingErrors(Barcodes& res, const BarcodeIndex& index)
 {
-	if (sizeof(PatternType) < 4 && (_iv.width() > 0xffff || _iv.height() > 0xffff))
-		throw std::invalid_argument("Maximum image width/height is 65535");
+	for (int a = 0; a < Size(res); ++a)
+		for (int b : index.overlapCandidates(res[a].position()))
+			if (b > a && res[a].format() != BarcodeFormat::None && res[b].format() != BarcodeFormat::None
+				&& HaveIntersectingBoundingBoxes(res[a].position(), res[b].position()) && (res[a].error() != res[b].error()))
+				(res[a].error() ? res[a] : res[b]) = BarcodeData();
+
+	std::erase_if(res, [](auto&& r) { return r.format() == BarcodeFormat::None; });
+}
 
-	if (!_iv.data() || _iv.width() * _iv.height() == 0)
+Barcodes ReadBarcodes(const ImageView& _iv, const ReaderOptions& opts)
+{
+	if (!_iv.data() || _iv.width() == 0 || _iv.height() == 0)
 		throw std::invalid_argument("ImageView is null/empty");
 
+	// the pattern rows can not represent longer lines, so split the image in tiles
+	if (sizeof(PatternType) < 4 && (_iv.width() > 0xffff || _iv.height() > 0xffff))
+		return ReadBarcodes(
+			_iv.width(), _iv.height(),
+			[&_iv](int left, int top, int width, int height, const TileDecoder& decode) { decode(_iv.cropped(left, top, width, height)); },
+			opts);
+
 	LumImage lum;
 	ImageView iv = SetupLumImageView(_iv, lum, opts);
 	MultiFormatReader reader(opts);
@@ -275,6 +307,7 @@ Barcodes ReadBarcodes(const ImageView& _iv, const ReaderOptions& opts)
 	LumImagePyramid pyramid(iv, opts.downscaleThreshold() * opts.tryDownscale(), opts.downscaleFactor());
 
 	Barcodes res;
+	BarcodeIndex index; // positions of res, shared by all pyramid layers
 	int maxSymbols = opts.maxNumberOfSymbols() ? opts.maxNumberOfSymbols() : INT_MAX;
 	for (auto&& iv : pyramid.layers) {
 		auto bitmap = CreateBitmap(opts.binarizer(), iv);
@@ -294,9 +327,11 @@ Barcodes ReadBarcodes(const ImageView& _iv, const ReaderOptions& opts)
 				for (auto& r : rs) {
 					if (iv.width() != _iv.width())
 						r.d->position = Scale(r.position(), _iv.width() / iv.width());
-					if (!Contains(res, r)) {
+					auto candidates = index.duplicateCandidates(*r.d);
+					if (std::none_of(candidates.begin(), candidates.end(), [&](int i) { return res[i] == r; })) {
 						r.setReaderOptions(opts);
 						r.d->isInverted = bitmap->inverted();
+						index.insert(Size(res), r.position());
 						res.push_back(std::move(r));
 						--maxSymbols;
 					}
@@ -307,15 +342,129 @@ Barcodes ReadBarcodes(const ImageView& _iv, const ReaderOptions& opts)
 		}
 	}
 
-	if (opts.returnErrors()) {
-		// if symbols overlap and one is in error remove it
-		for (auto a = res.begin(); a != res.end(); ++a)
-			for (auto b = std::next(a); b != res.end(); ++b)
-				if (HaveIntersectingBoundingBoxes(a->position(), b->position()) && (a->error() != b->error()))
-					*(a->error() ? a : b) = BarcodeData();
+	if (opts.returnErrors())
+		RemoveOverlappingErrors(res, index);
 
-		std::erase_if(res, [](auto&& r) { return r.format() == BarcodeFormat::None; });
-	}
+	return res;
+}
+
+Barcodes ReadBarcodes(int width, int height, const TileLoader& loadTile, const ReaderOptions& opts, int tileSize, int tileOverlap)
+{
+	// every thread holds one tile, its luminance copy, pyramid and binarized bitmap
+	constexpr int MAX_THREADS = 4;
+
+	if (width <= 0 || height <= 0 || !loadTile)
+		throw std::invalid_argument("Tiled image is null/empty");
+
+	if (tileSize > 0xffff || tileOverlap < 0 || tileOverlap >= tileSize)
+		throw std::invalid_argument("Invalid tile size/overlap");
+
+	// the tiles start every tileSize - tileOverlap pixels, the last ones are aligned with the right/bottom border
+	auto tileOrigins = [step = tileSize - tileOverlap, tileSize](int size) {
+		std::vector<int> res;
+		for (int pos = 0;; pos += step) {
+			res.push_back(std::max(0, std::min(pos, size - tileSize)));
+			if (pos + tileSize >= size)
+				break;
+		}
+		return res;
+	};
+	auto lefts = tileOrigins(width);
+	auto tops = tileOrigins(height);
+	int nbTiles = Size(lefts) * Size(tops);
+
+	// every pixel is owned by one tile, the seams run through the middle of the overlaps
+	auto tileCores = [tileSize](const std::vector<int>& origins, int size) {
+		std::vector<int> ends(origins.size());
+		for (int i = 0; i < Size(origins); ++i)
+			ends[i] = i + 1 < Size(origins) ? (origins[i] + tileSize + origins[i + 1]) / 2 : size;
+		return ends;
+	};
+	auto rightEnds = tileCores(lefts, width);
+	auto bottomEnds = tileCores(tops, height);
+	auto ownedBy = [&](PointI p, int t) {
+		int tx = t % Size(lefts), ty = t / Size(lefts);
+		return (tx == 0 || p.x >= rightEnds[tx - 1]) && p.x < rightEnds[tx] && (ty == 0 || p.y >= bottomEnds[ty - 1]) &&
+			   p.y < bottomEnds[ty];
+	};
+
+	// Stopping early only looks at the tiles completed in scan order, and the later tiles are discarded, so the
+	// result does not depend on the thread timing. Only valid symbols centered in the core of their tile are counted:
+	// a duplicate found in an overlap or an error result does not make a distinct symbol.
+	int maxSymbols = opts.maxNumberOfSymbols() ? opts.maxNumberOfSymbols() : INT_MAX;
+	std::vector<Barcodes> tiles(nbTiles);
+	std::vector<char> tileDone(nbTiles, false);
+	std::atomic<int> nextTile = 0;
+	int nbDone = 0, nbOwned = 0, stopTile = nbTiles;
+	std::exception_ptr error;
+	std::mutex mutex;
+
+	auto readTiles = [&]() {
+		for (int t; (t = nextTile++) < nbTiles;) {
+			int left = lefts[t % Size(lefts)], top = tops[t / Size(lefts)];
+			Barcodes found;
+			try {
+				loadTile(left, top, std::min(tileSize, width - left), std::min(tileSize, height - top),
+						 [&](const ImageView& tile) { found = ReadBarcodes(tile, opts); });
+			} catch (...) {
+				std::lock_guard lock(mutex);
+				if (!error)
+					error = std::current_exception();
+				nextTile = nbTiles;
+			}
+			for (auto& r : found)
+				for (auto& p : r.d->position)
+					p += PointI(left, top);
+
+			std::lock_guard lock(mutex);
+			tiles[t] = std::move(found);
+			tileDone[t] = true;
+			for (; nbDone < stopTile && tileDone[nbDone]; ++nbDone) {
+				nbOwned += Reduce(tiles[nbDone], 0, [&](int n, const Barcode& r) {
+					return n + (r.isValid() && ownedBy(Center(r.position()), nbDone));
+				});
+				if (nbOwned >= maxSymbols) {
+					stopTile = nbDone + 1;
+					nextTile = nbTiles;
+				}
+			}
+		}
+	};
+
+	int nbThreads = std::clamp(narrow_cast<int>(std::thread::hardware_concurrency()), 1, std::min(MAX_THREADS, nbTiles));
+	std::vector<std::thread> threads;
+	for (int i = 1; i < nbThreads; ++i)
+		threads.emplace_back(readTiles);
+	readTiles();
+	for (auto& t : threads)
+		t.join();
+
+	if (error)
+		std::rethrow_exception(error);
+
+	// merge the tiles in scan order, symbols inside the overlap of two tiles are found in both
+	tiles.resize(stopTile);
+	Barcodes res;
+	BarcodeIndex index;
+	for (auto& tile : tiles)
+		for (auto& r : tile) {
+			auto candidates = index.duplicateCandidates(*r.d);
+			auto dup = std::find_if(candidates.begin(), candidates.end(), [&](int i) { return res[i] == r; });
+			if (dup == candidates.end()) {
+				index.insert(Size(res), r.position());
+				res.push_back(std::move(r));
+			} else if (r.lineCount() > res[*dup].lineCount()) {
+				// a linear symbol crossing the seam was seen on more lines in this tile
+				index.update(*dup, res[*dup].position(), r.position());
+				res[*dup] = std::move(r);
+			}
+		}
+
+	if (opts.returnErrors())
+		RemoveOverlappingErrors(res, index);
+
+	if (Size(res) > maxSymbols)
+		res.resize(maxSymbols);
 
 	return res;
 }
@@ -332,6 +481,11 @@ Barcodes ReadBarcodes(const ImageView&, const ReaderOptions&)
 	throw std::runtime_error("This build of zxing-cpp does not support reading barcodes.");
 }
 
+Barcodes ReadBarcodes(int, int, const TileLoader&, const ReaderOptions&, int, int)
+{
+	throw std::runtime_error("This build of zxing-cpp does not support reading barcodes.");
+}
+
 #endif // ZXING_READERS
 
 } // ZXing
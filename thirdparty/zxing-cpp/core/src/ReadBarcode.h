@@ -29,5 +29,23 @@ Barcode ReadBarcode(const ImageView& image, const ReaderOptions& options = {});
  */
 Barcodes ReadBarcodes(const ImageView& image, const ReaderOptions& options = {});
 
+/**
+ * Read barcodes from an image too large to be processed at once, e.g. wider or higher than 65535 pixels
+ *
+ * The image is split into overlapping tiles that are loaded on demand and decoded in parallel, so only a few tiles
+ * are held in memory at any time. Symbols found in more than one tile are reported once. A symbol is found if it lies
+ * inside one tile, which is guaranteed for symbols no larger than the overlap.
+ *
+ * @param width  image width in pixels
+ * @param height  image height in pixels
+ * @param loadTile  provides the tiles, called concurrently from several threads
+ * @param options  optional ReaderOptions to parameterize / speed up detection
+ * @param tileSize  width and height of the tiles in pixels, at most 65535
+ * @param tileOverlap  overlap of neighboring tiles in pixels, less than tileSize
+ * @return #Barcodes  list of barcodes found, may be empty
+ */
+Barcodes ReadBarcodes(int width, int height, const TileLoader& loadTile, const ReaderOptions& options = {},
+					  int tileSize = 4096, int tileOverlap = 512);
+
 } // ZXing
 
@@ -141,6 +141,17 @@ public:
 	/// If true, return the barcodes with errors as well (e.g. checksum errors, see @Barcode::error())
 	ZX_PROPERTY(bool, returnErrors, setReturnErrors)
 
+	/// Restrict returnErrors to a set of BarcodeFormats, the other formats only return valid barcodes. The default is all formats.
+	const BarcodeFormats& errorFormats() const noexcept;
+	ReaderOptions& errorFormats(BarcodeFormats&& v) &;
+	ReaderOptions&& errorFormats(BarcodeFormats&& v) &&;
+	ReaderOptions& errorFormats(const BarcodeFormats& v) & { return errorFormats(BarcodeFormats(v)); }
+	ReaderOptions&& errorFormats(const BarcodeFormats& v) && { return std::move(*this).errorFormats(BarcodeFormats(v)); }
+	inline ReaderOptions& setErrorFormats(BarcodeFormats&& v) & { return errorFormats(std::move(v)); }
+	inline ReaderOptions&& setErrorFormats(BarcodeFormats&& v) && { return std::move(*this).errorFormats(std::move(v)); }
+	inline ReaderOptions& setErrorFormats(const BarcodeFormats& v) & { return errorFormats(BarcodeFormats(v)); }
+	inline ReaderOptions&& setErrorFormats(const BarcodeFormats& v) && { return std::move(*this).errorFormats(BarcodeFormats(v)); }
+
 	/// Specify whether to ignore, read or require EAN-2/5 add-on symbols while scanning EAN/UPC codes
 	ZX_PROPERTY(EanAddOnSymbol, eanAddOnSymbol, setEanAddOnSymbol)
 
@@ -191,6 +202,9 @@ public:
 
 	/// Check if any format is explicitly or implicitly enabled in the formats set
 	bool hasAnyFormat(const BarcodeFormats& formats) const noexcept;
+
+	/// Check if the barcodes with errors of a format are returned (see returnErrors and errorFormats)
+	bool hasErrorFormat(BarcodeFormat format) const noexcept;
 #endif
 };
 
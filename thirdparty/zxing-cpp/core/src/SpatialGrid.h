@@ -0,0 +1,78 @@
+/*
+* Copyright 2026 ZXing authors
+*/
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "Point.h"
+
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace ZXing {
+
+/**
+ * @brief Uniform grid hash over axis aligned bounding boxes.
+ *
+ * Items are referred to by an index into a container owned by the caller. An item is stored in every cell its box
+ * touches, so a query visits only the items close to the queried area, possibly more than once.
+ */
+class SpatialGrid
+{
+	double _cellSize;
+	std::unordered_map<uint64_t, std::vector<int>> _cells;
+
+	int cell(double v) const { return static_cast<int>(std::floor(v / _cellSize)); }
+	static uint64_t key(int cx, int cy) { return (uint64_t(uint32_t(cx)) << 32) | uint32_t(cy); }
+
+public:
+	explicit SpatialGrid(double cellSize) : _cellSize(cellSize > 1 ? cellSize : 1) {}
+
+	double cellSize() const { return _cellSize; }
+	bool empty() const { return _cells.empty(); }
+	void clear() { _cells.clear(); }
+
+	void insert(int id, PointF min, PointF max)
+	{
+		for (int cy = cell(min.y), ey = cell(max.y); cy <= ey; ++cy)
+			for (int cx = cell(min.x), ex = cell(max.x); cx <= ex; ++cx)
+				_cells[key(cx, cy)].push_back(id);
+	}
+
+	void insert(int id, PointF p) { insert(id, p, p); }
+
+	void remove(int id, PointF min, PointF max)
+	{
+		for (int cy = cell(min.y), ey = cell(max.y); cy <= ey; ++cy)
+			for (int cx = cell(min.x), ex = cell(max.x); cx <= ex; ++cx)
+				if (auto it = _cells.find(key(cx, cy)); it != _cells.end())
+					std::erase(it->second, id);
+	}
+
+	/**
+	 * Calls pred(id) for the items stored in the cells touched by the box [min, max] and returns true as soon as pred
+	 * does. Items are visited cell by cell, in insertion order within a cell.
+	 */
+	template <typename F>
+	bool any(PointF min, PointF max, F pred) const
+	{
+		for (int cy = cell(min.y), ey = cell(max.y); cy <= ey; ++cy)
+			for (int cx = cell(min.x), ex = cell(max.x); cx <= ex; ++cx)
+				if (auto it = _cells.find(key(cx, cy)); it != _cells.end())
+					for (int id : it->second)
+						if (pred(id))
+							return true;
+		return false;
+	}
+
+	template <typename F>
+	bool any(PointF p, double radius, F pred) const
+	{
+		return any(p - PointF(radius, radius), p + PointF(radius, radius), pred);
+	}
+};
+
+} // ZXing
@@ -12,7 +12,18 @@
 
 namespace ZXing::Aztec {
 
-class Token;
+/**
+* Tokens are shared between the states: a state only refers to its last token, and the tokens
+* before it are reached through the parent links. Every candidate state of the search thereby
+* costs one or two nodes, instead of a copy of the whole token list.
+*/
+struct TokenNode
+{
+	Token token;
+	int parent; // index of the previous token in the arena, -1 for the first one
+};
+
+using TokenArena = std::vector<TokenNode>;
 
 /**
 * State represents all information about a sequence necessary to generate the current output.
@@ -21,9 +32,9 @@ class Token;
 class EncodingState
 {
 public:
-	// The list of tokens that we output.  If we are in Binary Shift mode, this
-	// token list does *not* yet included the token for those bytes
-	std::vector<Token> tokens;
+	// Index in the TokenArena of the last token that we output, -1 if there is none. If we are in
+	// Binary Shift mode, this token list does *not* yet included the token for those bytes
+	int tokens = -1;
 
 	// The current mode of the encoding (or the mode to which we'll return if
 	// we're in Binary Shift mode.
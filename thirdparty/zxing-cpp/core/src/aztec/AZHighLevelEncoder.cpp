@@ -14,7 +14,6 @@
 #include <algorithm>
 #include <array>
 #include <cstdint>
-#include <list>
 #include <vector>
 
 namespace ZXing::Aztec {
@@ -120,60 +119,65 @@ static const std::array<std::array<int8_t, 6>, 6>& InitShiftTable()
 
 const std::array<std::array<int8_t, 6>, 6>& SHIFT_TABLE = InitShiftTable();
 
+// Append a token after the given one, returns the index of the new token.
+static int AppendToken(TokenArena& arena, int parent, Token token)
+{
+	arena.push_back(TokenNode{token, parent});
+	return Size(arena) - 1;
+}
+
 // Create a new state representing this state with a latch to a (not
 // necessary different) mode, and then a code.
-static EncodingState LatchAndAppend(const EncodingState& state, int mode, int value)
+static EncodingState LatchAndAppend(TokenArena& arena, const EncodingState& state, int mode, int value)
 {
 	//assert binaryShiftByteCount == 0;
 	int bitCount = state.bitCount;
-	auto tokens = state.tokens;
+	int tokens = state.tokens;
 	if (mode != state.mode) {
 		int latch = LATCH_TABLE[state.mode][mode];
-		tokens.push_back(Token::CreateSimple(latch & 0xFFFF, latch >> 16));
+		tokens = AppendToken(arena, tokens, Token::CreateSimple(latch & 0xFFFF, latch >> 16));
 		bitCount += latch >> 16;
 	}
 	int latchModeBitCount = mode == MODE_DIGIT ? 4 : 5;
-	tokens.push_back(Token::CreateSimple(value, latchModeBitCount));
+	tokens = AppendToken(arena, tokens, Token::CreateSimple(value, latchModeBitCount));
 	return EncodingState{ tokens, mode, 0, bitCount + latchModeBitCount };
 }
 
 // Create a new state representing this state, with a temporary shift
 // to a different mode to output a single value.
-static EncodingState ShiftAndAppend(const EncodingState& state, int mode, int value)
+static EncodingState ShiftAndAppend(TokenArena& arena, const EncodingState& state, int mode, int value)
 {
 	//assert binaryShiftByteCount == 0 && this.mode != mode;
 	int thisModeBitCount = state.mode == MODE_DIGIT ? 4 : 5;
 	// Shifts exist only to UPPER and PUNCT, both with tokens size 5.
-	auto tokens = state.tokens;
-	tokens.push_back(Token::CreateSimple(SHIFT_TABLE[state.mode][mode], thisModeBitCount));
-	tokens.push_back(Token::CreateSimple(value, 5));
+	int tokens = AppendToken(arena, state.tokens, Token::CreateSimple(SHIFT_TABLE[state.mode][mode], thisModeBitCount));
+	tokens = AppendToken(arena, tokens, Token::CreateSimple(value, 5));
 	return EncodingState{ tokens, state.mode, 0, state.bitCount + thisModeBitCount + 5 };
 }
 
 // Create the state identical to this one, but we are no longer in
 // Binary Shift mode.
-static EncodingState EndBinaryShift(const EncodingState& state, int index)
+static EncodingState EndBinaryShift(TokenArena& arena, const EncodingState& state, int index)
 {
 	if (state.binaryShiftByteCount == 0) {
 		return state;
 	}
-	auto tokens = state.tokens;
-	tokens.push_back(Token::CreateBinaryShift(index - state.binaryShiftByteCount, state.binaryShiftByteCount));
+	int tokens = AppendToken(arena, state.tokens, Token::CreateBinaryShift(index - state.binaryShiftByteCount, state.binaryShiftByteCount));
 	//assert token.getTotalBitCount() == this.bitCount;
 	return EncodingState{ tokens, state.mode, 0, state.bitCount };
 }
 
 // Create a new state representing this state, but an additional character
 // output in Binary Shift mode.
-static EncodingState AddBinaryShiftChar(const EncodingState& state, int index)
+static EncodingState AddBinaryShiftChar(TokenArena& arena, const EncodingState& state, int index)
 {
-	auto tokens = state.tokens;
+	int tokens = state.tokens;
 	int mode = state.mode;
 	int bitCount = state.bitCount;
 	if (state.mode == MODE_PUNCT || state.mode == MODE_DIGIT) {
 		//assert binaryShiftByteCount == 0;
 		int latch = LATCH_TABLE[mode][MODE_UPPER];
-		tokens.push_back(Token::CreateSimple(latch & 0xFFFF, latch >> 16));
+		tokens = AppendToken(arena, tokens, Token::CreateSimple(latch & 0xFFFF, latch >> 16));
 		bitCount += latch >> 16;
 		mode = MODE_UPPER;
 	}
@@ -181,7 +185,7 @@ static EncodingState AddBinaryShiftChar(const EncodingState& state, int index)
 	EncodingState result{ tokens, mode, state.binaryShiftByteCount + 1, bitCount + deltaBitCount };
 	if (result.binaryShiftByteCount == 2047 + 31) {
 		// The string is as long as it's allowed to be.  We should end it.
-		result = EndBinaryShift(result, index + 1);
+		result = EndBinaryShift(arena, result, index + 1);
 	}
 	return result;
 }
@@ -216,44 +220,49 @@ static bool IsBetterThanOrEqualTo(const EncodingState& state, const EncodingStat
 	return newModeBitCount <= other.bitCount;
 }
 
-static BitArray ToBitArray(const EncodingState& state, const std::string& text)
+static BitArray ToBitArray(TokenArena& arena, const EncodingState& state, const std::string& text)
 {
-	auto endState = EndBinaryShift(state, Size(text));
+	auto endState = EndBinaryShift(arena, state, Size(text));
+	// Walk the token chain back to its start.
+	std::vector<int> chain;
+	for (int i = endState.tokens; i >= 0; i = arena[i].parent) {
+		chain.push_back(i);
+	}
 	BitArray bits;
 	// Add each token to the result.
-	for (const Token& symbol : endState.tokens) {
-		symbol.appendTo(bits, text);
+	for (auto i = chain.rbegin(); i != chain.rend(); ++i) {
+		arena[*i].token.appendTo(bits, text);
 	}
 	//assert bitArray.getSize() == this.bitCount;
 	return bits;
 }
 
-static void UpdateStateForPair(const EncodingState& state, int index, int pairCode, std::list<EncodingState>& result)
+static void UpdateStateForPair(TokenArena& arena, const EncodingState& state, int index, int pairCode, std::vector<EncodingState>& result)
 {
-	EncodingState stateNoBinary = EndBinaryShift(state, index);
+	EncodingState stateNoBinary = EndBinaryShift(arena, state, index);
 	// Possibility 1.  Latch to MODE_PUNCT, and then append this code
-	result.push_back(LatchAndAppend(stateNoBinary, MODE_PUNCT, pairCode));
+	result.push_back(LatchAndAppend(arena, stateNoBinary, MODE_PUNCT, pairCode));
 	if (state.mode != MODE_PUNCT) {
 		// Possibility 2.  Shift to MODE_PUNCT, and then append this code.
 		// Every state except MODE_PUNCT (handled above) can shift
-		result.push_back(ShiftAndAppend(stateNoBinary, MODE_PUNCT, pairCode));
+		result.push_back(ShiftAndAppend(arena, stateNoBinary, MODE_PUNCT, pairCode));
 	}
 	if (pairCode == 3 || pairCode == 4) {
 		// both characters are in DIGITS.  Sometimes better to just add two digits
-		auto digitState = LatchAndAppend(stateNoBinary, MODE_DIGIT, 16 - pairCode);	// period or comma in DIGIT
-		result.push_back(LatchAndAppend(digitState, MODE_DIGIT, 1));				// space in DIGIT
+		auto digitState = LatchAndAppend(arena, stateNoBinary, MODE_DIGIT, 16 - pairCode);	// period or comma in DIGIT
+		result.push_back(LatchAndAppend(arena, digitState, MODE_DIGIT, 1));				// space in DIGIT
 	}
 	if (state.binaryShiftByteCount > 0) {
 		// It only makes sense to do the characters as binary if we're already
 		// in binary mode.
-		result.push_back(AddBinaryShiftChar(AddBinaryShiftChar(state, index), index + 1));
+		result.push_back(AddBinaryShiftChar(arena, AddBinaryShiftChar(arena, state, index), index + 1));
 	}
 }
 
-
-static std::list<EncodingState> SimplifyStates(const std::list<EncodingState>& states)
+// Keep the states of the candidates that are not dominated by another one, in their original order.
+static void SimplifyStates(const std::vector<EncodingState>& states, std::vector<EncodingState>& result)
 {
-	std::list<EncodingState> result;
+	result.clear();
 	for (auto& newState : states) {
 		bool add = true;
 		for (auto iterator = result.begin(); iterator != result.end();) {
@@ -273,24 +282,12 @@ static std::list<EncodingState> SimplifyStates(const std::list<EncodingState>& s
 			result.push_back(newState);
 		}
 	}
-	return result;
 }
 
-static std::list<EncodingState> UpdateStateListForPair(const std::list<EncodingState>& states, int index, int pairCode)
-{
-	std::list<EncodingState> result;
-	for (auto& state : states) {
-		UpdateStateForPair(state, index, pairCode, result);
-	}
-	return SimplifyStates(result);
-}
-
-
-
 // Return a set of states that represent the possible ways of updating this
 // state for the next character.  The resulting set of states are added to
 // the "result" list.
-static void UpdateStateForChar(const EncodingState& state, const std::string& text, int index, std::list<EncodingState>& result)
+static void UpdateStateForChar(TokenArena& arena, const EncodingState& state, const std::string& text, int index, std::vector<EncodingState>& result)
 {
 	int ch = text[index] & 0xff;
 	bool charInCurrentTable = CHAR_MAP[state.mode][ch] > 0;
@@ -301,7 +298,7 @@ static void UpdateStateForChar(const EncodingState& state, const std::string& te
 		if (charInMode > 0) {
 			if (firstTime) {
 				// Only create stateNoBinary the first time it's required.
-				stateNoBinary = EndBinaryShift(state, index);
+				stateNoBinary = EndBinaryShift(arena, state, index);
 				firstTime = false;
 			}
 			// Try generating the character by latching to its mode
@@ -310,13 +307,13 @@ static void UpdateStateForChar(const EncodingState& state, const std::string& te
 				// any other mode except possibly digit (which uses only 4 bits).  Any
 				// other latch would be equally successful *after* this character, and
 				// so wouldn't save any bits.
-				result.push_back(LatchAndAppend(stateNoBinary, mode, charInMode));
+				result.push_back(LatchAndAppend(arena, stateNoBinary, mode, charInMode));
 			}
 			// Try generating the character by switching to its mode.
 			if (!charInCurrentTable && SHIFT_TABLE[state.mode][mode] >= 0) {
 				// It never makes sense to temporarily shift to another mode if the
 				// character exists in the current mode.  That can never save bits.
-				result.push_back(ShiftAndAppend(stateNoBinary, mode, charInMode));
+				result.push_back(ShiftAndAppend(arena, stateNoBinary, mode, charInMode));
 			}
 		}
 	}
@@ -324,20 +321,8 @@ static void UpdateStateForChar(const EncodingState& state, const std::string& te
 		// It's never worthwhile to go into binary shift mode if you're not already
 		// in binary shift mode, and the character exists in your current mode.
 		// That can never save bits over just outputting the char in the current mode.
-		result.push_back(AddBinaryShiftChar(state, index));
-	}
-}
-
-// We update a set of states for a new character by updating each state
-// for the new character, merging the results, and then removing the
-// non-optimal states.
-static std::list<EncodingState> UpdateStateListForChar(const std::list<EncodingState>& states, const std::string& text, int index)
-{
-	std::list<EncodingState> result;
-	for (auto& state : states) {
-		UpdateStateForChar(state, text, index, result);
+		result.push_back(AddBinaryShiftChar(arena, state, index));
 	}
-	return result.size() > 1 ? SimplifyStates(result) : result;
 }
 
 /**
@@ -346,8 +331,15 @@ static std::list<EncodingState> UpdateStateListForChar(const std::list<EncodingS
 BitArray
 HighLevelEncoder::Encode(const std::string& text)
 {
-	std::list<EncodingState> states;
-	states.push_back(EncodingState{ std::vector<Token>(), MODE_UPPER, 0, 0 });
+	// All the tokens of all the candidate states. States are small values pointing into it, so the
+	// cost of a step is linear in the number of states instead of the length of their outputs.
+	TokenArena arena;
+	arena.reserve(4 * text.size() + 16);
+
+	// The non-dominated states after each step, and the candidates for the next one. Both buffers
+	// are reused along the whole text.
+	std::vector<EncodingState> states, candidates;
+	states.push_back(EncodingState{ -1, MODE_UPPER, 0, 0 });
 	for (int index = 0; index < Size(text); index++) {
 		int pairCode;
 		int nextChar = index + 1 < Size(text) ? text[index + 1] : 0;
@@ -358,20 +350,32 @@ HighLevelEncoder::Encode(const std::string& text)
 		case ':': pairCode = nextChar == ' ' ? 5 : 0; break;
 		default: pairCode = 0;
 		}
+		candidates.clear();
 		if (pairCode > 0) {
 			// We have one of the four special PUNCT pairs.  Treat them specially.
 			// Get a new set of states for the two new characters.
-			states = UpdateStateListForPair(states, index, pairCode);
+			for (auto& state : states) {
+				UpdateStateForPair(arena, state, index, pairCode, candidates);
+			}
 			index++;
 		} else {
 			// Get a new set of states for the new character.
-			states = UpdateStateListForChar(states, text, index);
+			for (auto& state : states) {
+				UpdateStateForChar(arena, state, text, index, candidates);
+			}
+		}
+		// We update a set of states by updating each state for the new character(s),
+		// merging the results, and then removing the non-optimal states.
+		if (candidates.size() > 1) {
+			SimplifyStates(candidates, states);
+		} else {
+			std::swap(states, candidates);
 		}
 	}
 	// We are left with a set of states.  Find the shortest one.
 	EncodingState minState = *std::min_element(states.begin(), states.end(), [](const EncodingState& a, const EncodingState& b) { return a.bitCount < b.bitCount; });
 	// Convert it to a bit array, and return.
-	return ToBitArray(minState, text);
+	return ToBitArray(arena, minState, text);
 }
 
 } // namespace ZXing::Aztec
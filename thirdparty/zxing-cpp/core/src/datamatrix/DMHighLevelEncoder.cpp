@@ -8,19 +8,18 @@
 
 #include "ByteArray.h"
 #include "CharacterSet.h"
-#include "DMEncoderContext.h"
+#include "DMSymbolInfo.h"
 #include "TextEncoder.h"
 #include "ZXAlgorithms.h"
 
 #include <algorithm>
 #include <array>
-#include <cmath>
 #include <cstddef>
 #include <cstdint>
-#include <functional>
 #include <limits>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 namespace ZXing::DataMatrix {
 
@@ -30,6 +29,7 @@ static const uint8_t MACRO_05 = 236;
 static const uint8_t MACRO_06 = 237;
 static const uint8_t C40_UNLATCH = 254;
 static const uint8_t X12_UNLATCH = 254;
+static const uint8_t EDIFACT_UNLATCH = 31;
 
 enum
 {
@@ -60,26 +60,9 @@ static bool IsExtendedASCII(int ch)
 	return ch >= 128 && ch <= 255;
 }
 
-static bool IsNativeC40(int ch)
-{
-	return (ch == ' ') || (ch >= '0' && ch <= '9') || (ch >= 'A' && ch <= 'Z');
-}
-
-static bool IsNativeText(int ch)
-{
-	return (ch == ' ') || (ch >= '0' && ch <= '9') || (ch >= 'a' && ch <= 'z');
-}
-
-static bool IsX12TermSep(int ch)
-{
-	return (ch == '\r') //CR
-		|| (ch == '*')
-		|| (ch == '>');
-}
-
 static bool IsNativeX12(int ch)
 {
-	return IsX12TermSep(ch) || (ch == ' ') || (ch >= '0' && ch <= '9') || (ch >= 'A' && ch <= 'Z');
+	return (ch == '\r') || (ch == '*') || (ch == '>') || (ch == ' ') || (ch >= '0' && ch <= '9') || (ch >= 'A' && ch <= 'Z');
 }
 
 static bool IsNativeEDIFACT(int ch)
@@ -87,26 +70,6 @@ static bool IsNativeEDIFACT(int ch)
 	return ch >= ' ' && ch <= '^';
 }
 
-static bool IsSpecialB256(int /*ch*/)
-{
-	return false; //TODO NOT IMPLEMENTED YET!!!
-}
-
-
-/*
-* Converts the message to a byte array using the default encoding (cp437) as defined by the
-* specification
-*
-* @param msg the message
-* @return the byte array of the message
-*/
-
-/*
-public static byte[] getBytesForMessage(String msg) {
-return msg.getBytes(Charset.forName("cp437")); //See 4.4.3 and annex B of ISO/IEC 15438:2001(E)
-}
-*/
-
 static uint8_t Randomize253State(uint8_t ch, int codewordPosition)
 {
 	int pseudoRandom = ((149 * codewordPosition) % 253) + 1;
@@ -114,188 +77,6 @@ static uint8_t Randomize253State(uint8_t ch, int codewordPosition)
 	return narrow_cast<uint8_t>(tempVariable <= 254 ? tempVariable : (tempVariable - 254));
 }
 
-static int FindMinimums(const std::array<int, 6>& intCharCounts, int min, std::array<int, 6>& mins)
-{
-	mins.fill(0);
-	for (int i = 0; i < 6; i++) {
-		int current = intCharCounts[i];
-		if (min > current) {
-			min = current;
-			mins.fill(0);
-		}
-		if (min == current) {
-			mins[i]++;
-		}
-	}
-	return min;
-}
-
-static int LookAheadTest(const std::string& msg, size_t startpos, int currentMode)
-{
-	if (startpos >= msg.length()) {
-		return currentMode;
-	}
-	std::array<float, 6> charCounts;
-	//step J
-	if (currentMode == ASCII_ENCODATION) {
-		charCounts = { 0, 1, 1, 1, 1, 1.25f };
-	}
-	else {
-		charCounts = { 1, 2, 2, 2, 2, 2.25f };
-		charCounts[currentMode] = 0;
-	}
-
-	std::array<int, 6> mins;
-	std::array<int, 6> intCharCounts;
-	int charsProcessed = 0;
-	while (true) {
-		//step K
-		if ((startpos + charsProcessed) == msg.length()) {
-			int min = std::numeric_limits<int>::max();
-			std::transform(charCounts.begin(), charCounts.end(), intCharCounts.begin(),
-						   [](float x) { return static_cast<int>(std::ceil(x)); });
-			min = FindMinimums(intCharCounts, min, mins);
-			int minCount = Reduce(mins);
-
-			if (intCharCounts[ASCII_ENCODATION] == min) {
-				return ASCII_ENCODATION;
-			}
-			if (minCount == 1 && mins[BASE256_ENCODATION] > 0) {
-				return BASE256_ENCODATION;
-			}
-			if (minCount == 1 && mins[EDIFACT_ENCODATION] > 0) {
-				return EDIFACT_ENCODATION;
-			}
-			if (minCount == 1 && mins[TEXT_ENCODATION] > 0) {
-				return TEXT_ENCODATION;
-			}
-			if (minCount == 1 && mins[X12_ENCODATION] > 0) {
-				return X12_ENCODATION;
-			}
-			return C40_ENCODATION;
-		}
-
-		int c = (uint8_t)msg.at(startpos + charsProcessed);
-		charsProcessed++;
-
-		//step L
-		if (IsDigit(c)) {
-			charCounts[ASCII_ENCODATION] += 0.5f;
-		}
-		else if (IsExtendedASCII(c)) {
-			charCounts[ASCII_ENCODATION] = std::ceil(charCounts[ASCII_ENCODATION]);
-			charCounts[ASCII_ENCODATION] += 2.0f;
-		}
-		else {
-			charCounts[ASCII_ENCODATION] = std::ceil(charCounts[ASCII_ENCODATION]);
-			charCounts[ASCII_ENCODATION] += 1.0f;
-		}
-
-		//step M
-		if (IsNativeC40(c)) {
-			charCounts[C40_ENCODATION] += 2.0f / 3.0f;
-		}
-		else if (IsExtendedASCII(c)) {
-			charCounts[C40_ENCODATION] += 8.0f / 3.0f;
-		}
-		else {
-			charCounts[C40_ENCODATION] += 4.0f / 3.0f;
-		}
-
-		//step N
-		if (IsNativeText(c)) {
-			charCounts[TEXT_ENCODATION] += 2.0f / 3.0f;
-		}
-		else if (IsExtendedASCII(c)) {
-			charCounts[TEXT_ENCODATION] += 8.0f / 3.0f;
-		}
-		else {
-			charCounts[TEXT_ENCODATION] += 4.0f / 3.0f;
-		}
-
-		//step O
-		if (IsNativeX12(c)) {
-			charCounts[X12_ENCODATION] += 2.0f / 3.0f;
-		}
-		else if (IsExtendedASCII(c)) {
-			charCounts[X12_ENCODATION] += 13.0f / 3.0f;
-		}
-		else {
-			charCounts[X12_ENCODATION] += 10.0f / 3.0f;
-		}
-
-		//step P
-		if (IsNativeEDIFACT(c)) {
-			charCounts[EDIFACT_ENCODATION] += 3.0f / 4.0f;
-		}
-		else if (IsExtendedASCII(c)) {
-			charCounts[EDIFACT_ENCODATION] += 17.0f / 4.0f;
-		}
-		else {
-			charCounts[EDIFACT_ENCODATION] += 13.0f / 4.0f;
-		}
-
-		// step Q
-		if (IsSpecialB256(c)) {
-			charCounts[BASE256_ENCODATION] += 4.0f;
-		}
-		else {
-			charCounts[BASE256_ENCODATION] += 1.0f;
-		}
-
-		//step R
-		if (charsProcessed >= 4) {
-			std::transform(charCounts.begin(), charCounts.end(), intCharCounts.begin(),
-						   [](float x) { return static_cast<int>(std::ceil(x)); });
-			FindMinimums(intCharCounts, std::numeric_limits<int>::max(), mins);
-			int minCount = Reduce(mins);
-
-			if (intCharCounts[ASCII_ENCODATION] < intCharCounts[BASE256_ENCODATION]
-				&& intCharCounts[ASCII_ENCODATION] < intCharCounts[C40_ENCODATION]
-				&& intCharCounts[ASCII_ENCODATION] < intCharCounts[TEXT_ENCODATION]
-				&& intCharCounts[ASCII_ENCODATION] < intCharCounts[X12_ENCODATION]
-				&& intCharCounts[ASCII_ENCODATION] < intCharCounts[EDIFACT_ENCODATION]) {
-				return ASCII_ENCODATION;
-			}
-			if (intCharCounts[BASE256_ENCODATION] < intCharCounts[ASCII_ENCODATION]
-				|| (mins[C40_ENCODATION] + mins[TEXT_ENCODATION] + mins[X12_ENCODATION] + mins[EDIFACT_ENCODATION]) == 0) {
-				return BASE256_ENCODATION;
-			}
-			if (minCount == 1 && mins[EDIFACT_ENCODATION] > 0) {
-				return EDIFACT_ENCODATION;
-			}
-			if (minCount == 1 && mins[TEXT_ENCODATION] > 0) {
-				return TEXT_ENCODATION;
-			}
-			if (minCount == 1 && mins[X12_ENCODATION] > 0) {
-				return X12_ENCODATION;
-			}
-			if (intCharCounts[C40_ENCODATION] + 1 < intCharCounts[ASCII_ENCODATION]
-				&& intCharCounts[C40_ENCODATION] + 1 < intCharCounts[BASE256_ENCODATION]
-				&& intCharCounts[C40_ENCODATION] + 1 < intCharCounts[EDIFACT_ENCODATION]
-				&& intCharCounts[C40_ENCODATION] + 1 < intCharCounts[TEXT_ENCODATION]) {
-				if (intCharCounts[C40_ENCODATION] < intCharCounts[X12_ENCODATION]) {
-					return C40_ENCODATION;
-				}
-				if (intCharCounts[C40_ENCODATION] == intCharCounts[X12_ENCODATION]) {
-					size_t p = startpos + charsProcessed + 1;
-					while (p < msg.length()) {
-						int tc = msg.at(p);
-						if (IsX12TermSep(tc)) {
-							return X12_ENCODATION;
-						}
-						if (!IsNativeX12(tc)) {
-							break;
-						}
-						p++;
-					}
-					return C40_ENCODATION;
-				}
-			}
-		}
-	}
-}
-
 static std::string ToHexString(int c)
 {
 	const char* digits = "0123456789abcdef";
@@ -307,18 +88,6 @@ static std::string ToHexString(int c)
 }
 
 namespace ASCIIEncoder {
-	/**
-	* Determines the number of consecutive characters that are encodable using numeric compaction.
-	*
-	* @param msg      the message
-	* @param startpos the start position within the message
-	* @return the requested character count
-	*/
-	static int DetermineConsecutiveDigitCount(const std::string& msg, int startpos)
-	{
-		auto begin = msg.begin() + startpos;
-		return narrow_cast<int>(std::find_if_not(begin, msg.end(), IsDigit) - begin);
-	}
 
 	static uint8_t EncodeASCIIDigits(int digit1, int digit2)
 	{
@@ -329,32 +98,14 @@ namespace ASCIIEncoder {
 		return '?';
 	}
 
-	static void EncodeASCII(EncoderContext& context)
+	static void EncodeChar(int c, ByteArray& codewords)
 	{
-		//step B
-		int n = DetermineConsecutiveDigitCount(context.message(), context.currentPos());
-		if (n >= 2) {
-			context.addCodeword(EncodeASCIIDigits(context.currentChar(), context.nextChar()));
-			context.setCurrentPos(context.currentPos() + 2);
+		if (IsExtendedASCII(c)) {
+			codewords.push_back(UPPER_SHIFT);
+			codewords.push_back(static_cast<uint8_t>(c - 128 + 1));
 		}
 		else {
-			int c = context.currentChar();
-			int newMode = LookAheadTest(context.message(), context.currentPos(), ASCII_ENCODATION);
-			if (newMode != ASCII_ENCODATION)
-			{
-				// the order here is the same as ENCODATION;
-				context.addCodeword(LATCHES[newMode]);
-				context.setNewEncoding(newMode);
-			}
-			else if (IsExtendedASCII(c)) {
-				context.addCodeword(UPPER_SHIFT);
-				context.addCodeword(static_cast<uint8_t>(c - 128 + 1));
-				context.setCurrentPos(context.currentPos() + 1);
-			}
-			else {
-				context.addCodeword(static_cast<uint8_t>(c + 1));
-				context.setCurrentPos(context.currentPos() + 1);
-			}
+			codewords.push_back(static_cast<uint8_t>(c + 1));
 		}
 	}
 
@@ -407,120 +158,13 @@ namespace C40Encoder {
 		return len;
 	}
 
-	static int BacktrackOneCharacter(EncoderContext& context, std::string& buffer, std::string& removed, int lastCharSize,
-									 const std::function<int(int, std::string&)>& encodeChar)
-	{
-		buffer.resize(buffer.size() - lastCharSize);
-		context.setCurrentPos(context.currentPos() - 1);
-		int c = context.currentChar();
-		lastCharSize = encodeChar(c, removed);
-		context.resetSymbolInfo(); //Deal with possible reduction in symbol size
-		return lastCharSize;
-	}
-
-	static void EncodeToCodewords(EncoderContext& context, const std::string& sb, int startPos) {
+	static void EncodeToCodewords(ByteArray& codewords, const std::string& sb, int startPos) {
 		int c1 = sb.at(startPos);
 		int c2 = sb.at(startPos + 1);
 		int c3 = sb.at(startPos + 2);
 		int v = (1600 * c1) + (40 * c2) + c3 + 1;
-		context.addCodeword(narrow_cast<uint8_t>(v / 256));
-		context.addCodeword(narrow_cast<uint8_t>(v % 256));
-	}
-
-	static void WriteNextTriplet(EncoderContext& context, std::string& buffer)
-	{
-		EncodeToCodewords(context, buffer, 0);
-		buffer.erase(0, 3);
-	}
-
-	/**
-	* Handle "end of data" situations
-	*
-	* @param context the encoder context
-	* @param buffer  the buffer with the remaining encoded characters
-	*/
-	static void HandleEOD(EncoderContext& context, std::string& buffer)
-	{
-		int unwritten = (Size(buffer) / 3) * 2;
-		int rest = Size(buffer) % 3;
-
-		int curCodewordCount = context.codewordCount() + unwritten;
-		auto symbolInfo = context.updateSymbolInfo(curCodewordCount);
-		int available = symbolInfo->dataCapacity() - curCodewordCount;
-
-		if (rest == 2) {
-			buffer.push_back('\0'); //Shift 1
-			while (buffer.length() >= 3) {
-				WriteNextTriplet(context, buffer);
-			}
-			if (context.hasMoreCharacters()) {
-				context.addCodeword(C40_UNLATCH);
-			}
-		}
-		else if (available == 1 && rest == 1) {
-			while (buffer.length() >= 3) {
-				WriteNextTriplet(context, buffer);
-			}
-			if (context.hasMoreCharacters()) {
-				context.addCodeword(C40_UNLATCH);
-			}
-			// else no unlatch
-			context.setCurrentPos(context.currentPos() - 1);
-		}
-		else if (rest == 0) {
-			while (buffer.length() >= 3) {
-				WriteNextTriplet(context, buffer);
-			}
-			if (available > 0 || context.hasMoreCharacters()) {
-				context.addCodeword(C40_UNLATCH);
-			}
-		}
-		else {
-			throw std::logic_error("Unexpected case. Please report!");
-		}
-		context.setNewEncoding(ASCII_ENCODATION);
-	}
-
-	static void EncodeC40(EncoderContext& context, const std::function<int (int, std::string&)>& encodeChar, int encodingMode)
-	{
-		//step C
-		std::string buffer;
-		while (context.hasMoreCharacters()) {
-			int c = context.currentChar();
-			context.setCurrentPos(context.currentPos() + 1);
-			int lastCharSize = encodeChar(c, buffer);
-			int unwritten = narrow_cast<int>(buffer.length() / 3) * 2;
-			int curCodewordCount = context.codewordCount() + unwritten;
-			auto symbolInfo = context.updateSymbolInfo(curCodewordCount);
-			int available = symbolInfo->dataCapacity() - curCodewordCount;
-
-			if (!context.hasMoreCharacters()) {
-				//Avoid having a single C40 value in the last triplet
-				std::string removed;
-				if ((buffer.length() % 3) == 2 && available != 2) {
-					lastCharSize = BacktrackOneCharacter(context, buffer, removed, lastCharSize, encodeChar);
-				}
-				while ((buffer.length() % 3) == 1 && ((lastCharSize <= 3 && available != 1) || lastCharSize > 3)) {
-					lastCharSize = BacktrackOneCharacter(context, buffer, removed, lastCharSize, encodeChar);
-				}
-				break;
-			}
-
-			if ((buffer.length() % 3) == 0) {
-				int newMode = LookAheadTest(context.message(), context.currentPos(), encodingMode);
-				if (newMode != encodingMode) {
-					// Return to ASCII encodation, which will actually handle latch to new mode
-					context.setNewEncoding(ASCII_ENCODATION);
-					break;
-				}
-			}
-		}
-		return HandleEOD(context, buffer);
-	}
-
-	static void EncodeC40(EncoderContext& context)
-	{
-		EncodeC40(context, EncodeChar, C40_ENCODATION);
+		codewords.push_back(narrow_cast<uint8_t>(v / 256));
+		codewords.push_back(narrow_cast<uint8_t>(v % 256));
 	}
 
 } // C40Encoder
@@ -582,11 +226,6 @@ namespace DMTextEncoder {
 		return len;
 	}
 
-	static void EncodeText(EncoderContext& context)
-	{
-		C40Encoder::EncodeC40(context, EncodeChar, TEXT_ENCODATION);
-	}
-
 } // DMTextEncoder
 
 namespace X12Encoder {
@@ -611,43 +250,6 @@ namespace X12Encoder {
 		return 1;
 	}
 
-	static void HandleEOD(EncoderContext& context, std::string& buffer)
-	{
-		int codewordCount = context.codewordCount();
-		auto symbolInfo = context.updateSymbolInfo(codewordCount);
-		int available = symbolInfo->dataCapacity() - codewordCount;
-		context.setCurrentPos(context.currentPos() - Size(buffer));
-		if (context.remainingCharacters() > 1 || available > 1 || context.remainingCharacters() != available) {
-			context.addCodeword(X12_UNLATCH);
-		}
-		if (context.newEncoding() < 0) {
-			context.setNewEncoding(ASCII_ENCODATION);
-		}
-	}
-
-	static void EncodeX12(EncoderContext& context)
-	{
-		//step C
-		std::string buffer;
-		while (context.hasMoreCharacters()) {
-			int c = context.currentChar();
-			context.setCurrentPos(context.currentPos() + 1);
-			EncodeChar(c, buffer);
-			size_t count = buffer.length();
-			if ((count % 3) == 0) {
-				C40Encoder::WriteNextTriplet(context, buffer);
-
-				int newMode = LookAheadTest(context.message(), context.currentPos(), X12_ENCODATION);
-				if (newMode != X12_ENCODATION) {
-					// Return to ASCII encodation, which will actually handle latch to new mode
-					context.setNewEncoding(ASCII_ENCODATION);
-					break;
-				}
-			}
-		}
-		HandleEOD(context, buffer);
-	}
-	
 } // X12Encoder
 
 namespace EdifactEncoder {
@@ -665,180 +267,373 @@ namespace EdifactEncoder {
 		}
 	}
 
-	static ByteArray EncodeToCodewords(const std::string& sb, int startPos)
+	static void EncodeToCodewords(ByteArray& codewords, const std::string& sb)
 	{
-		int len = Size(sb) - startPos;
+		int len = Size(sb);
 		if (len == 0) {
 			throw std::invalid_argument("buffer must not be empty");
 		}
-		int c1 = sb.at(startPos);
-		int c2 = len >= 2 ? sb.at(startPos + 1) : 0;
-		int c3 = len >= 3 ? sb.at(startPos + 2) : 0;
-		int c4 = len >= 4 ? sb.at(startPos + 3) : 0;
+		int c1 = sb.at(0);
+		int c2 = len >= 2 ? sb.at(1) : 0;
+		int c3 = len >= 3 ? sb.at(2) : 0;
+		int c4 = len >= 4 ? sb.at(3) : 0;
 
 		int v = (c1 << 18) + (c2 << 12) + (c3 << 6) + c4;
-		uint8_t cw1 = (v >> 16) & 255;
-		uint8_t cw2 = (v >> 8) & 255;
-		uint8_t cw3 = v & 255;
-		ByteArray res;
-		res.reserve(3);
-		res.push_back(cw1);
+		codewords.push_back((v >> 16) & 255);
 		if (len >= 2) {
-			res.push_back(cw2);
+			codewords.push_back((v >> 8) & 255);
 		}
 		if (len >= 3) {
-			res.push_back(cw3);
+			codewords.push_back(v & 255);
 		}
-		return res;
 	}
 
-	/**
-	* Handle "end of data" situations
-	*
-	* @param context the encoder context
-	* @param buffer  the buffer with the remaining encoded characters
-	*/
-	static void HandleEOD(EncoderContext& context, std::string& buffer)
+} // EdifactEncoder
+
+namespace Base256Encoder {
+
+	static int Randomize255State(int ch, int codewordPosition)
+	{
+		int pseudoRandom = ((149 * codewordPosition) % 255) + 1;
+		int tempVariable = ch + pseudoRandom;
+		if (tempVariable <= 255) {
+			return tempVariable;
+		}
+		else {
+			return tempVariable - 256;
+		}
+	}
+
+	static void EncodeSegment(ByteArray& codewords, std::string_view data)
+	{
+		int dataCount = Size(data);
+		std::string buffer;
+		if (dataCount <= 249) {
+			buffer.push_back((char)dataCount);
+		}
+		else if (dataCount <= 1555) {
+			buffer.push_back((char)((dataCount / 250) + 249));
+			buffer.push_back((char)(dataCount % 250));
+		}
+		else {
+			throw std::invalid_argument("Message length not in valid ranges: " + std::to_string(dataCount));
+		}
+		buffer.append(data);
+		for (char c : buffer) {
+			codewords.push_back(narrow_cast<uint8_t>(Randomize255State(c & 0xff, Size(codewords) + 1)));
+		}
+	}
+
+} // Base256Encoder
+
+/**
+* Minimal encodation, by dynamic programming over the message positions and the 6 encodation modes.
+*
+* The node (pos, mode) holds the minimal number of codewords encoding the first pos characters and
+* ending on a codeword boundary in that mode. The edges out of a node are the latches/unlatches at
+* the same position, and the few characters filling the next codeword(s) of its mode: there is a
+* constant number of them, so the whole plan takes linear time, over a buffer allocated once.
+*
+* A C40/Text character takes 1 to 4 values, and a triplet may hold the values of several characters
+* or part of one: C40 and Text also have nodes for 1 and 2 values pending in the current triplet.
+* The 2 codewords of a triplet are counted when its first value is, so all costs stay exact.
+*
+* Some savings at the end of the data depend on the final symbol size (implied unlatch, EDIFACT rest
+* encoded in ASCII), they are evaluated against the symbol sizes once the nodes are known.
+*/
+namespace Planner {
+
+	constexpr int MODE_COUNT = 6;
+	// the states of a node are the modes, then C40 and Text with 1 or 2 values pending in their triplet
+	constexpr int STATE_COUNT = MODE_COUNT + 4;
+	constexpr int NO_COST = std::numeric_limits<int>::max() / 2;
+	constexpr int MAX_BASE256_COUNT = 1555;
+
+	struct Node
+	{
+		int cost = NO_COST;
+		int prev = -1; // index of the previous node on the minimal path, pos * STATE_COUNT + state
+		int base256Start = 0; // first character of the current Base 256 segment
+	};
+
+	// Number of C40 and Text values of every character
+	struct ValueCounts
+	{
+		std::array<uint8_t, 256> c40;
+		std::array<uint8_t, 256> text;
+	};
+
+	static const ValueCounts& CharValueCounts()
 	{
-		try {
-			size_t count = buffer.length();
-			if (count == 0) {
-				return; //Already finished
+		static const ValueCounts counts = [] {
+			ValueCounts res;
+			std::string values;
+			for (int c = 0; c < 256; c++) {
+				res.c40[c] = narrow_cast<uint8_t>(C40Encoder::EncodeChar(c, values));
+				res.text[c] = narrow_cast<uint8_t>(DMTextEncoder::EncodeChar(c, values));
 			}
-			if (count == 1) {
-				//Only an unlatch at the end
-				int codewordCount = context.codewordCount();
-				auto symbolInfo = context.updateSymbolInfo(codewordCount);
-				int available = symbolInfo->dataCapacity() - codewordCount;
-				int remaining = context.remainingCharacters();
-				// The following two lines are a hack inspired by the 'fix' from https://sourceforge.net/p/barcode4j/svn/221/
-				if (remaining > available)
-					available = context.updateSymbolInfo(codewordCount+1)->dataCapacity() - codewordCount;
-				if (remaining <= available && available <= 2) {
-					return; //No unlatch
+			return res;
+		}();
+		return counts;
+	}
+
+	//! State of a C40 or Text node with phase values pending in the current triplet (0 to 2)
+	static constexpr int C40State(int mode, int phase)
+	{
+		return phase == 0 ? mode : MODE_COUNT + (mode == TEXT_ENCODATION ? 2 : 0) + phase - 1;
+	}
+
+	static constexpr int StateMode(int state)
+	{
+		return state < MODE_COUNT ? state : (state < MODE_COUNT + 2 ? C40_ENCODATION : TEXT_ENCODATION);
+	}
+
+	static constexpr int StatePhase(int state) { return state < MODE_COUNT ? 0 : (state - MODE_COUNT) % 2 + 1; }
+
+	static void Relax(std::vector<Node>& nodes, int from, int pos, int state, int cost, int base256Start = 0)
+	{
+		Node& node = nodes[pos * STATE_COUNT + state];
+		// of two Base 256 segments at the same cost, the one that started later needs its 2 bytes length field later
+		if (cost < node.cost || (state == BASE256_ENCODATION && cost == node.cost && base256Start > node.base256Start)) {
+			node = Node{cost, from, base256Start};
+		}
+	}
+
+	static void ComputeNodes(const std::string& msg, int begin, int end, std::vector<Node>& nodes)
+	{
+		const auto& counts = CharValueCounts();
+
+		nodes.assign((end + 1) * STATE_COUNT, Node());
+		nodes[begin * STATE_COUNT + ASCII_ENCODATION].cost = 0;
+
+		for (int pos = begin; pos <= end; pos++) {
+			const int index = pos * STATE_COUNT;
+
+			// 2 values left in the last triplet, completed with a Shift 1 (its codewords are already counted)
+			if (pos == end) {
+				for (int mode : {C40_ENCODATION, TEXT_ENCODATION}) {
+					Relax(nodes, index + C40State(mode, 2), pos, mode, nodes[index + C40State(mode, 2)].cost);
 				}
 			}
 
-			if (count > 4) {
-				throw std::invalid_argument("Count must not exceed 4");
+			// unlatch to ASCII (the EDIFACT unlatch takes a codeword of its own here), Base 256 ends by its length
+			for (int mode : {C40_ENCODATION, TEXT_ENCODATION, X12_ENCODATION, EDIFACT_ENCODATION}) {
+				Relax(nodes, index + mode, pos, ASCII_ENCODATION, nodes[index + mode].cost + 1);
 			}
-			int restChars = static_cast<int>(count - 1);
-			auto encoded = EncodeToCodewords(buffer, 0);
-			bool endOfSymbolReached = !context.hasMoreCharacters();
-			bool restInAscii = endOfSymbolReached && restChars <= 2;
-
-			if (restChars <= 2) {
-				int codewordCount = context.codewordCount();
-				auto symbolInfo = context.updateSymbolInfo(codewordCount + restChars);
-				int available = symbolInfo->dataCapacity() - codewordCount;
-				if (available >= 3) {
-					restInAscii = false;
-					context.updateSymbolInfo(codewordCount + Size(encoded));
-					//available = context.symbolInfo.dataCapacity - context.getCodewordCount();
+			Relax(nodes, index + BASE256_ENCODATION, pos, ASCII_ENCODATION, nodes[index + BASE256_ENCODATION].cost);
+
+			// latch from ASCII, the Base 256 latch comes with (at least) one length byte
+			const int asciiCost = nodes[index + ASCII_ENCODATION].cost;
+			for (int mode : {C40_ENCODATION, TEXT_ENCODATION, X12_ENCODATION, EDIFACT_ENCODATION}) {
+				Relax(nodes, index + ASCII_ENCODATION, pos, mode, asciiCost + 1);
+			}
+			Relax(nodes, index + ASCII_ENCODATION, pos, BASE256_ENCODATION, asciiCost + 2, pos);
+
+			if (pos == end) {
+				break;
+			}
+
+			const int c = msg[pos] & 0xff;
+
+			if (const int cost = nodes[index + ASCII_ENCODATION].cost; cost < NO_COST) {
+				if (pos + 1 < end && IsDigit(c) && IsDigit(msg[pos + 1])) {
+					Relax(nodes, index + ASCII_ENCODATION, pos + 2, ASCII_ENCODATION, cost + 1);
 				}
+				Relax(nodes, index + ASCII_ENCODATION, pos + 1, ASCII_ENCODATION, cost + (IsExtendedASCII(c) ? 2 : 1));
 			}
 
-			if (restInAscii) {
-				context.resetSymbolInfo();
-				context.setCurrentPos(context.currentPos() - restChars);
+			// C40 and Text: one character, its values may start new triplets or complete the pending one
+			for (int mode : {C40_ENCODATION, TEXT_ENCODATION}) {
+				const int values = (mode == C40_ENCODATION ? counts.c40 : counts.text)[c];
+				for (int phase = 0; phase < 3; phase++) {
+					const int state = C40State(mode, phase);
+					const int cost = nodes[index + state].cost;
+					if (cost >= NO_COST) {
+						continue;
+					}
+					const int triplets = (phase + values + 2) / 3 - (phase + 2) / 3;
+					Relax(nodes, index + state, pos + 1, C40State(mode, (phase + values) % 3), cost + triplets * 2);
+				}
 			}
-			else {
-				for (uint8_t cw : encoded) {
-					context.addCodeword(cw);
+
+			if (const int cost = nodes[index + X12_ENCODATION].cost; cost < NO_COST) {
+				if (pos + 3 <= end && IsNativeX12(c) && IsNativeX12(msg[pos + 1] & 0xff) && IsNativeX12(msg[pos + 2] & 0xff)) {
+					Relax(nodes, index + X12_ENCODATION, pos + 3, X12_ENCODATION, cost + 2);
 				}
 			}
-		}
-		catch (...) {
-			context.setNewEncoding(ASCII_ENCODATION);
-			throw;
-		}
-		context.setNewEncoding(ASCII_ENCODATION);
-	}
 
-	static void EncodeEdifact(EncoderContext& context)
-	{
-		//step F
-		std::string buffer;
-		while (context.hasMoreCharacters()) {
-			int c = context.currentChar();
-			EncodeChar(c, buffer);
-			context.setCurrentPos(context.currentPos() + 1);
-
-			if (buffer.length() >= 4) {
-				auto codewords = EncodeToCodewords(buffer, 0);
-				for (uint8_t cw : codewords) {
-					context.addCodeword(cw);
+			// EDIFACT: 4 characters in 3 codewords, or 1 to 3 characters followed by the unlatch
+			if (const int cost = nodes[index + EDIFACT_ENCODATION].cost; cost < NO_COST) {
+				for (int count = 1; count <= 4 && pos + count <= end && IsNativeEDIFACT(msg[pos + count - 1] & 0xff); count++) {
+					if (count == 4) {
+						Relax(nodes, index + EDIFACT_ENCODATION, pos + 4, EDIFACT_ENCODATION, cost + 3);
+					} else {
+						Relax(nodes, index + EDIFACT_ENCODATION, pos + count, ASCII_ENCODATION, cost + (count == 1 ? 2 : 3));
+					}
 				}
-				buffer.erase(0, 4);
+			}
 
-				int newMode = LookAheadTest(context.message(), context.currentPos(), EDIFACT_ENCODATION);
-				if (newMode != EDIFACT_ENCODATION) {
-					// Return to ASCII encodation, which will actually handle latch to new mode
-					context.setNewEncoding(ASCII_ENCODATION);
-					break;
+			if (const Node& node = nodes[index + BASE256_ENCODATION]; node.cost < NO_COST) {
+				const int count = pos + 1 - node.base256Start;
+				if (count <= MAX_BASE256_COUNT) {
+					Relax(nodes, index + BASE256_ENCODATION, pos + 1, BASE256_ENCODATION, node.cost + 1 + (count == 250),
+						  node.base256Start);
 				}
 			}
 		}
-		buffer.push_back(31); //Unlatch
-		HandleEOD(context, buffer);
 	}
 
-} // EdifactEncoder
+	enum class Ending
+	{
+		Normal,
+		AsciiRest, // the last characters are encoded in ASCII without unlatch, the symbol ends right after them
+	};
 
-namespace Base256Encoder {
+	struct Plan
+	{
+		int node = -1; // last node of the path
+		Ending ending = Ending::Normal;
+		const SymbolInfo* symbolInfo = nullptr;
+	};
 
-	static int Randomize255State(int ch, int codewordPosition)
+	/**
+	* Appends the codewords of the minimal path ending at plan.node, and the ending/padding of the symbol.
+	* Returns false if the symbol of the plan cannot hold them (see the EDIFACT end of segment rule below).
+	*/
+	static bool EmitCodewords(const std::string& msg, int end, const std::vector<Node>& nodes, Plan plan, ByteArray& codewords)
 	{
-		int pseudoRandom = ((149 * codewordPosition) % 255) + 1;
-		int tempVariable = ch + pseudoRandom;
-		if (tempVariable <= 255) {
-			return tempVariable;
-		}
-		else {
-			return tempVariable - 256;
+		std::vector<int> path;
+		for (int i = plan.node; i >= 0; i = nodes[i].prev) {
+			path.push_back(i);
+		}
+		std::reverse(path.begin(), path.end());
+
+		// the decoder only reads an EDIFACT group if 3 codewords remain in the symbol, otherwise it switches to ASCII
+		int lastEdifactGroup = -1;
+		std::string values;
+		std::string tripletValues; // C40/Text values of the pending triplet(s)
+		std::string base256;
+
+		for (size_t i = 1; i < path.size(); i++) {
+			const int fromPos = path[i - 1] / STATE_COUNT;
+			const int fromMode = StateMode(path[i - 1] % STATE_COUNT);
+			const int toPos = path[i] / STATE_COUNT;
+			const int toMode = StateMode(path[i] % STATE_COUNT);
+
+			if (fromMode == BASE256_ENCODATION && toMode != BASE256_ENCODATION) {
+				Base256Encoder::EncodeSegment(codewords, base256);
+				base256.clear();
+			}
+
+			values.clear();
+			switch (fromMode) {
+			case ASCII_ENCODATION:
+				if (toMode != ASCII_ENCODATION) {
+					codewords.push_back(LATCHES[toMode]);
+				} else if (toPos - fromPos == 2) {
+					codewords.push_back(ASCIIEncoder::EncodeASCIIDigits(msg[fromPos], msg[fromPos + 1]));
+				} else {
+					ASCIIEncoder::EncodeChar(msg[fromPos] & 0xff, codewords);
+				}
+				break;
+			case C40_ENCODATION:
+			case TEXT_ENCODATION:
+				if (toMode == ASCII_ENCODATION) {
+					codewords.push_back(C40_UNLATCH);
+					break;
+				}
+				// the values pile up until the triplet boundary, the end of the data completes the last one with a Shift 1
+				if (toPos == fromPos) {
+					tripletValues.push_back('\0');
+				} else if (fromMode == C40_ENCODATION) {
+					C40Encoder::EncodeChar(msg[fromPos] & 0xff, tripletValues);
+				} else {
+					DMTextEncoder::EncodeChar(msg[fromPos] & 0xff, tripletValues);
+				}
+				if (StatePhase(path[i] % STATE_COUNT) == 0) {
+					for (int p = 0; p < Size(tripletValues); p += 3) {
+						C40Encoder::EncodeToCodewords(codewords, tripletValues, p);
+					}
+					tripletValues.clear();
+				}
+				break;
+			case X12_ENCODATION:
+				if (toMode == ASCII_ENCODATION) {
+					codewords.push_back(X12_UNLATCH);
+					break;
+				}
+				for (int p = fromPos; p < toPos; p++) {
+					X12Encoder::EncodeChar(msg[p] & 0xff, values);
+				}
+				C40Encoder::EncodeToCodewords(codewords, values, 0);
+				break;
+			case EDIFACT_ENCODATION:
+				lastEdifactGroup = Size(codewords);
+				for (int p = fromPos; p < toPos; p++) {
+					EdifactEncoder::EncodeChar(msg[p] & 0xff, values);
+				}
+				if (toMode == ASCII_ENCODATION) {
+					values.push_back(EDIFACT_UNLATCH);
+				}
+				EdifactEncoder::EncodeToCodewords(codewords, values);
+				break;
+			case BASE256_ENCODATION:
+				if (toMode == BASE256_ENCODATION) {
+					base256.push_back(msg[fromPos]);
+				}
+				break;
+			}
 		}
-	}
 
-	static void EncodeBase256(EncoderContext& context)
-	{
-		std::string buffer;
-		buffer.push_back('\0'); //Initialize length field
-		while (context.hasMoreCharacters()) {
-			int c = context.currentChar();
-			buffer.push_back(c);
+		const int lastPos = path.back() / STATE_COUNT;
+		const int lastMode = StateMode(path.back() % STATE_COUNT);
+		const int capacity = plan.symbolInfo->dataCapacity();
 
-			context.setCurrentPos(context.currentPos() + 1);
+		if (lastMode == BASE256_ENCODATION) {
+			Base256Encoder::EncodeSegment(codewords, base256);
+		}
 
-			int newMode = LookAheadTest(context.message(), context.currentPos(), BASE256_ENCODATION);
-			if (newMode != BASE256_ENCODATION) {
-				// Return to ASCII encodation, which will actually handle latch to new mode
-				context.setNewEncoding(ASCII_ENCODATION);
-				break;
+		if (plan.ending == Ending::AsciiRest) {
+			// no unlatch, the C40/Text/X12 segment ends with less than 2 codewords left in the symbol,
+			// the EDIFACT one with less than 3
+			if (lastPos + 1 < end && IsDigit(msg[lastPos]) && IsDigit(msg[lastPos + 1])) {
+				codewords.push_back(ASCIIEncoder::EncodeASCIIDigits(msg[lastPos], msg[lastPos + 1]));
+			} else {
+				for (int p = lastPos; p < end; p++) {
+					ASCIIEncoder::EncodeChar(msg[p] & 0xff, codewords);
+				}
 			}
 		}
-		int dataCount = Size(buffer) - 1;
-		int lengthFieldSize = 1;
-		int currentSize = context.codewordCount() + dataCount + lengthFieldSize;
-		auto symbolInfo = context.updateSymbolInfo(currentSize);
-		bool mustPad = (symbolInfo->dataCapacity() - currentSize) > 0;
-		if (context.hasMoreCharacters() || mustPad) {
-			if (dataCount <= 249) {
-				buffer.at(0) = (char)dataCount;
-			}
-			else if (dataCount <= 1555) {
-				buffer.at(0) = (char)((dataCount / 250) + 249);
-				buffer.insert(1, 1, (char)(dataCount % 250));
-			}
-			else {
-				throw std::invalid_argument("Message length not in valid ranges: " + std::to_string(dataCount));
+		else if (Size(codewords) < capacity) {
+			// unlatch before the padding, unless the segment ends by itself
+			switch (lastMode) {
+			case C40_ENCODATION:
+			case TEXT_ENCODATION:
+			case X12_ENCODATION: codewords.push_back(C40_UNLATCH); break;
+			case EDIFACT_ENCODATION:
+				if (capacity - Size(codewords) >= 3) {
+					lastEdifactGroup = Size(codewords);
+					EdifactEncoder::EncodeToCodewords(codewords, std::string(1, EDIFACT_UNLATCH));
+				}
+				break;
 			}
 		}
-		for (char c : buffer) {
-			context.addCodeword(Randomize255State(c, context.codewordCount() + 1));
+
+		if (Size(codewords) > capacity || (lastEdifactGroup >= 0 && capacity - lastEdifactGroup < 3)) {
+			return false;
+		}
+
+		//Padding
+		if (Size(codewords) < capacity) {
+			codewords.push_back(PAD);
+		}
+		while (Size(codewords) < capacity) {
+			codewords.push_back(Randomize253State(PAD, Size(codewords) + 1));
 		}
+		return true;
 	}
 
-} // Base256Encoder
+} // Planner
 
 ByteArray Encode(const std::wstring& msg)
 {
@@ -846,8 +641,7 @@ ByteArray Encode(const std::wstring& msg)
 }
 
 /**
-* Performs message encoding of a DataMatrix message using the algorithm described in annex P
-* of ISO/IEC 16022:2000(E).
+* Performs message encoding of a DataMatrix message, with the minimal number of codewords (see Planner above).
 *
 * @param msg     the message
 * @param shape   requested shape. May be {@code SymbolShapeHint.FORCE_NONE},
@@ -858,67 +652,95 @@ ByteArray Encode(const std::wstring& msg)
 */
 ByteArray Encode(const std::wstring& msg, CharacterSet charset, SymbolShape shape, int minWidth, int minHeight, int maxWidth, int maxHeight)
 {
-	//the codewords 0..255 are encoded as Unicode characters
-	//Encoder[] encoders = {
-	//	new ASCIIEncoder(), new C40Encoder(), new TextEncoder(),
-	//	new X12Encoder(), new EdifactEncoder(),  new Base256Encoder()
-	//};
+	using namespace Planner;
 
 	if (charset == CharacterSet::Unknown) {
 		charset = CharacterSet::ISO8859_1;
 	}
 
-	EncoderContext context(TextEncoder::FromUnicode(msg, charset));
-	context.setSymbolShape(shape);
-	context.setSizeConstraints(minWidth, minHeight, maxWidth, maxHeight);
+	const std::string bytes = TextEncoder::FromUnicode(msg, charset);
+	ByteArray header;
+	int begin = 0;
+	int end = Size(bytes);
 
 	constexpr std::wstring_view MACRO_05_HEADER = L"[)>\x1E""05\x1D";
 	constexpr std::wstring_view MACRO_06_HEADER = L"[)>\x1E""06\x1D";
 	constexpr std::wstring_view MACRO_TRAILER = L"\x1E\x04";
 
 	if (msg.starts_with(MACRO_05_HEADER) && msg.ends_with(MACRO_TRAILER)) {
-		context.addCodeword(MACRO_05);
-		context.setSkipAtEnd(2);
-		context.setCurrentPos(Size(MACRO_05_HEADER));
+		header.push_back(MACRO_05);
+		begin = Size(MACRO_05_HEADER);
+		end -= Size(MACRO_TRAILER);
 	}
 	else if (msg.starts_with(MACRO_06_HEADER) && msg.ends_with(MACRO_TRAILER)) {
-		context.addCodeword(MACRO_06);
-		context.setSkipAtEnd(2);
-		context.setCurrentPos(Size(MACRO_06_HEADER));
+		header.push_back(MACRO_06);
+		begin = Size(MACRO_06_HEADER);
+		end -= Size(MACRO_TRAILER);
 	}
 
-	int encodingMode = ASCII_ENCODATION; //Default mode
-	while (context.hasMoreCharacters()) {
-		switch (encodingMode) {
-		case ASCII_ENCODATION:   ASCIIEncoder::EncodeASCII(context);     break;
-		case C40_ENCODATION:     C40Encoder::EncodeC40(context);         break;
-		case TEXT_ENCODATION:    DMTextEncoder::EncodeText(context);     break;
-		case X12_ENCODATION:     X12Encoder::EncodeX12(context);         break;
-		case EDIFACT_ENCODATION: EdifactEncoder::EncodeEdifact(context); break;
-		case BASE256_ENCODATION: Base256Encoder::EncodeBase256(context); break;
+	std::vector<Node> nodes;
+	ComputeNodes(bytes, begin, end, nodes);
+
+	// the candidate endings, with the smallest symbol each of them fits in
+	std::vector<Plan> plans;
+	auto addPlan = [&](int pos, int mode, Ending ending, int restCodewords) {
+		if (pos < begin || nodes[pos * STATE_COUNT + mode].cost >= NO_COST) {
+			return;
 		}
-		if (context.newEncoding() >= 0) {
-			encodingMode = context.newEncoding();
-			context.clearNewEncoding();
+		const int length = Size(header) + nodes[pos * STATE_COUNT + mode].cost;
+		const SymbolInfo* symbolInfo = SymbolInfo::Lookup(length + restCodewords, shape, minWidth, minHeight, maxWidth, maxHeight);
+		if (symbolInfo == nullptr) {
+			return;
 		}
+		// the implied unlatch needs the symbol to end right after the rest
+		if (ending == Ending::AsciiRest && symbolInfo->dataCapacity() - length > (mode == EDIFACT_ENCODATION ? 2 : 1)) {
+			return;
+		}
+		plans.push_back(Plan{pos * STATE_COUNT + mode, ending, symbolInfo});
+	};
+
+	for (int mode = 0; mode < MODE_COUNT; mode++) {
+		addPlan(end, mode, Ending::Normal, 0);
 	}
-	int len = context.codewordCount();
-	auto symbolInfo = context.updateSymbolInfo(len);
-	int capacity = symbolInfo->dataCapacity();
-	if (len < capacity) {
-		if (encodingMode != ASCII_ENCODATION && encodingMode != BASE256_ENCODATION && encodingMode != EDIFACT_ENCODATION) {
-			context.addCodeword('\xfe'); //Unlatch (254)
+	if (end > begin && !IsExtendedASCII(bytes[end - 1] & 0xff)) {
+		for (int mode : {C40_ENCODATION, TEXT_ENCODATION, X12_ENCODATION}) {
+			addPlan(end - 1, mode, Ending::AsciiRest, 1);
 		}
 	}
-	//Padding
-	if (context.codewordCount() < capacity) {
-		context.addCodeword(PAD);
+	for (int count : {1, 2}) {
+		int rest = 0;
+		for (int p = end - count; p >= 0 && p < end; p++) {
+			rest += IsExtendedASCII(bytes[p] & 0xff) ? 2 : 1;
+		}
+		if (count == 2 && end >= 2 && IsDigit(bytes[end - 2]) && IsDigit(bytes[end - 1])) {
+			rest = 1;
+		}
+		addPlan(end - count, EDIFACT_ENCODATION, Ending::AsciiRest, rest);
 	}
-	while (context.codewordCount() < capacity) {
-		context.addCodeword(Randomize253State(PAD, context.codewordCount() + 1));
+
+	std::stable_sort(plans.begin(), plans.end(),
+					 [](const Plan& a, const Plan& b) { return a.symbolInfo->dataCapacity() < b.symbolInfo->dataCapacity(); });
+
+	for (Plan plan : plans) {
+		ByteArray codewords = header;
+		codewords.reserve(plan.symbolInfo->dataCapacity());
+		if (EmitCodewords(bytes, end, nodes, plan, codewords)) {
+			return codewords;
+		}
+		// a last EDIFACT group too close to the end of the symbol, a larger one is needed
+		if (plan.ending == Ending::Normal) {
+			while ((plan.symbolInfo = SymbolInfo::Lookup(plan.symbolInfo->dataCapacity() + 1, shape, minWidth, minHeight,
+														 maxWidth, maxHeight)) != nullptr) {
+				codewords = header;
+				if (EmitCodewords(bytes, end, nodes, plan, codewords)) {
+					return codewords;
+				}
+			}
+		}
 	}
 
-	return context.codewords();
+	throw std::invalid_argument("Can't find a symbol arrangement that matches the message. Data codewords: " +
+								std::to_string(Size(header) + nodes[end * STATE_COUNT + ASCII_ENCODATION].cost));
 }
 
 } // namespace ZXing::DataMatrix
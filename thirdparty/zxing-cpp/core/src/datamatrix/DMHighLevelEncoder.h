@@ -19,8 +19,8 @@ namespace DataMatrix {
 enum class SymbolShape;
 
 /**
-* DataMatrix ECC 200 data encoder following the algorithm described in ISO/IEC 16022:200(E) in
-* annex S.
+* DataMatrix ECC 200 data encoder, choosing the encodation modes (ISO/IEC 16022:2006, 5.2) that give
+* the fewest codewords.
 */
 ByteArray Encode(const std::wstring& msg);
 ByteArray Encode(const std::wstring& msg, CharacterSet charset, SymbolShape shape, int minWidth, int minHeight, int maxWidth, int maxHeight);
@@ -21,6 +21,7 @@ public:
 	using RowReader::RowReader;
 
 	BarcodeData decodePattern(int rowNumber, PatternView& next, std::unique_ptr<DecodingState>&) const override;
+	bool usesDecodingState() const override { return true; } // clock tracks found on the previous rows
 };
 
 } // namespace ZXing::OneD
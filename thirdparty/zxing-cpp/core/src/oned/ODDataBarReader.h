@@ -20,6 +20,7 @@ public:
 	using RowReader::RowReader;
 
 	BarcodeData decodePattern(int rowNumber, PatternView& next, std::unique_ptr<DecodingState>& state) const override;
+	bool usesDecodingState() const override { return true; }
 };
 
 } // namespace ZXing::OneD
@@ -20,8 +20,14 @@
 #include "ODITFReader.h"
 #include "ODMultiUPCEANReader.h"
 #include "BarcodeData.h"
+#include "BarcodeIndex.h"
 
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
 #include <utility>
 
 #ifdef PRINT_DEBUG
@@ -62,6 +68,32 @@ Reader::Reader(const ReaderOptions& opts) : ZXing::Reader(opts)
 
 Reader::~Reader() = default;
 
+// Symbols found on one row by the readers that don't use a DecodingState, in the order a sequential scan finds them.
+struct RowScan
+{
+	struct Hit
+	{
+		bool upsideDown;
+		size_t reader;
+		BarcodeData result;
+	};
+
+	PatternRow bars;
+	bool valid = false;
+	std::vector<Hit> hits;
+	std::exception_ptr error;
+};
+
+// Tall tryHarder scans are split over several threads, each thread scanning at least MIN_ROWS_PER_THREAD rows.
+static int RowScanThreads(int rows)
+{
+	constexpr int MIN_ROWS_PER_THREAD = 64;
+	constexpr int MAX_THREADS = 8;
+
+	int cores = narrow_cast<int>(std::thread::hardware_concurrency());
+	return std::clamp(rows / MIN_ROWS_PER_THREAD, 1, std::clamp(cores, 1, MAX_THREADS));
+}
+
 /**
 * We're going to examine rows from the middle outward, searching alternately above and below the
 * middle, and farther out each time. rowStep is the number of rows between each successive
@@ -70,11 +102,16 @@ Reader::~Reader() = default;
 * rowStep is bigger as the image is taller, but is always at least 1. We've somewhat arbitrarily
 * decided that moving up and down by about 1/16 of the image is pretty good; we try more of the
 * image if "trying harder".
+*
+* When trying harder on a tall image, the rows are scanned by several threads. The results are then merged in the
+* scan order above, and the readers using a DecodingState (stacked DataBar) are run during that sequential merge,
+* so the outcome is the same as for a single threaded scan.
 */
 BarcodesData DoDecode(const std::vector<std::unique_ptr<RowReader>>& readers, const BinaryBitmap& image, bool tryHarder,
 						 bool rotate, bool isPure, int maxSymbols, int minLineCount, bool returnErrors)
 {
 	BarcodesData res;
+	BarcodeIndex index; // positions of res
 
 	std::vector<std::unique_ptr<RowReader::DecodingState>> decodingState(readers.size());
 
@@ -97,6 +134,17 @@ BarcodesData DoDecode(const std::vector<std::unique_ptr<RowReader>>& readers, co
 		minLineCount = std::min(minLineCount, height);
 	std::vector<int> checkRows;
 
+	// Scanning from the middle out, stop once we run off the top or bottom
+	std::vector<int> scanRows;
+	for (int i = 0; i < maxLines; i++) {
+		int rowStepsAboveOrBelow = (i + 1) / 2;
+		bool isAbove = (i & 0x01) == 0; // i.e. is x even?
+		int rowNumber = middle + rowStep * (isAbove ? rowStepsAboveOrBelow : -rowStepsAboveOrBelow);
+		if (rowNumber < 0 || rowNumber >= height)
+			break;
+		scanRows.push_back(rowNumber);
+	}
+
 	PatternRow bars;
 	bars.reserve(128); // e.g. EAN-13 has 59 bars/spaces
 
@@ -104,30 +152,83 @@ BarcodesData DoDecode(const std::vector<std::unique_ptr<RowReader>>& readers, co
 	BitMatrix dbg(width, height);
 #endif
 
-	for (int i = 0; i < maxLines; i++) {
-
-		// Scanning from the middle out. Determine which row we're looking at next:
-		int rowStepsAboveOrBelow = (i + 1) / 2;
-		bool isAbove = (i & 0x01) == 0; // i.e. is x even?
-		int rowNumber = middle + rowStep * (isAbove ? rowStepsAboveOrBelow : -rowStepsAboveOrBelow);
-		bool isCheckRow = false;
-		if (rowNumber < 0 || rowNumber >= height) {
-			// Oops, if we run off the top or bottom, stop
-			break;
+	// Run reader r over a pattern row, onResult returns true to stop the scan
+	auto decodeRow = [&](size_t r, int rowNumber, const PatternRow& bars, bool upsideDown,
+						 std::unique_ptr<RowReader::DecodingState>& state, auto&& onResult) {
+		PatternView next(bars);
+		do {
+			BarcodeData result = readers[r]->decodePattern(rowNumber, next, state);
+			if (result.isValid() || (returnErrors && result.error)) {
+				result.lineCount++;
+				if (upsideDown) {
+					// update position (flip horizontally).
+					for (auto& p : result.position) {
+						p = {width - p.x - 1, p.y};
+					}
+				}
+				if (rotate) {
+					for (auto& p : result.position) {
+						p = {p.y, width - p.x - 1};
+					}
+				}
+				if (onResult(std::move(result)))
+					return true;
+			}
+			// make sure we make progress and we start the next try on a bar
+			next.shift(2 - (next.index() % 2));
+			next.extend();
+		} while (tryHarder && next.size());
+		return false;
+	};
+
+	// Merge a result into res, returns true once maxSymbols have been found
+	auto addResult = [&](BarcodeData&& result, int rowNumber, bool isCheckRow) {
+		// check if we know this code already
+		for (int i : index.duplicateCandidates(result)) {
+			auto& other = res[i];
+			if (result == other) {
+				auto oldPosition = other.position;
+				// merge the position information
+				auto dTop = maxAbsComponent(other.position.topLeft() - result.position.topLeft());
+				auto dBot = maxAbsComponent(other.position.bottomLeft() - result.position.topLeft());
+				if (dTop < dBot || (dTop == dBot && rotate ^ (sumAbsComponent(other.position[0]) >
+															  sumAbsComponent(result.position[0])))) {
+					other.position[0] = result.position[0];
+					other.position[1] = result.position[1];
+				} else {
+					other.position[2] = result.position[2];
+					other.position[3] = result.position[3];
+				}
+				other.lineCount++;
+				index.update(i, oldPosition, other.position);
+				// clear the result, so we don't insert it again below
+				result = BarcodeData();
+				break;
+			}
 		}
 
-		// See if we have additional check rows (see below) to process
-		if (checkRows.size()) {
-			--i;
-			rowNumber = checkRows.back();
-			checkRows.pop_back();
-			isCheckRow = true;
-			if (rowNumber < 0 || rowNumber >= height)
-				continue;
+		if (result.format != BarcodeFormat::None) {
+			index.insert(Size(res), result.position);
+			res.push_back(std::move(result));
+
+			// if we found a valid code we have not seen before but a minLineCount > 1,
+			// add additional check rows above and below the current one
+			if (!isCheckRow && minLineCount > 1 && rowStep > 1) {
+				checkRows = {rowNumber - 1, rowNumber + 1};
+				if (rowStep > 2)
+					checkRows.insert(checkRows.end(), {rowNumber - 2, rowNumber + 2});
+			}
 		}
 
+		return maxSymbols && Reduce(res, 0, [&](int s, const BarcodeData& r) {
+								 return s + (r.lineCount >= minLineCount);
+							 }) == maxSymbols;
+	};
+
+	// Scan row i of scanRows (or one of its check rows) with all readers, returns true to stop the scan
+	auto scanRow = [&](int i, int rowNumber, bool isCheckRow) {
 		if (!image.getPatternRow(rowNumber, rotate ? 90 : 0, bars))
-			continue;
+			return false;
 
 #ifdef PRINT_DEBUG
 		bool val = false;
@@ -158,67 +259,143 @@ BarcodesData DoDecode(const std::vector<std::unique_ptr<RowReader>>& readers, co
 				if (isPure && i && !decodingState[r])
 					continue;
 
-				PatternView next(bars);
-				do {
-					BarcodeData result = readers[r]->decodePattern(rowNumber, next, decodingState[r]);
-					if (result.isValid() || (returnErrors && result.error)) {
-						result.lineCount++;
-						if (upsideDown) {
-							// update position (flip horizontally).
-							for (auto& p : result.position) {
-								p = {width - p.x - 1, p.y};
-							}
-						}
-						if (rotate) {
-							for (auto& p : result.position) {
-								p = {p.y, width - p.x - 1};
-							}
-						}
-
-						// check if we know this code already
-						for (auto& other : res) {
-							if (result == other) {
-								// merge the position information
-								auto dTop = maxAbsComponent(other.position.topLeft() - result.position.topLeft());
-								auto dBot = maxAbsComponent(other.position.bottomLeft() - result.position.topLeft());
-								if (dTop < dBot || (dTop == dBot && rotate ^ (sumAbsComponent(other.position[0]) >
-																			  sumAbsComponent(result.position[0])))) {
-									other.position[0] = result.position[0];
-									other.position[1] = result.position[1];
-								} else {
-									other.position[2] = result.position[2];
-									other.position[3] = result.position[3];
-								}
-								other.lineCount++;
-								// clear the result, so we don't insert it again below
-								result = BarcodeData();
-								break;
-							}
-						}
-
-						if (result.format != BarcodeFormat::None) {
-							res.push_back(std::move(result));
-
-							// if we found a valid code we have not seen before but a minLineCount > 1,
-							// add additional check rows above and below the current one
-							if (!isCheckRow && minLineCount > 1 && rowStep > 1) {
-								checkRows = {rowNumber - 1, rowNumber + 1};
-								if (rowStep > 2)
-									checkRows.insert(checkRows.end(), {rowNumber - 2, rowNumber + 2});
-							}
-						}
-
-						if (maxSymbols && Reduce(res, 0, [&](int s, const BarcodeData& r) {
-											  return s + (r.lineCount >= minLineCount);
-										  }) == maxSymbols) {
-							goto out;
-						}
+				if (decodeRow(r, rowNumber, bars, upsideDown, decodingState[r],
+							  [&](BarcodeData&& result) { return addResult(std::move(result), rowNumber, isCheckRow); }))
+					return true;
+			}
+		}
+		return false;
+	};
+
+	// Check rows of row i are only scanned if there is a next row, like in the original Java implementation
+	auto scanCheckRows = [&](int i) {
+		while (checkRows.size() && i + 1 < Size(scanRows)) {
+			int rowNumber = checkRows.back();
+			checkRows.pop_back();
+			if (rowNumber < 0 || rowNumber >= height)
+				continue;
+			if (scanRow(i, rowNumber, true))
+				return true;
+		}
+		return false;
+	};
+
+	int threads = 1;
+#ifndef PRINT_DEBUG
+	if (tryHarder && !isPure)
+		threads = RowScanThreads(Size(scanRows));
+#endif
+
+	if (threads == 1) {
+		for (int i = 0; i < Size(scanRows); i++)
+			if (scanRow(i, scanRows[i], false) || scanCheckRows(i))
+				goto out;
+	} else {
+		constexpr int CHUNK_SIZE = 16;
+
+		std::vector<RowScan> scans(scanRows.size());
+		std::vector<uint8_t> scanned(scanRows.size(), false); // guarded by mutex
+		std::atomic<int> nextChunk = 0;
+		std::atomic<bool> cancel = false;
+		std::mutex mutex;
+		std::condition_variable cv;
+
+		// pre-scan a row with all stateless readers, keeping the forward pattern row for the merge
+		auto prescanRow = [&](int rowNumber, RowScan& scan) {
+			try {
+				std::unique_ptr<RowReader::DecodingState> noState;
+				scan.valid = image.getPatternRow(rowNumber, rotate ? 90 : 0, scan.bars);
+				if (!scan.valid)
+					return;
+				for (bool upsideDown : {false, true}) {
+					if (upsideDown)
+						std::reverse(scan.bars.begin(), scan.bars.end());
+					for (size_t r = 0; r < readers.size(); ++r)
+						if (!readers[r]->usesDecodingState())
+							decodeRow(r, rowNumber, scan.bars, upsideDown, noState, [&](BarcodeData&& result) {
+								scan.hits.push_back({upsideDown, r, std::move(result)});
+								return false;
+							});
+				}
+				std::reverse(scan.bars.begin(), scan.bars.end());
+			} catch (...) {
+				scan.error = std::current_exception();
+			}
+		};
+
+		// returns false once all rows have been handed out
+		auto scanChunk = [&]() {
+			int begin = nextChunk.fetch_add(CHUNK_SIZE);
+			if (cancel || begin >= Size(scanRows))
+				return false;
+			int end = std::min(begin + CHUNK_SIZE, Size(scanRows));
+			for (int j = begin; j < end; ++j)
+				prescanRow(scanRows[j], scans[j]);
+			{
+				std::lock_guard lock(mutex);
+				std::fill(scanned.begin() + begin, scanned.begin() + end, true);
+			}
+			cv.notify_all();
+			return true;
+		};
+
+		// replay a pre-scanned row in the sequential order, running the stateful readers in between
+		auto mergeRow = [&](int rowNumber, RowScan& scan) {
+			if (scan.error)
+				std::rethrow_exception(scan.error);
+			if (!scan.valid)
+				return false;
+			auto hit = scan.hits.begin();
+			for (bool upsideDown : {false, true}) {
+				if (upsideDown)
+					std::reverse(scan.bars.begin(), scan.bars.end());
+				for (size_t r = 0; r < readers.size(); ++r) {
+					if (readers[r]->usesDecodingState()) {
+						if (decodeRow(r, rowNumber, scan.bars, upsideDown, decodingState[r],
+									  [&](BarcodeData&& result) { return addResult(std::move(result), rowNumber, false); }))
+							return true;
+					} else {
+						for (; hit != scan.hits.end() && hit->upsideDown == upsideDown && hit->reader == r; ++hit)
+							if (addResult(std::move(hit->result), rowNumber, false))
+								return true;
 					}
-					// make sure we make progress and we start the next try on a bar
-					next.shift(2 - (next.index() % 2));
-					next.extend();
-				} while (tryHarder && next.size());
+				}
+			}
+			return false;
+		};
+
+		std::vector<std::thread> workers;
+		struct Joiner
+		{
+			std::vector<std::thread>& workers;
+			std::atomic<bool>& cancel;
+			~Joiner()
+			{
+				cancel = true;
+				for (auto& t : workers)
+					t.join();
 			}
+		} joiner{workers, cancel};
+
+		for (int t = 1; t < threads; ++t)
+			workers.emplace_back([&]() { while (scanChunk()) {} });
+
+		for (int i = 0; i < Size(scanRows); i++) {
+			// help scanning while waiting for row i
+			std::unique_lock lock(mutex);
+			while (!scanned[i]) {
+				lock.unlock();
+				bool busy = scanChunk();
+				lock.lock();
+				if (!busy)
+					cv.wait(lock, [&]() { return bool(scanned[i]); });
+			}
+			lock.unlock();
+
+			bool done = mergeRow(scanRows[i], scans[i]) || scanCheckRows(i);
+			scans[i] = {};
+			if (done)
+				break;
 		}
 	}
 
@@ -227,10 +404,14 @@ out:
 	std::erase_if(res, [&](auto&& r) { return r.lineCount < minLineCount; });
 
 	// if symbols overlap, remove the one with a lower line count
-	for (auto a = res.begin(); a != res.end(); ++a)
-		for (auto b = std::next(a); b != res.end(); ++b)
-			if (HaveIntersectingBoundingBoxes(a->position, b->position))
-				*(a->lineCount < b->lineCount ? a : b) = BarcodeData();
+	index = BarcodeIndex();
+	for (int i = 0; i < Size(res); ++i)
+		index.insert(i, res[i].position);
+	for (int a = 0; a < Size(res); ++a)
+		for (int b : index.overlapCandidates(res[a].position))
+			if (b > a && res[a].format != BarcodeFormat::None && res[b].format != BarcodeFormat::None
+				&& HaveIntersectingBoundingBoxes(res[a].position, res[b].position))
+				(res[a].lineCount < res[b].lineCount ? res[a] : res[b]) = BarcodeData();
 
 	std::erase_if(res, [](auto&& r) { return r.format == BarcodeFormat::None; });
 
@@ -66,6 +66,13 @@ public:
 
 	virtual BarcodeData decodePattern(int rowNumber, PatternView& next, std::unique_ptr<DecodingState>& state) const = 0;
 
+	/**
+	 * Whether decodePattern() carries information from one row to the next in its DecodingState (stacked symbols,
+	 * DX film edge clock tracks).
+	 * Readers that don't can be run on several rows concurrently.
+	 */
+	virtual bool usesDecodingState() const { return false; }
+
 	/**
 	 * Determines how closely a set of observed counts of runs of black/white values matches a given
 	 * target pattern. This is reported as the ratio of the total variance from the expected pattern
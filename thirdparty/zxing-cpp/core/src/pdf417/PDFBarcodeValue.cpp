@@ -17,7 +17,11 @@ namespace Pdf417 {
 void
 BarcodeValue::setValue(int value)
 {
-	_values[value] += 1;
+	auto it = std::lower_bound(_values.begin(), _values.end(), value, [](auto& l, int r) { return l.first < r; });
+	if (it != _values.end() && it->first == value)
+		it->second += 1;
+	else
+		_values.emplace(it, value, 1);
 }
 
 /**
@@ -40,8 +44,8 @@ BarcodeValue::value() const
 int
 BarcodeValue::confidence(int value) const
 {
-	auto it = _values.find(value);
-	return it != _values.end() ? it->second : 0;
+	auto it = std::lower_bound(_values.begin(), _values.end(), value, [](auto& l, int r) { return l.first < r; });
+	return it != _values.end() && it->first == value ? it->second : 0;
 }
 
 } // Pdf417
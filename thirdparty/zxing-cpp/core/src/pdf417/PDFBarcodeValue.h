@@ -6,7 +6,7 @@
 
 #pragma once
 
-#include <map>
+#include <utility>
 #include <vector>
 
 namespace ZXing {
@@ -17,7 +17,8 @@ namespace Pdf417 {
 */
 class BarcodeValue
 {
-	std::map<int, int> _values;
+	// (value, occurrences) sorted by value, there are rarely more than one or two of them
+	std::vector<std::pair<int, int>> _values;
 
 public:
 	/**
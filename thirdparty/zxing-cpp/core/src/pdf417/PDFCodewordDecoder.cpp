@@ -12,6 +12,7 @@
 #include <array>
 #include <cstdint>
 #include <limits>
+#include <vector>
 
 namespace ZXing {
 namespace Pdf417 {
@@ -522,12 +523,15 @@ CodewordDecoder::GetCodeword(int symbol)
 {
 	if ((symbol & 0xFFFF0000) != 0x10000)
 		return -1;
-	symbol &= 0xFFFF;
-	auto it = std::lower_bound(SYMBOL_TABLE.begin(), SYMBOL_TABLE.end(), symbol);
-	if (it != SYMBOL_TABLE.end() && *it == symbol) {
-		return (CODEWORD_TABLE[it - SYMBOL_TABLE.begin()] - 1) % NUMBER_OF_CODEWORDS;
-	}
-	return -1;
+	// direct lookup of the 16 low bits instead of a binary search in SYMBOL_TABLE, this is called for every
+	// sampled codeword (128kB on heap, calculated per process on first use)
+	static const auto codewordTable = []() {
+		auto table = std::vector<int16_t>(0x10000, -1);
+		for (int i = 0; i < SYMBOL_COUNT; i++)
+			table[SYMBOL_TABLE[i]] = (CODEWORD_TABLE[i] - 1) % NUMBER_OF_CODEWORDS;
+		return table;
+	}();
+	return codewordTable[symbol & 0xFFFF];
 }
 
 } // Pdf417
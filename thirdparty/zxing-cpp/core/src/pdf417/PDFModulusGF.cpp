@@ -5,6 +5,8 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "PDFModulusGF.h"
+
+#include <array>
 #include <stdexcept>
 
 namespace ZXing {
@@ -12,8 +14,8 @@ namespace Pdf417 {
 
 ModulusGF::ModulusGF(int modulus, int generator) :
 	_modulus(modulus),
-	_zero(*this, { 0 }),
-	_one(*this, { 1 })
+	_zero(*this, std::array{0}),
+	_one(*this, std::array{1})
 {
 #ifdef ZX_REED_SOLOMON_USE_MORE_MEMORY_FOR_SPEED
 	_expTable.resize(modulus * 2, 0);
@@ -47,9 +49,7 @@ ModulusGF::buildMonomial(int degree, int coefficient) const
 	if (coefficient == 0) {
 		return _zero;
 	}
-	std::vector<int> coefficients(degree + 1, 0);
-	coefficients[0] = coefficient;
-	return {*this, coefficients};
+	return _one.multiplyByMonomial(degree, coefficient);
 }
 
 } // Pdf417
@@ -8,48 +8,55 @@
 #include "PDFModulusGF.h"
 
 #include <algorithm>
+#include <numeric>
 #include <stdexcept>
 
 namespace ZXing {
 namespace Pdf417 {
 
-ModulusPoly::ModulusPoly(const ModulusGF& field, const std::vector<int>& coefficients) :
-	_field(&field)
+ModulusPoly::ModulusPoly(const ModulusGF& field, int size) :
+	_field(&field),
+	_size(size)
 {
-	size_t coefficientsLength = coefficients.size();
-	if (coefficientsLength > 1 && coefficients[0] == 0) {
-		// Leading term must be non-zero for anything except the constant polynomial "0"
-		size_t firstNonZero = 1;
-		while (firstNonZero < coefficientsLength && coefficients[firstNonZero] == 0) {
-			firstNonZero++;
-		}
-		if (firstNonZero == coefficientsLength) {
-			_coefficients.resize(1, 0);
-		}
-		else {
-			_coefficients.resize(coefficientsLength - firstNonZero);
-			std::copy(coefficients.begin() + firstNonZero, coefficients.end(), _coefficients.begin());
-		}
-	}
-	else {
-		_coefficients = coefficients;
+	if (size < 1 || size > MAX_COEFFICIENTS) {
+		throw std::invalid_argument("ModulusPoly size out of range");
 	}
 }
 
+ModulusPoly::ModulusPoly(const ModulusGF& field, ArrayView<int> coefficients) :
+	ModulusPoly(field, std::max(Size(coefficients), 1))
+{
+	// an empty coefficient list is the constant polynomial "0"
+	_coefficients[0] = 0;
+	std::copy(coefficients.begin(), coefficients.end(), _coefficients.begin());
+	normalize();
+}
+
 /**
-* @return evaluation of this polynomial at a given point
+* Leading term must be non-zero for anything except the constant polynomial "0"
 */
+void
+ModulusPoly::normalize()
+{
+	int firstNonZero = 0;
+	while (firstNonZero < _size - 1 && _coefficients[firstNonZero] == 0) {
+		firstNonZero++;
+	}
+	if (firstNonZero > 0) {
+		std::copy(_coefficients.begin() + firstNonZero, _coefficients.begin() + _size, _coefficients.begin());
+		_size -= firstNonZero;
+	}
+}
+
 int
-ModulusPoly::evaluateAt(int a) const
+ModulusPoly::EvaluateAt(const ModulusGF& field, ArrayView<int> coefficients, int a)
 {
 	if (a == 0) // return the x^0 coefficient
-		return coefficient(0);
-
+		return coefficients[coefficients.size() - 1];
 	if (a == 1) // return the sum of the coefficients
-		return Reduce(_coefficients, 0, [this](auto res, auto coef) { return _field->add(res, coef); });
-
-	return std::accumulate(_coefficients.begin(), _coefficients.end(), 0,
-						   [this, a](auto res, auto coef) { return _field->add(_field->multiply(a, res), coef); });
+		return Reduce(coefficients, 0, [&field](auto res, auto coef) { return field.add(res, coef); });
+	return std::accumulate(coefficients.begin(), coefficients.end(), 0,
+						   [&field, a](auto res, auto coef) { return field.add(field.multiply(a, res), coef); });
 }
 
 ModulusPoly
@@ -65,20 +72,21 @@ ModulusPoly::add(const ModulusPoly& other) const
 		return *this;
 	}
 
-	auto smallerCoefficients = &_coefficients;
-	auto largerCoefficients = &other._coefficients;
-	if (smallerCoefficients->size() > largerCoefficients->size()) {
-		std::swap(smallerCoefficients, largerCoefficients);
+	auto smaller = this;
+	auto larger = &other;
+	if (smaller->_size > larger->_size) {
+		std::swap(smaller, larger);
 	}
-	std::vector<int> sumDiff(largerCoefficients->size());
-	size_t lengthDiff = largerCoefficients->size() - smallerCoefficients->size();
+	ModulusPoly sumDiff(*_field, larger->_size);
+	int lengthDiff = larger->_size - smaller->_size;
 
 	// Copy high-order terms only found in higher-degree polynomial's coefficients
-	std::copy_n(largerCoefficients->begin(), lengthDiff, sumDiff.begin());
-	for (size_t i = lengthDiff; i < largerCoefficients->size(); i++) {
-		sumDiff[i] = _field->add((*smallerCoefficients)[i - lengthDiff], (*largerCoefficients)[i]);
+	std::copy_n(larger->_coefficients.begin(), lengthDiff, sumDiff._coefficients.begin());
+	for (int i = lengthDiff; i < larger->_size; i++) {
+		sumDiff._coefficients[i] = _field->add(smaller->_coefficients[i - lengthDiff], larger->_coefficients[i]);
 	}
-	return {*_field, sumDiff};
+	sumDiff.normalize();
+	return sumDiff;
 }
 
 ModulusPoly
@@ -102,29 +110,27 @@ ModulusPoly::multiply(const ModulusPoly& other) const
 	if (isZero() || other.isZero()) {
 		return _field->zero();
 	}
-	auto& aCoefficients = _coefficients;
-	size_t aLength = aCoefficients.size();
-	auto& bCoefficients = other._coefficients;
-	size_t bLength = bCoefficients.size();
-	std::vector<int> product(aLength + bLength - 1, 0);
-	for (size_t i = 0; i < aLength; i++) {
-		int aCoeff = aCoefficients[i];
-		for (size_t j = 0; j < bLength; j++) {
-			product[i + j] = _field->add(product[i + j], _field->multiply(aCoeff, bCoefficients[j]));
+	ModulusPoly product(*_field, _size + other._size - 1);
+	std::fill_n(product._coefficients.begin(), product._size, 0);
+	for (int i = 0; i < _size; i++) {
+		int aCoeff = _coefficients[i];
+		for (int j = 0; j < other._size; j++) {
+			product._coefficients[i + j] = _field->add(product._coefficients[i + j], _field->multiply(aCoeff, other._coefficients[j]));
 		}
 	}
-	return {*_field, product};
+	product.normalize();
+	return product;
 }
 
 ModulusPoly
 ModulusPoly::negative() const
 {
-	size_t size = _coefficients.size();
-	std::vector<int> negativeCoefficients(size);
-	for (size_t i = 0; i < size; i++) {
-		negativeCoefficients[i] = _field->subtract(0, _coefficients[i]);
+	ModulusPoly negativeCoefficients(*_field, _size);
+	for (int i = 0; i < _size; i++) {
+		negativeCoefficients._coefficients[i] = _field->subtract(0, _coefficients[i]);
 	}
-	return {*_field, negativeCoefficients};
+	negativeCoefficients.normalize();
+	return negativeCoefficients;
 }
 
 ModulusPoly
@@ -136,12 +142,12 @@ ModulusPoly::multiply(int scalar) const
 	if (scalar == 1) {
 		return *this;
 	}
-	size_t size = _coefficients.size();
-	std::vector<int> product(size);
-	for (size_t i = 0; i < size; i++) {
-		product[i] = _field->multiply(_coefficients[i], scalar);
+	ModulusPoly product(*_field, _size);
+	for (int i = 0; i < _size; i++) {
+		product._coefficients[i] = _field->multiply(_coefficients[i], scalar);
 	}
-	return {*_field, product};
+	product.normalize();
+	return product;
 }
 
 ModulusPoly
@@ -153,12 +159,13 @@ ModulusPoly::multiplyByMonomial(int degree, int coefficient) const
 	if (coefficient == 0) {
 		return _field->zero();
 	}
-	size_t size = _coefficients.size();
-	std::vector<int> product(size + degree, 0);
-	for (size_t i = 0; i < size; i++) {
-		product[i] = _field->multiply(_coefficients[i], coefficient);
+	ModulusPoly product(*_field, _size + degree);
+	for (int i = 0; i < _size; i++) {
+		product._coefficients[i] = _field->multiply(_coefficients[i], coefficient);
 	}
-	return {*_field, product};
+	std::fill_n(product._coefficients.begin() + _size, degree, 0);
+	product.normalize();
+	return product;
 }
 
 void
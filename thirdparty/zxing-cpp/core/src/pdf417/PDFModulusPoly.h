@@ -6,10 +6,11 @@
 
 #pragma once
 
+#include "Range.h"
 #include "ZXAlgorithms.h"
 
+#include <array>
 #include <utility>
-#include <vector>
 
 namespace ZXing {
 namespace Pdf417 {
@@ -22,45 +23,69 @@ class ModulusGF;
 */
 class ModulusPoly
 {
+public:
+	// The error correction uses at most 512 EC codewords, none of its polynomials has a degree above that.
+	static constexpr int MAX_COEFFICIENTS = 512 + 1;
+
+private:
 	const ModulusGF* _field = nullptr;
-	std::vector<int> _coefficients;
+	int _size = 0;
+	// stored inline, the error correction runs without any heap allocation
+	std::array<int, MAX_COEFFICIENTS> _coefficients;
+
+	ModulusPoly(const ModulusGF& field, int size);
+	void normalize();
 
 public:
 	// Build a invalid object, so that this can be used in container or return by reference,
 	// any access to invalid object is undefined behavior.
 	ModulusPoly() = default;
 
-	ModulusPoly(const ModulusGF& field, const std::vector<int>& coefficients);
+	ModulusPoly(const ModulusGF& field, ArrayView<int> coefficients);
 
-	const std::vector<int>& coefficients() const {
-		return _coefficients;
+	ModulusPoly(const ModulusPoly& other) { *this = other; }
+
+	ModulusPoly& operator=(const ModulusPoly& other) {
+		_field = other._field;
+		_size = other._size;
+		std::copy_n(other._coefficients.begin(), _size, _coefficients.begin());
+		return *this;
+	}
+
+	ArrayView<int> coefficients() const {
+		return {_coefficients.data(), static_cast<size_t>(_size)};
 	}
 
 	/**
 	* @return degree of this polynomial
 	*/
 	int degree() const {
-		return Size(_coefficients) - 1;
+		return _size - 1;
 	}
 
 	/**
 	* @return true iff this polynomial is the monomial "0"
 	*/
 	bool isZero() const {
-		return _coefficients.at(0) == 0;
+		return _coefficients[0] == 0;
 	}
 
 	/**
 	* @return coefficient of x^degree term in this polynomial
 	*/
 	int coefficient(int degree) const {
-		return _coefficients.at(_coefficients.size() - 1 - degree);
+		return _coefficients[_size - 1 - degree];
 	}
 
 	/**
 	* @return evaluation of this polynomial at a given point
 	*/
-	int evaluateAt(int a) const;
+	int evaluateAt(int a) const { return EvaluateAt(*_field, coefficients(), a); }
+
+	/**
+	* @return evaluation at a given point of the polynomial with the given coefficients (highest degree first)
+	*/
+	static int EvaluateAt(const ModulusGF& field, ArrayView<int> coefficients, int a);
 
 	ModulusPoly add(const ModulusPoly& other) const;
 	ModulusPoly subtract(const ModulusPoly& other) const;
@@ -72,8 +97,9 @@ public:
 
 	friend void swap(ModulusPoly& a, ModulusPoly& b) noexcept
 	{
-		std::swap(a._field, b._field);
-		std::swap(a._coefficients, b._coefficients);
+		ModulusPoly tmp = a;
+		a = b;
+		b = tmp;
 	}
 };
 
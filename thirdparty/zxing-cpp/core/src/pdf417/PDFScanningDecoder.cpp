@@ -305,12 +305,16 @@ static int GetStartColumn(const DetectionResult& detectionResult, int barcodeCol
 	return leftToRight ? detectionResult.getBoundingBox().value().minX() : detectionResult.getBoundingBox().value().maxX();
 }
 
-static std::vector<std::vector<BarcodeValue>> CreateBarcodeMatrix(DetectionResult& detectionResult)
+// One flat row major block, with the two row indicator columns at both ends of each row.
+static int BarcodeMatrixWidth(const DetectionResult& detectionResult)
 {
-	std::vector<std::vector<BarcodeValue>> barcodeMatrix(detectionResult.barcodeRowCount());
-	for (auto& row : barcodeMatrix) {
-		row.resize(detectionResult.barcodeColumnCount() + 2);
-	}
+	return detectionResult.barcodeColumnCount() + 2;
+}
+
+static std::vector<BarcodeValue> CreateBarcodeMatrix(DetectionResult& detectionResult)
+{
+	const int width = BarcodeMatrixWidth(detectionResult);
+	std::vector<BarcodeValue> barcodeMatrix(detectionResult.barcodeRowCount() * width);
 
 	int column = 0;
 	for (auto& resultColumn : detectionResult.allColumns()) {
@@ -319,11 +323,11 @@ static std::vector<std::vector<BarcodeValue>> CreateBarcodeMatrix(DetectionResul
 				if (codeword != nullptr) {
 					int rowNumber = codeword.value().rowNumber();
 					if (rowNumber >= 0) {
-						if (rowNumber >= Size(barcodeMatrix)) {
+						if (rowNumber >= detectionResult.barcodeRowCount()) {
 							// We have more rows than the barcode metadata allows for, ignore them.
 							continue;
 						}
-						barcodeMatrix[rowNumber][column].setValue(codeword.value().value());
+						barcodeMatrix[rowNumber * width + column].setValue(codeword.value().value());
 					}
 				}
 			}
@@ -338,20 +342,22 @@ static int GetNumberOfECCodeWords(int barcodeECLevel)
 	return 2 << barcodeECLevel;
 }
 
-static bool AdjustCodewordCount(const DetectionResult& detectionResult, std::vector<std::vector<BarcodeValue>>& barcodeMatrix)
+static bool AdjustCodewordCount(const DetectionResult& detectionResult, std::vector<BarcodeValue>& barcodeMatrix)
 {
-	auto numberOfCodewords = barcodeMatrix[0][1].value();
+	// the symbol length descriptor is the first data codeword, column 1 of row 0
+	auto& lengthDescriptor = barcodeMatrix[1];
+	auto numberOfCodewords = lengthDescriptor.value();
 	int calculatedNumberOfCodewords = detectionResult.barcodeColumnCount() * detectionResult.barcodeRowCount() - GetNumberOfECCodeWords(detectionResult.barcodeECLevel());
 	if (calculatedNumberOfCodewords < 1 || calculatedNumberOfCodewords > CodewordDecoder::MAX_CODEWORDS_IN_BARCODE)
 		calculatedNumberOfCodewords = 0;
 	if (numberOfCodewords.empty()) {
 		if (!calculatedNumberOfCodewords)
 			return false;
-		barcodeMatrix[0][1].setValue(calculatedNumberOfCodewords);
+		lengthDescriptor.setValue(calculatedNumberOfCodewords);
 	}
 	else if (calculatedNumberOfCodewords && numberOfCodewords[0] != calculatedNumberOfCodewords) {
 		// The calculated one is more reliable as it is derived from the row indicator columns
-		barcodeMatrix[0][1].setValue(calculatedNumberOfCodewords);
+		lengthDescriptor.setValue(calculatedNumberOfCodewords);
 	}
 	return true;
 }
@@ -461,11 +467,11 @@ ZXING_EXPORT_TEST_ONLY
 bool DecodeErrorCorrection(std::vector<int>& received, int numECCodewords, const std::vector<int>& erasures [[maybe_unused]], int& nbErrors)
 {
 	const ModulusGF& field = GetModulusGF();
-	ModulusPoly poly(field, received);
+	// the received word can be longer than any polynomial of the EC, it is only evaluated
 	std::vector<int> S(numECCodewords);
 	bool error = false;
 	for (int i = numECCodewords; i > 0; i--) {
-		int eval = poly.evaluateAt(field.exp(i));
+		int eval = ModulusPoly::EvaluateAt(field, received, field.exp(i));
 		S[numECCodewords - i] = eval;
 		if (eval != 0) {
 			error = true;
@@ -645,6 +651,7 @@ static DecoderResult CreateDecoderResultFromAmbiguousValues(int ecLevel, std::ve
 static DecoderResult CreateDecoderResult(DetectionResult& detectionResult)
 {
 	auto barcodeMatrix = CreateBarcodeMatrix(detectionResult);
+	const int width = BarcodeMatrixWidth(detectionResult);
 	if (!AdjustCodewordCount(detectionResult, barcodeMatrix)) {
 		return {};
 	}
@@ -654,7 +661,7 @@ static DecoderResult CreateDecoderResult(DetectionResult& detectionResult)
 	std::vector<int> ambiguousIndexesList;
 	for (int row = 0; row < detectionResult.barcodeRowCount(); row++) {
 		for (int column = 0; column < detectionResult.barcodeColumnCount(); column++) {
-			auto values = barcodeMatrix[row][column + 1].value();
+			auto values = barcodeMatrix[row * width + column + 1].value();
 			int codewordIndex = row * detectionResult.barcodeColumnCount() + column;
 			if (values.empty()) {
 				erasures.push_back(codewordIndex);
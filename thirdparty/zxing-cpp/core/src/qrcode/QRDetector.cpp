@@ -19,6 +19,7 @@
 #include "QRVersion.h"
 #include "Quadrilateral.h"
 #include "RegressionLine.h"
+#include "SpatialGrid.h"
 
 #include <algorithm>
 #include <cmath>
@@ -26,6 +27,7 @@
 #include <iterator>
 #include <map>
 #include <numbers>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -50,25 +52,15 @@ PatternView FindPattern(const PatternView& view)
 	});
 }
 
-std::vector<ConcentricPattern> FindFinderPatterns(const BitMatrix& image, bool tryHarder)
+// Scan the rows firstRow, firstRow + skip, ... < endRow for finder patterns.
+static std::vector<ConcentricPattern> FindFinderPatterns(const BitMatrix& image, int firstRow, int endRow, int skip, int& N)
 {
-	constexpr int MIN_SKIP         = 3;           // 1 pixel/module times 3 modules/center
-	constexpr int MAX_MODULES_FAST = 20 * 4 + 17; // support up to version 20 for mobile clients
-
-	// Let's assume that the maximum version QR Code we support takes up 1/4 the height of the
-	// image, and then account for the center being 3 modules in size. This gives the smallest
-	// number of pixels the center could be, so skip this often. When trying harder, look for all
-	// QR versions regardless of how dense they are.
-	int height = image.height();
-	int skip = (3 * height) / (4 * MAX_MODULES_FAST);
-	if (skip < MIN_SKIP || tryHarder)
-		skip = MIN_SKIP;
-
 	std::vector<ConcentricPattern> res;
-	[[maybe_unused]] int N = 0;
+	SpatialGrid grid(64);
+	int maxSize = 0;
 	PatternRow row;
 
-	for (int y = skip - 1; y < height; y += skip) {
+	for (int y = firstRow; y < endRow; y += skip) {
 		GetPatternRow(image, y, row, false);
 		PatternView next = row;
 
@@ -76,7 +68,7 @@ std::vector<ConcentricPattern> FindFinderPatterns(const BitMatrix& image, bool t
 			PointF p(next.pixelsInFront() + next[0] + next[1] + next[2] / 2.0, y + 0.5);
 
 			// make sure p is not 'inside' an already found pattern area
-			if (FindIf(res, [p](const auto& old) { return distance(p, old) < old.size / 2; }) == res.end()) {
+			if (!grid.any(p, maxSize / 2.0, [&](int i) { return distance(p, res[i]) < res[i].size / 2; })) {
 				log(p);
 				N++;
 				auto pattern = LocateConcentricPattern<E2E>(image, PATTERN, p,
@@ -88,6 +80,8 @@ std::vector<ConcentricPattern> FindFinderPatterns(const BitMatrix& image, bool t
 					log(*pattern + PointF(0, .2), 3);
 					log(*pattern - PointF(0, .2), 3);
 					assert(image.get(pattern->x, pattern->y));
+					grid.insert(Size(res), *pattern);
+					maxSize = std::max(maxSize, pattern->size);
 					res.push_back(*pattern);
 				}
 			}
@@ -98,11 +92,96 @@ std::vector<ConcentricPattern> FindFinderPatterns(const BitMatrix& image, bool t
 		}
 	}
 
-	printf("FPs?  : %d\n", N);
+	return res;
+}
+
+// Large images are split in horizontal bands that are searched in parallel, at least MIN_ROWS_PER_BAND scan lines each.
+static int FinderPatternBands(const BitMatrix& image, int scanLines)
+{
+	constexpr int MIN_PIXELS_PER_BAND = 2'000'000;
+	constexpr int MIN_ROWS_PER_BAND = 64;
+	constexpr int MAX_BANDS = 8;
+
+#ifdef PRINT_DEBUG
+	return 1;
+#else
+	int cores = narrow_cast<int>(std::thread::hardware_concurrency());
+	int bands = std::min(narrow_cast<int>(int64_t(image.width()) * image.height() / MIN_PIXELS_PER_BAND),
+						 scanLines / MIN_ROWS_PER_BAND);
+	return std::clamp(bands, 1, std::clamp(cores, 1, MAX_BANDS));
+#endif
+}
+
+std::vector<ConcentricPattern> FindFinderPatterns(const BitMatrix& image, bool tryHarder)
+{
+	constexpr int MIN_SKIP         = 3;           // 1 pixel/module times 3 modules/center
+	constexpr int MAX_MODULES_FAST = 20 * 4 + 17; // support up to version 20 for mobile clients
+
+	// Let's assume that the maximum version QR Code we support takes up 1/4 the height of the
+	// image, and then account for the center being 3 modules in size. This gives the smallest
+	// number of pixels the center could be, so skip this often. When trying harder, look for all
+	// QR versions regardless of how dense they are.
+	int height = image.height();
+	int skip = (3 * height) / (4 * MAX_MODULES_FAST);
+	if (skip < MIN_SKIP || tryHarder)
+		skip = MIN_SKIP;
+
+	int scanLines = (height - skip) / skip + 1;
+	int nbBands = FinderPatternBands(image, scanLines);
+	[[maybe_unused]] int N = 0;
+
+	if (nbBands == 1) {
+		auto res = FindFinderPatterns(image, skip - 1, height, skip, N);
+		printf("FPs?  : %d\n", N);
+		return res;
+	}
+
+	// Each band is searched independently, so a pattern crossing the border between two bands may be found in both.
+	// The bands are merged in scan order, dropping the patterns located 'inside' one found in an earlier band.
+	std::vector<std::vector<ConcentricPattern>> bands(nbBands);
+	std::vector<int> counts(nbBands);
+	{
+		std::vector<std::thread> threads;
+		for (int b = 0; b < nbBands; ++b) {
+			int first = skip - 1 + skip * (scanLines * b / nbBands);
+			int end = skip - 1 + skip * (scanLines * (b + 1) / nbBands);
+			threads.emplace_back([&, b, first, end]() { bands[b] = FindFinderPatterns(image, first, end, skip, counts[b]); });
+		}
+		for (auto& t : threads)
+			t.join();
+	}
+
+	std::vector<ConcentricPattern> res;
+	SpatialGrid grid(64);
+	int maxSize = 0;
+	for (auto& band : bands) {
+		int bandStart = Size(res);
+		for (auto& pattern : band) {
+			if (grid.any(pattern, maxSize / 2.0, [&](int i) { return i < bandStart && distance(pattern, res[i]) < res[i].size / 2; }))
+				continue;
+			grid.insert(Size(res), pattern);
+			maxSize = std::max(maxSize, pattern.size);
+			res.push_back(pattern);
+		}
+	}
+
+	printf("FPs?  : %d\n", Reduce(counts));
 
 	return res;
 }
 
+// The number of combinations grows with the cube of the number of patterns, spread them over threads when there are many.
+static int FinderPatternSetThreads(int nbPatterns)
+{
+	constexpr int MIN_PATTERNS = 64;
+	constexpr int MAX_THREADS = 8;
+
+	if (nbPatterns < MIN_PATTERNS)
+		return 1;
+	int cores = narrow_cast<int>(std::thread::hardware_concurrency());
+	return std::clamp(std::min(cores, nbPatterns / (MIN_PATTERNS / 4)), 1, MAX_THREADS);
+}
+
 /**
  * @brief GenerateFinderPatternSets
  * @param patterns list of ConcentricPattern objects, i.e. found finder pattern squares
@@ -112,7 +191,6 @@ FinderPatternSets GenerateFinderPatternSets(FinderPatterns& patterns)
 {
 	std::sort(patterns.begin(), patterns.end(), [](const auto& a, const auto& b) { return a.size < b.size; });
 
-	auto sets            = std::multimap<double, FinderPatternSet>();
 	auto squaredDistance = [](const auto* a, const auto* b) {
 		// The scaling of the distance based on the b/a size ratio is a very coarse compensation for the shortening effect of
 		// the camera projection on slanted symbols. The fact that the size of the finder pattern is proportional to the
@@ -125,8 +203,16 @@ FinderPatternSets GenerateFinderPatternSets(FinderPatterns& patterns)
 	const double cosUpper = std::cos(60. / 180 * std::numbers::pi);
 	const double cosLower = std::cos(120. / 180 * std::numbers::pi);
 
+	// arbitrarily limit the number of potential sets
+	// (this has performance implications while limiting the maximal number of detected symbols)
+	constexpr int setSizeLimit = 256;
+
+	// The sets are keyed by (d, index of the (i, j, k) combination), so that equally plausible sets stay in the order
+	// they were generated in and the selection does not depend on how the combinations are split between threads.
+	using Sets = std::map<std::pair<double, int64_t>, FinderPatternSet>;
+
 	int nbPatterns = Size(patterns);
-	for (int i = 0; i < nbPatterns - 2; i++) {
+	auto addSetsOf = [&](int i, Sets& sets) {
 		for (int j = i + 1; j < nbPatterns - 1; j++) {
 			for (int k = j + 1; k < nbPatterns - 0; k++) {
 				const auto* a = &patterns[i];
@@ -183,19 +269,40 @@ FinderPatternSets GenerateFinderPatternSets(FinderPatterns& patterns)
 				if (cross(*c - *b, *a - *b) < 0)
 					std::swap(a, c);
 
-				// arbitrarily limit the number of potential sets
-				// (this has performance implications while limiting the maximal number of detected symbols)
-				const auto setSizeLimit = 256;
-				if (sets.size() < setSizeLimit || sets.crbegin()->first > d) {
-					sets.emplace(d, FinderPatternSet{*a, *b, *c});
-					if (sets.size() > setSizeLimit)
+				auto key = std::pair(d, (int64_t(i) * nbPatterns + j) * nbPatterns + k);
+				if (Size(sets) < setSizeLimit || key < sets.crbegin()->first) {
+					sets.emplace(key, FinderPatternSet{*a, *b, *c});
+					if (Size(sets) > setSizeLimit)
 						sets.erase(std::prev(sets.end()));
 				}
 			}
 		}
+	};
+
+	Sets sets;
+	int nbThreads = FinderPatternSetThreads(nbPatterns);
+	if (nbThreads == 1) {
+		for (int i = 0; i < nbPatterns - 2; i++)
+			addSetsOf(i, sets);
+	} else {
+		// the outer loop iterations get shorter with increasing i, so they are dealt out round robin
+		std::vector<Sets> partial(nbThreads);
+		std::vector<std::thread> threads;
+		for (int t = 0; t < nbThreads; ++t)
+			threads.emplace_back([&, t]() {
+				for (int i = t; i < nbPatterns - 2; i += nbThreads)
+					addSetsOf(i, partial[t]);
+			});
+		for (auto& t : threads)
+			t.join();
+
+		for (auto& p : partial)
+			sets.merge(p);
+		while (Size(sets) > setSizeLimit)
+			sets.erase(std::prev(sets.end()));
 	}
 
-	// convert from multimap to vector
+	// convert from map to vector
 	FinderPatternSets res;
 	res.reserve(sets.size());
 	for (auto& [d, s] : sets)
@@ -6,6 +6,7 @@
 
 #include "ZXingQt.h"
 #include "ZXingQtVideoFilter.h"
+#include "ZXingQtVideoFileScanner.h"
 #include "ZXingQtImageProvider.h"
 
 #include "ReadBarcode.h"
@@ -20,6 +21,7 @@
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
+#include <QImageReader>
 #include <QStandardPaths>
 #include <QTextStream>
 #include <QScopeGuard>
@@ -35,6 +37,7 @@ void ZXingQt::registerQMLTypes()
 {
     qmlRegisterType<ZXingQt>("ZXingQt", 1, 0, "ZXingQt");
     qmlRegisterType<ZXingQtVideoFilter>("ZXingQt", 1, 0, "ZXingQtVideoFilter");
+    qmlRegisterType<ZXingQtVideoFileScanner>("ZXingQt", 1, 0, "ZXingQtVideoFileScanner");
 }
 
 void ZXingQt::registerQMLImageProvider(QQmlEngine &engine)
@@ -100,6 +103,43 @@ QString ZXingQt::formatToString(const int fmt)
     return QString();
 }
 
+ZXing::BarcodeFormats ZXingQt::formatsFromBitmask(const int bitmask)
+{
+    using AF = ZXingQt::BarcodeFormat; // app flags (legacy layout, canonical)
+    using ZF = ZXing::BarcodeFormat;   // library enum (ID based)
+
+    static const struct { AF bit; ZF zx; } s_map[] = {
+        { AF::Aztec,           ZF::Aztec },
+        { AF::Codabar,         ZF::Codabar },
+        { AF::Code39,          ZF::Code39 },
+        { AF::Code93,          ZF::Code93 },
+        { AF::Code128,         ZF::Code128 },
+        { AF::DataBar,         ZF::DataBar },
+        { AF::DataBarExpanded, ZF::DataBarExp },
+        { AF::DataMatrix,      ZF::DataMatrix },
+        { AF::EAN8,            ZF::EAN8 },
+        { AF::EAN13,           ZF::EAN13 },
+        { AF::ITF,             ZF::ITF },
+        { AF::MaxiCode,        ZF::MaxiCode },
+        { AF::PDF417,          ZF::PDF417 },
+        { AF::QRCode,          ZF::QRCode },
+        { AF::UPCA,            ZF::UPCA },
+        { AF::UPCE,            ZF::UPCE },
+        { AF::MicroQRCode,     ZF::MicroQRCode },
+        { AF::RMQRCode,        ZF::RMQRCode },
+        { AF::DataBarLimited,  ZF::DataBarLtd },
+        { AF::DXFilmEdge,      ZF::DXFilmEdge },
+    };
+
+    std::vector<ZF> formats;
+    for (const auto &m : s_map)
+    {
+        if (bitmask & static_cast<int>(m.bit)) formats.push_back(m.zx);
+    }
+
+    return ZXing::BarcodeFormats(std::move(formats));
+}
+
 ZXing::ImageFormat ZXingQt::qimageFormatToXZingFormat(const QImage &img)
 {
     ZXing::ImageFormat format = ZXing::ImageFormat::None;
@@ -198,6 +238,40 @@ void ZXingQt::qvideoframeFormatToXZingFormat(const QVideoFrame &frame,
     }
 }
 
+bool ZXingQt::qvideoframeIsReadable(const QVideoFrame &frame)
+{
+    ZXing::ImageFormat format = ZXing::ImageFormat::None;
+    int pixStride = 0;
+    int pixOffset = 0;
+
+    qvideoframeFormatToXZingFormat(frame, format, pixStride, pixOffset);
+
+    // a mirror combined with a quarter turn depends on the order toImage() applies them in, leave it to toImage()
+    return format != ZXing::ImageFormat::None && !frame.mirrored() && !frame.surfaceFormat().isMirrored();
+}
+
+ZXing::ImageView ZXingQt::qvideoframeToImageView(const QVideoFrame &mappedFrame)
+{
+    ZXing::ImageFormat format = ZXing::ImageFormat::None;
+    int pixStride = 0;
+    int pixOffset = 0;
+
+    qvideoframeFormatToXZingFormat(mappedFrame, format, pixStride, pixOffset);
+    if (format == ZXing::ImageFormat::None || !mappedFrame.bits(0)) return {};
+
+    ZXing::ImageView view(mappedFrame.bits(0) + pixOffset, mappedFrame.width(), mappedFrame.height(),
+                          format, mappedFrame.bytesPerLine(0), pixStride);
+
+    // the orientation changes are folded into the strides, nothing is copied
+    if (mappedFrame.surfaceFormat().scanLineDirection() == QVideoFrameFormat::BottomToTop)
+    {
+        view = ZXing::ImageView(view.data(0, view.height() - 1), view.width(), view.height(),
+                                format, -view.rowStride(), view.pixStride());
+    }
+
+    return view.rotated(qToUnderlying(mappedFrame.rotation()));
+}
+
 inline QList<BarcodeQml> QListBarcodes(ZXing::Barcodes && zxres)
 {
     QList<BarcodeQml> res;
@@ -289,18 +363,11 @@ QList<BarcodeQml> ZXingQt::ReadBarcodes(const QVideoFrame &frame,
         return {};
     }
 
-    ZXing::ImageFormat format = ZXing::ImageFormat::None;
-    int pixStride = 0;
-    int pixOffset = 0;
-
-    qvideoframeFormatToXZingFormat(frame, format, pixStride, pixOffset);
-
     //qDebug() << ">>> ZXingQt::ReadBarcodes(QVideoFrame)";
     //qDebug() << "QVideoFrame geometry    :" << frame.width() << "x" << frame.height() << "/" << frame.rotation();
     //qDebug() << "QVideoFrame PixelFormat :" << frame.pixelFormat();
-    //qDebug() << "ZXing::ImageFormat       :" << (int)format;
 
-    if (format != ZXing::ImageFormat::None)
+    if (qvideoframeIsReadable(frame))
     {
         // shallow copy just to get access to the non-const map() function
         auto frame_ro = frame;
@@ -311,13 +378,15 @@ QList<BarcodeQml> ZXingQt::ReadBarcodes(const QVideoFrame &frame,
         }
         QScopeGuard unmap([&] { frame_ro.unmap(); });
 
-        return QListBarcodes(
-            ZXing::ReadBarcodes(
-                ZXing::ImageView(frame_ro.bits(0) + pixOffset, frame_ro.width(), frame_ro.height(),
-                                 format, frame_ro.bytesPerLine(0), pixStride).cropped(captureRect.left(), captureRect.top(),
-                                                                                      captureRect.width(), captureRect.height()),
-                opts)
-            );
+        const ZXing::ImageView view = qvideoframeToImageView(frame_ro);
+        if (view.data())
+        {
+            return QListBarcodes(
+                ZXing::ReadBarcodes(
+                    view.cropped(captureRect.left(), captureRect.top(), captureRect.width(), captureRect.height()),
+                    opts)
+                );
+        }
     }
 
     // QImage fallback
@@ -346,9 +415,117 @@ QList<BarcodeQml> ZXingQt::ReadBarcodes2(const QVideoFrame &frame,
 
 /* ************************************************************************** */
 
+static bool useTiledRead(const QSize &size)
+{
+    return size.width() > 0xffff || size.height() > 0xffff ||
+           qint64(size.width()) * size.height() > ZXingQt::s_tiledReadThreshold;
+}
+
+//! Read barcodes from a QImage in tiles, every tile is converted on its own
+QList<BarcodeQml> ZXingQt::ReadBarcodesTiled(const QImage &image,
+                                             const ZXing::ReaderOptions &opts)
+{
+    if (image.isNull())
+    {
+        qWarning() << "ZXingQt::ReadBarcodesTiled(QImage) invalid QImage!";
+        return {};
+    }
+
+    const ZXing::ImageFormat format = qimageFormatToXZingFormat(image);
+
+    auto loadTile = [&](int left, int top, int width, int height, const ZXing::TileDecoder &decode) {
+        if (format != ZXing::ImageFormat::None)
+        {
+            decode(ZXing::ImageView(image.constBits(), image.width(), image.height(),
+                                    format, static_cast<int>(image.bytesPerLine())).cropped(left, top, width, height));
+        }
+        else
+        {
+            const QImage tile = image.copy(left, top, width, height).convertToFormat(QImage::Format_Grayscale8, Qt::MonoOnly);
+            decode(ZXing::ImageView(tile.constBits(), tile.width(), tile.height(),
+                                    ZXing::ImageFormat::Lum, static_cast<int>(tile.bytesPerLine())));
+        }
+    };
+
+    try
+    {
+        return QListBarcodes(ZXing::ReadBarcodes(image.width(), image.height(), loadTile, opts));
+    }
+    catch (const std::exception &e)
+    {
+        qWarning() << "ZXingQt::ReadBarcodesTiled(QImage) error:" << e.what();
+    }
+
+    return {};
+}
+
+//! Read barcodes from an image file in tiles, only the tiles being decoded are held in memory
+QList<BarcodeQml> ZXingQt::ReadBarcodesTiled(const QString &filepath,
+                                             const ZXing::ReaderOptions &opts)
+{
+    QImageReader reader(filepath);
+    const QSize size = reader.size();
+
+    // without clip rect support, every tile would decode the whole file, so load it once instead,
+    // but only if the whole image stays within the allocation limit the tiles are meant to respect
+    if (!size.isValid() || !reader.supportsOption(QImageIOHandler::ClipRect))
+    {
+        const int depth = (reader.imageFormat() != QImage::Format_Invalid) ?
+                              QImage::toPixelFormat(reader.imageFormat()).bitsPerPixel() : 32;
+        const qint64 bytes = qint64(size.width()) * size.height() * depth / 8;
+
+        if (QImageReader::allocationLimit() > 0 && bytes > QImageReader::allocationLimit() * 1024LL * 1024LL)
+        {
+            qWarning() << "ZXingQt::ReadBarcodesTiled()" << filepath << "cannot be read in tiles,"
+                       << "and is above the allocation limit of" << QImageReader::allocationLimit() << "MB";
+            return {};
+        }
+
+        return ReadBarcodesTiled(reader.read(), opts);
+    }
+
+    // QImageReader is reentrant, every tile uses its own reader.
+    // Formats that are decoded sequentially (JPEG) still go through every row above the tile,
+    // so the rows of the file are decoded once per tile below them: bounded memory, not time.
+    auto loadTile = [&filepath](int left, int top, int width, int height, const ZXing::TileDecoder &decode) {
+        QImageReader tileReader(filepath);
+        tileReader.setClipRect(QRect(left, top, width, height));
+
+        const QImage tile = tileReader.read().convertToFormat(QImage::Format_Grayscale8, Qt::MonoOnly);
+        if (tile.isNull())
+        {
+            qWarning() << "ZXingQt::ReadBarcodesTiled() cannot read tile" << QRect(left, top, width, height)
+                       << "from" << filepath << tileReader.errorString();
+            return;
+        }
+
+        decode(ZXing::ImageView(tile.constBits(), tile.width(), tile.height(),
+                                ZXing::ImageFormat::Lum, static_cast<int>(tile.bytesPerLine())));
+    };
+
+    try
+    {
+        return QListBarcodes(ZXing::ReadBarcodes(size.width(), size.height(), loadTile, opts));
+    }
+    catch (const std::exception &e)
+    {
+        qWarning() << "ZXingQt::ReadBarcodesTiled(QString) error:" << e.what();
+    }
+
+    return {};
+}
+
+/* ************************************************************************** */
+
 QList<BarcodeQml> ZXingQt::loadImage(const QUrl &fileUrl)
 {
     QString filepath = fileUrl.toLocalFile();
+
+    if (useTiledRead(QImageReader(filepath).size()))
+    {
+        return ReadBarcodesTiled(filepath);
+    }
+
     QImage img(filepath);
 
     return ReadBarcodes(img);
@@ -356,6 +533,11 @@ QList<BarcodeQml> ZXingQt::loadImage(const QUrl &fileUrl)
 
 QList<BarcodeQml> ZXingQt::loadImage(const QImage &img)
 {
+    if (useTiledRead(img.size()))
+    {
+        return ReadBarcodesTiled(img);
+    }
+
     return ReadBarcodes(img);
 }
 
@@ -17,6 +17,7 @@
 #include <QString>
 #include <QRect>
 #include <QPoint>
+#include <QPolygonF>
 #include <QImage>
 #include <QVideoFrame>
 
@@ -59,13 +60,25 @@ class BarcodeQml : private ZXing::Barcode
     Q_PROPERTY(QString symbologyIdentifier READ symbologyIdentifier)
     Q_PROPERTY(ZXing::ContentType contentType READ contentType)
     Q_PROPERTY(int lineCount READ lineCount)
+    Q_PROPERTY(int sequenceSize READ sequenceSize)
+    Q_PROPERTY(int sequenceIndex READ sequenceIndex)
+    Q_PROPERTY(QString sequenceId READ sequenceId)
 
     Q_PROPERTY(int runTime MEMBER runTime)
+    Q_PROPERTY(qint64 frameTime MEMBER frameTime)
+    Q_PROPERTY(qint64 decodeStart MEMBER decodeStart)
+    Q_PROPERTY(qint64 decodeEnd MEMBER decodeEnd)
+    Q_PROPERTY(QPolygonF itemQuad MEMBER itemQuad)
 
     QString m_text;
     QByteArray m_bytes;
     Position m_position;
 
+    void setPosition(const ZXing::Position &pos) {
+        auto qp = [&pos](int i) { return QPoint(pos[i].x, pos[i].y); };
+        m_position = {qp(0), qp(1), qp(2), qp(3)};
+    }
+
 public:
     BarcodeQml() = default; // required for qmetatype machinery
 
@@ -73,12 +86,21 @@ public:
         m_text = QString::fromStdString(ZXing::Barcode::text());
         m_bytes = QByteArray(reinterpret_cast<const char*>(ZXing::Barcode::bytes().data()),
                              static_cast<qsizetype>(ZXing::Barcode::bytes().size()));
-        auto &pos = ZXing::Barcode::position();
-        auto qp = [&pos](int i) { return QPoint(pos[i].x, pos[i].y); };
-        m_position = {qp(0), qp(1), qp(2), qp(3)};
+        setPosition(ZXing::Barcode::position());
+    }
+
+    //! Wrap a barcode that was decoded out of another image, reporting the given position instead of its own
+    BarcodeQml(ZXing::Barcode &&r, const ZXing::Position &pos) : BarcodeQml(std::move(r)) {
+        setPosition(pos);
     }
 
     int runTime = 0; // for debugging/development
+    // steady clock timestamps in µs (camera frame arrival, decoding), for the latency telemetry
+    qint64 frameTime = 0;
+    qint64 decodeStart = 0;
+    qint64 decodeEnd = 0;
+    // position mapped into the coordinates of the video item, filled by ZXingQtVideoFilter
+    QPolygonF itemQuad;
     using ZXing::Barcode::isValid;
 
     bool hasText() const { return (ZXing::Barcode::contentType() == ZXing::ContentType::Text); }
@@ -95,6 +117,13 @@ public:
     using ZXing::Barcode::isInverted;
     using ZXing::Barcode::lineCount;
 
+    using ZXing::Barcode::sequenceSize;
+    using ZXing::Barcode::sequenceIndex;
+    using ZXing::Barcode::isPartOfSequence;
+    QString sequenceId() const { return QString::fromStdString(ZXing::Barcode::sequenceId()); }
+
+    const ZXing::Barcode &barcode() const { return *this; }
+
     bool hasError() const { return bool(ZXing::Barcode::error()); }
     QString errorMessage() const { return hasError() ? QString::fromStdString(ZXing::ToString(ZXing::Barcode::error())) : QString(); }
     QString symbologyIdentifier() const { return QString::fromStdString(ZXing::Barcode::symbologyIdentifier()); }
@@ -221,10 +250,18 @@ public:
     Q_INVOKABLE static int stringToFormat(const QString &str);
     Q_INVOKABLE static QString formatToString(const int fmt);
 
+    //! ZXingQt::BarcodeFormat flags (as used by the QML side) to the library formats
+    static ZXing::BarcodeFormats formatsFromBitmask(const int bitmask);
+
     static ZXing::ImageFormat qimageFormatToXZingFormat(const QImage &img);
     static void qvideoframeFormatToXZingFormat(const QVideoFrame &frame,
                                                ZXing::ImageFormat &format, int &pixStride, int &pixOffset);
 
+    //! Whether the decoder can read the frame memory directly: a pixel format it knows, and not mirrored
+    static bool qvideoframeIsReadable(const QVideoFrame &frame);
+    //! View of a mapped readable frame, in the orientation toImage() gives it (the one of captureRect and of the results)
+    static ZXing::ImageView qvideoframeToImageView(const QVideoFrame &mappedFrame);
+
     ///
 
     static BarcodeQml ReadBarcode(const QImage &image,
@@ -249,6 +286,19 @@ public:
                                            const ZXing::ReaderOptions &opts = {},
                                            const QRect captureRect = QRect());
 
+    //! Read barcodes from very large images (scanned sheets, panoramas) in overlapping tiles, with bounded memory
+    static QList<BarcodeQml> ReadBarcodesTiled(const QImage &image,
+                                               const ZXing::ReaderOptions &opts = {});
+
+    //! Same, reading the tiles from disk with a clip rect if the image format supports it.
+    //! JPEG files are decoded from the top for every tile (slow, but memory stays bounded).
+    //! Formats without clip rect support are loaded at once, if they fit QImageReader::allocationLimit().
+    static QList<BarcodeQml> ReadBarcodesTiled(const QString &filepath,
+                                               const ZXing::ReaderOptions &opts = {});
+
+    //! Images above this many pixels (or above 65535 pixels in one dimension) are read in tiles by loadImage()
+    static constexpr qint64 s_tiledReadThreshold = 8192LL * 8192LL;
+
     ///
 
     Q_INVOKABLE static QList<BarcodeQml> loadImage(const QUrl &fileUrl);
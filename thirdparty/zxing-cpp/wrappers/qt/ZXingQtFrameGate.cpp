@@ -0,0 +1,120 @@
+/*
+ * Copyright 2026 Emeric Grange
+ */
+
+#include "ZXingQtFrameGate.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+/* ************************************************************************** */
+
+void ZXingQtFrameGate::clear()
+{
+    m_stats = Stats();
+    m_thumbnail.clear();
+    m_thumbnailWidth = 0;
+    m_thumbnailHeight = 0;
+    m_skipped = 0;
+}
+
+ZXingQtFrameGate::Decision ZXingQtFrameGate::process(const ZXing::ImageView &image, float minSharpness, float maxMotion)
+{
+    constexpr int d = s_gradientDistance;
+    if (image.width() <= 2 * d || image.height() <= 2 * d) return Decision::Decode;
+
+    // luma, or the green channel as an approximation of it
+    const uint8_t *base = image.data() + (image.format() == ZXing::ImageFormat::Lum ? 0 : ZXing::GreenIndex(image.format()));
+    const std::ptrdiff_t rowStride = image.rowStride();
+    const std::ptrdiff_t pixStride = image.pixStride();
+
+    const int stepX = std::max(1, (image.width() - d) / s_samples);
+    const int stepY = std::max(1, (image.height() - d) / s_samples);
+    const int samplesX = (image.width() - d - 1) / stepX + 1;
+    const int samplesY = (image.height() - d - 1) / stepY + 1;
+
+    const int thumbnailWidth = (samplesX + s_blockSamples - 1) / s_blockSamples;
+    const int thumbnailHeight = (samplesY + s_blockSamples - 1) / s_blockSamples;
+    std::vector<int> thumbnail(size_t(thumbnailWidth) * thumbnailHeight, 0);
+    std::vector<int> blockCount(thumbnail.size(), 0);
+
+    // only the samples across an edge count, the sensor noise of the flat areas would hide the blur
+    constexpr int minEdge = 16;
+    int64_t energyNear = 0;
+    int64_t energyFar = 0;
+    int64_t edges = 0;
+
+    for (int sy = 0; sy < samplesY; sy++)
+    {
+        const uint8_t *row = base + std::ptrdiff_t(sy) * stepY * rowStride;
+        int *thumbnailRow = thumbnail.data() + (sy / s_blockSamples) * thumbnailWidth;
+        int *countRow = blockCount.data() + (sy / s_blockSamples) * thumbnailWidth;
+
+        for (int sx = 0; sx < samplesX; sx++)
+        {
+            const uint8_t *p = row + std::ptrdiff_t(sx) * stepX * pixStride;
+            const int v = p[0];
+
+            const int fx = p[d * pixStride] - v;
+            if (std::abs(fx) >= minEdge)
+            {
+                const int nx = p[pixStride] - v;
+                energyNear += nx * nx;
+                energyFar += fx * fx;
+                edges++;
+            }
+
+            const int fy = p[d * rowStride] - v;
+            if (std::abs(fy) >= minEdge)
+            {
+                const int ny = p[rowStride] - v;
+                energyNear += ny * ny;
+                energyFar += fy * fy;
+                edges++;
+            }
+
+            thumbnailRow[sx / s_blockSamples] += v;
+            countRow[sx / s_blockSamples]++;
+        }
+    }
+
+    const int64_t samples = int64_t(samplesX) * samplesY;
+
+    // a frame without edges (lens covered, white wall...) has nothing to decode, it counts as blurry
+    m_stats.sharpness = (edges * 256 >= samples) ? std::min(1.f, float(d * energyNear) / float(energyFar)) : 0.f;
+
+    // block means, as 8 bits fixed point
+    for (size_t i = 0; i < thumbnail.size(); i++) thumbnail[i] = thumbnail[i] * 256 / blockCount[i];
+
+    // the global brightness change is removed, auto exposure is not motion
+    m_stats.motion = 0.f;
+    if (thumbnailWidth == m_thumbnailWidth && thumbnailHeight == m_thumbnailHeight)
+    {
+        int64_t meanDiff = 0;
+        for (size_t i = 0; i < thumbnail.size(); i++) meanDiff += thumbnail[i] - m_thumbnail[i];
+        meanDiff /= int64_t(thumbnail.size());
+
+        int64_t motion = 0;
+        for (size_t i = 0; i < thumbnail.size(); i++) motion += std::abs(thumbnail[i] - m_thumbnail[i] - meanDiff);
+        m_stats.motion = float(motion) / (256.f * thumbnail.size());
+    }
+
+    m_thumbnail = std::move(thumbnail);
+    m_thumbnailWidth = thumbnailWidth;
+    m_thumbnailHeight = thumbnailHeight;
+
+    Decision decision = Decision::Decode;
+    if (m_stats.sharpness < minSharpness || m_stats.motion > maxMotion)
+        decision = Decision::Skip;
+    else if (m_stats.sharpness < 1.5f * minSharpness || m_stats.motion > 0.5f * maxMotion)
+        decision = Decision::Downgrade;
+
+    if (decision == Decision::Skip && ++m_skipped > s_maxSkipped)
+        decision = Decision::Downgrade;
+    if (decision != Decision::Skip)
+        m_skipped = 0;
+
+    return decision;
+}
+
+/* ************************************************************************** */
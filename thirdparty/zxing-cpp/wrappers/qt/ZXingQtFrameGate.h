@@ -0,0 +1,71 @@
+/*
+ * Copyright 2026 Emeric Grange
+ */
+
+#ifndef ZXING_QT_FRAME_GATE_H
+#define ZXING_QT_FRAME_GATE_H
+
+#include "ImageView.h"
+
+#include <cstdint>
+#include <vector>
+
+/*!
+ * \brief Cheap sharpness and motion estimation, to decide if a video frame is worth decoding.
+ *
+ * Both estimations run on a subsampled grid of the luma plane (about 128x128 samples,
+ * whatever the frame resolution), which costs a fraction of a millisecond.
+ *
+ * - sharpness: across the edges of the frame, energy of the gradients between adjacent
+ *   pixels relative to the energy of the gradients 8 pixels apart. Blur spreads the edges,
+ *   so the first one drops while the second one does not. The ratio does not depend on the
+ *   contrast or on the exposure, it is 1 for a sharp frame and goes down to about 1/8 for
+ *   a frame blurred over 8 pixels or more.
+ * - motion: mean absolute difference (in gray levels) between the 16x16 blocks thumbnails
+ *   of this frame and of the previous one.
+ *
+ * Frames below the thresholds are skipped, frames close to them only get a cheap decoding
+ * pass. A frame is decoded at least every s_maxSkipped frames anyway, in case the estimation
+ * is wrong about a whole scene.
+ *
+ * Not thread safe, the video filter only runs one decoding task at a time.
+ */
+class ZXingQtFrameGate
+{
+public:
+    enum class Decision
+    {
+        Decode,
+        Downgrade,
+        Skip,
+    };
+
+    struct Stats
+    {
+        float sharpness = 0.f;
+        float motion = 0.f;
+    };
+
+    //! Estimate the quality of a frame, any ImageView format works (the green channel is used for RGB)
+    Decision process(const ZXing::ImageView &image, float minSharpness, float maxMotion);
+
+    const Stats &stats() const { return m_stats; }
+
+    void clear();
+
+private:
+    Stats m_stats;
+
+    std::vector<int> m_thumbnail; // block means of the previous frame, 8 bits fixed point
+    int m_thumbnailWidth = 0;
+    int m_thumbnailHeight = 0;
+
+    int m_skipped = 0;
+
+    static constexpr int s_samples = 128;
+    static constexpr int s_blockSamples = 8; // samples per thumbnail block side
+    static constexpr int s_gradientDistance = 8;
+    static constexpr int s_maxSkipped = 15;
+};
+
+#endif // ZXING_QT_FRAME_GATE_H
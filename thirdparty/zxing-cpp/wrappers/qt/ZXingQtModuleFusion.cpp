@@ -0,0 +1,169 @@
+/*
+ * Copyright 2026 Emeric Grange
+ */
+
+#include "ZXingQtModuleFusion.h"
+
+#include "ReadBarcode.h"
+
+#include <algorithm>
+
+/* ************************************************************************** */
+
+bool ZXingQtModuleFusion::isFusable(ZXing::BarcodeFormat format)
+{
+    using ZF = ZXing::BarcodeFormat;
+    return format == ZF::QRCode || format == ZF::MicroQRCode || format == ZF::RMQRCode || format == ZF::DataMatrix;
+}
+
+// (the geometry helpers of the core are internal to the library)
+static ZXing::PointI symbolCenter(const ZXing::Position &position)
+{
+    ZXing::PointI sum;
+    for (const auto &p: position) sum += p;
+    return {sum.x / 4, sum.y / 4};
+}
+
+static int symbolSize(const ZXing::Position &position)
+{
+    auto [minX, maxX] = std::minmax({position[0].x, position[1].x, position[2].x, position[3].x});
+    auto [minY, maxY] = std::minmax({position[0].y, position[1].y, position[2].y, position[3].y});
+    return std::max(maxX - minX, maxY - minY);
+}
+
+//! Same symbol if it did not move by more than half its size since the last frame
+static bool isSameSymbol(const ZXing::PointI &center, int size, const ZXing::PointI &otherCenter)
+{
+    const auto d = otherCenter - center;
+    return qint64(d.x) * d.x + qint64(d.y) * d.y <= qint64(size / 2 + 1) * (size / 2 + 1);
+}
+
+ZXingQtModuleFusion::Track *ZXingQtModuleFusion::find(const ZXing::Barcode &bc, const ZXing::ImageView &grid)
+{
+    const auto center = symbolCenter(bc.position());
+
+    for (auto &track: m_tracks)
+    {
+        if (track.format == bc.format() && track.width == grid.width() && track.height == grid.height() &&
+            isSameSymbol(track.center, track.size, center))
+        {
+            return &track;
+        }
+    }
+
+    return nullptr;
+}
+
+ZXing::Barcode ZXingQtModuleFusion::decode(const Track &track) const
+{
+    // render the fused grid as a pure symbol, 3 pixels per module with a 4 modules quiet zone
+    constexpr int scale = 3;
+    constexpr int quietZone = 4;
+
+    const int width = (track.width + 2 * quietZone) * scale;
+    const int height = (track.height + 2 * quietZone) * scale;
+    std::vector<uint8_t> img(size_t(width) * height, 0xff);
+
+    for (int y = 0; y < track.height; y++)
+    {
+        for (int x = 0; x < track.width; x++)
+        {
+            const int i = y * track.width + x;
+            if (track.votes[i] < 0 || (track.votes[i] == 0 && !track.latest[i])) continue;
+
+            for (int dy = 0; dy < scale; dy++)
+            {
+                uint8_t *row = img.data() + size_t((y + quietZone) * scale + dy) * width;
+                std::fill_n(row + (x + quietZone) * scale, scale, 0);
+            }
+        }
+    }
+
+    ZXing::ReaderOptions opts;
+    opts.setFormats(track.format);
+    opts.setIsPure(true);
+    opts.setBinarizer(ZXing::Binarizer::FixedThreshold);
+    opts.setTryHarder(false);
+    opts.setTryRotate(false);
+    opts.setTryInvert(false);
+    opts.setTryDownscale(false);
+
+    return ZXing::ReadBarcode(ZXing::ImageView(img.data(), width, height, ZXing::ImageFormat::Lum), opts);
+}
+
+QList<BarcodeQml> ZXingQtModuleFusion::process(const QList<BarcodeQml> &results, qint64 now, int ttl)
+{
+    std::erase_if(m_tracks, [now, ttl](const Track &track) { return now - track.lastSeen > ttl; });
+
+    QList<BarcodeQml> recovered;
+
+    for (const auto &r: results)
+    {
+        const ZXing::Barcode &bc = r.barcode();
+        if (!isFusable(bc.format())) continue;
+
+        // a successful read makes the track of that symbol useless
+        if (bc.isValid())
+        {
+            const auto center = symbolCenter(bc.position());
+            std::erase_if(m_tracks, [&bc, center](const Track &track) {
+                return track.format == bc.format() && isSameSymbol(track.center, track.size, center);
+            });
+            continue;
+        }
+
+        const ZXing::ImageView grid = bc.symbol();
+        if (!bc.error() || grid.width() <= 0 || grid.height() <= 0) continue;
+
+        Track *track = find(bc, grid);
+        if (!track)
+        {
+            if (static_cast<int>(m_tracks.size()) >= s_maxTracks)
+            {
+                m_tracks.erase(std::min_element(m_tracks.begin(), m_tracks.end(),
+                                                [](const Track &a, const Track &b) { return a.lastSeen < b.lastSeen; }));
+            }
+
+            Track t;
+            t.format = bc.format();
+            t.width = grid.width();
+            t.height = grid.height();
+            t.votes.resize(size_t(t.width) * t.height, 0);
+            t.latest.resize(size_t(t.width) * t.height, 0);
+            m_tracks.push_back(std::move(t));
+            track = &m_tracks.back();
+        }
+
+        // accumulate the votes, black modules are stored as 0 in the symbol() luminance image
+        for (int y = 0; y < grid.height(); y++)
+        {
+            const uint8_t *src = grid.data(0, y);
+            int8_t *votes = track->votes.data() + y * track->width;
+            uint8_t *latest = track->latest.data() + y * track->width;
+            for (int x = 0; x < grid.width(); x++)
+            {
+                latest[x] = src[x * grid.pixStride()] < 128;
+                votes[x] = static_cast<int8_t>(std::clamp(votes[x] + (latest[x] ? 1 : -1), -s_maxVotes, s_maxVotes));
+            }
+        }
+
+        track->center = symbolCenter(bc.position());
+        track->size = symbolSize(bc.position());
+        track->lastSeen = now;
+        track->frames++;
+
+        if (track->frames < s_minFrames) continue;
+
+        ZXing::Barcode fused = decode(*track);
+        if (fused.isValid())
+        {
+            recovered.push_back(BarcodeQml(std::move(fused), bc.position()));
+            const ZXing::PointI center = track->center;
+            std::erase_if(m_tracks, [center](const Track &t) { return t.center == center; });
+        }
+    }
+
+    return recovered;
+}
+
+/* ************************************************************************** */
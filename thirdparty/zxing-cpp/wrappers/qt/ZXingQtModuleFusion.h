@@ -0,0 +1,65 @@
+/*
+ * Copyright 2026 Emeric Grange
+ */
+
+#ifndef ZXING_QT_MODULE_FUSION_H
+#define ZXING_QT_MODULE_FUSION_H
+
+#include "ZXingQt.h"
+
+#include <QList>
+
+#include <cstdint>
+#include <vector>
+
+/*!
+ * \brief Recover damaged matrix codes by voting on their modules over several video frames.
+ *
+ * When a QR Code or DataMatrix fails its error correction, the reader still returns
+ * (with returnErrors) the module grid it sampled through the detector's perspective
+ * transform. Grids of the same symbol seen in successive frames are therefore aligned
+ * module per module, and each module accumulates a black/white vote. Glare and smudges
+ * move with the camera, so the majority often ends up correct even if no single frame is.
+ * The fused grid is then decoded as a pure symbol, which is cheap compared to tryHarder.
+ *
+ * Memory is bounded: at most s_maxTracks symbols are followed, tracks not seen for longer
+ * than the TTL are dropped, and votes saturate at s_maxVotes so that recent frames can
+ * still override old ones.
+ *
+ * Not thread safe, the video filter only runs one decoding task at a time.
+ */
+class ZXingQtModuleFusion
+{
+    struct Track
+    {
+        ZXing::BarcodeFormat format = ZXing::BarcodeFormat::None;
+        int width = 0;
+        int height = 0;
+        ZXing::PointI center;
+        int size = 0; // in pixels
+        std::vector<int8_t> votes; // > 0 is black
+        std::vector<uint8_t> latest; // modules of the last frame, to break ties
+        int frames = 0;
+        qint64 lastSeen = 0;
+    };
+
+    std::vector<Track> m_tracks;
+
+    static constexpr int s_maxTracks = 4;
+    static constexpr int s_maxVotes = 8;
+    static constexpr int s_minFrames = 2;
+
+    Track *find(const ZXing::Barcode &bc, const ZXing::ImageView &grid);
+    ZXing::Barcode decode(const Track &track) const;
+
+public:
+    //! QR Code (Micro and rMQR included) and DataMatrix, the formats returning a module grid on error
+    static bool isFusable(ZXing::BarcodeFormat format);
+
+    //! Feed the results of one frame, returns the symbols recovered from the fused grids
+    QList<BarcodeQml> process(const QList<BarcodeQml> &results, qint64 now, int ttl);
+
+    void clear() { m_tracks.clear(); }
+};
+
+#endif // ZXING_QT_MODULE_FUSION_H
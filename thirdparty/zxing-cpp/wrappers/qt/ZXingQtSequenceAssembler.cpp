@@ -0,0 +1,83 @@
+/*
+ * Copyright 2026 Emeric Grange
+ */
+
+#include "ZXingQtSequenceAssembler.h"
+
+#include <algorithm>
+
+/* ************************************************************************** */
+
+ZXingQtSequenceAssembler::Sequence *ZXingQtSequenceAssembler::find(const ZXing::Barcode &part)
+{
+    for (auto &seq: m_sequences)
+    {
+        if (seq.format == part.format() && seq.id == part.sequenceId() &&
+            static_cast<int>(seq.parts.size()) == part.sequenceSize())
+        {
+            return &seq;
+        }
+    }
+
+    return nullptr;
+}
+
+QList<BarcodeQml> ZXingQtSequenceAssembler::process(const QList<BarcodeQml> &results, qint64 now, int ttl)
+{
+    // drop the sequences that went out of view
+    std::erase_if(m_sequences, [now, ttl](const Sequence &seq) { return now - seq.lastSeen > ttl; });
+
+    for (auto &seq: m_sequences) seq.seenInFrame = false;
+
+    for (const auto &r: results)
+    {
+        const ZXing::Barcode &part = r.barcode();
+        if (!part.isValid() || !part.isPartOfSequence()) continue;
+        if (part.sequenceSize() < 2 || part.sequenceSize() > s_maxParts || part.sequenceIndex() >= part.sequenceSize()) continue;
+
+        Sequence *seq = find(part);
+        if (!seq)
+        {
+            if (static_cast<int>(m_sequences.size()) >= s_maxSequences)
+            {
+                m_sequences.erase(std::min_element(m_sequences.begin(), m_sequences.end(),
+                                                   [](const Sequence &a, const Sequence &b) { return a.lastSeen < b.lastSeen; }));
+            }
+
+            Sequence s;
+            s.format = part.format();
+            s.id = part.sequenceId();
+            s.parts.resize(part.sequenceSize());
+            m_sequences.push_back(std::move(s));
+            seq = &m_sequences.back();
+        }
+
+        seq->lastSeen = now;
+        seq->seenInFrame = true;
+
+        ZXing::Barcode &slot = seq->parts[part.sequenceIndex()];
+        if (!slot.isValid())
+        {
+            slot = part; // shallow copy, the decoded data is shared
+            seq->partsCount++;
+
+            if (seq->partsCount == static_cast<int>(seq->parts.size()))
+            {
+                seq->merged = ZXing::MergeStructuredAppendSequence(seq->parts);
+            }
+        }
+    }
+
+    QList<BarcodeQml> merged;
+    for (const auto &seq: m_sequences)
+    {
+        if (seq.seenInFrame && seq.merged.isValid())
+        {
+            merged.push_back(BarcodeQml(ZXing::Barcode(seq.merged)));
+        }
+    }
+
+    return merged;
+}
+
+/* ************************************************************************** */
@@ -0,0 +1,56 @@
+/*
+ * Copyright 2026 Emeric Grange
+ */
+
+#ifndef ZXING_QT_SEQUENCE_ASSEMBLER_H
+#define ZXING_QT_SEQUENCE_ASSEMBLER_H
+
+#include "ZXingQt.h"
+
+#include <QList>
+
+#include <string>
+#include <vector>
+
+/*!
+ * \brief Assemble structured append sequences from parts seen over several video frames.
+ *
+ * Partial sequences are keyed by format, sequenceId() and sequenceSize(). Every part is
+ * copied once, seeing it again in a later frame only refreshes the sequence. Once all the
+ * parts are known the sequence is merged, and the merged barcode is reused for as long as
+ * its parts stay in view.
+ *
+ * Memory is bounded: sequences not seen for longer than the TTL are dropped, at most
+ * s_maxSequences are kept (the least recently seen goes first), and sequences announcing
+ * more than s_maxParts parts are ignored.
+ *
+ * Not thread safe, the video filter only runs one decoding task at a time.
+ */
+class ZXingQtSequenceAssembler
+{
+    struct Sequence
+    {
+        ZXing::BarcodeFormat format = ZXing::BarcodeFormat::None;
+        std::string id;
+        std::vector<ZXing::Barcode> parts; // indexed by sequenceIndex(), invalid if missing
+        int partsCount = 0;
+        qint64 lastSeen = 0;
+        bool seenInFrame = false;
+        ZXing::Barcode merged;
+    };
+
+    std::vector<Sequence> m_sequences;
+
+    static constexpr int s_maxSequences = 8;
+    static constexpr int s_maxParts = 64;
+
+    Sequence *find(const ZXing::Barcode &part);
+
+public:
+    //! Add the sequence parts found in one frame, returns the sequences they complete
+    QList<BarcodeQml> process(const QList<BarcodeQml> &results, qint64 now, int ttl);
+
+    void clear() { m_sequences.clear(); }
+};
+
+#endif // ZXING_QT_SEQUENCE_ASSEMBLER_H
@@ -0,0 +1,435 @@
+/*
+ * Copyright 2026 Emeric Grange
+ */
+
+#include "ZXingQtVideoFileScanner.h"
+
+#include <QtConcurrent/QtConcurrentRun>
+#include <QThreadPool>
+#include <QFuture>
+#include <QFile>
+#include <QTextStream>
+#include <QHash>
+#include <QVariantMap>
+#include <QScopeGuard>
+#include <QDebug>
+
+#include <limits>
+#include <utility>
+
+/* ************************************************************************** */
+
+ZXingQtVideoFileScanner::ZXingQtVideoFileScanner(QObject *parent) : QObject(parent)
+{
+    m_readerOptions.setFormats(ZXing::BarcodeFormat::AllReadable);
+    m_readerOptions.setTextMode(ZXing::TextMode::HRI);
+
+    // no audio output, the video sink only receives the frames we seek to
+    m_player.setVideoOutput(&m_videoSink);
+
+    connect(&m_player, &QMediaPlayer::mediaStatusChanged, this, &ZXingQtVideoFileScanner::onMediaStatusChanged);
+    connect(&m_player, &QMediaPlayer::errorOccurred, this, [this](QMediaPlayer::Error, const QString &errorString) {
+        qWarning() << "ZXingQtVideoFileScanner error:" << errorString;
+        finish(false);
+    });
+    connect(&m_videoSink, &QVideoSink::videoFrameChanged, this, &ZXingQtVideoFileScanner::onVideoFrameChanged);
+
+    m_seekTimeout.setSingleShot(true);
+    m_seekTimeout.setInterval(s_seekTimeoutMs);
+    connect(&m_seekTimeout, &QTimer::timeout, this, &ZXingQtVideoFileScanner::onSeekTimeout);
+}
+
+ZXingQtVideoFileScanner::~ZXingQtVideoFileScanner()
+{
+    // the decoding tasks only hold copies of their frame and options, their continuations die with this object
+    stop();
+}
+
+/* ************************************************************************** */
+
+bool ZXingQtVideoFileScanner::scan(const QUrl &fileUrl)
+{
+    stop();
+    if (!fileUrl.isValid()) return false;
+
+    m_source = fileUrl;
+    m_running = true;
+    m_duration = 0;
+    m_requested = -1;
+    m_next = 0;
+    m_step = m_sampleInterval;
+    m_previous = -1;
+    m_refineUntil = -1;
+    m_position = 0;
+    m_lastFrameTime = -1;
+    m_hasReference = false;
+    m_endReached = false;
+    m_maxInFlight = std::max(1, QThreadPool::globalInstance()->maxThreadCount());
+    m_framesDecoded = 0;
+    m_framesSkipped = 0;
+    m_elapsed = 0;
+    m_frameGate.clear();
+    m_detections.clear();
+    m_log.clear();
+    m_clock.start();
+
+    m_player.setSource(fileUrl);
+
+    emit runningChanged();
+    emit progressChanged();
+    emit logChanged();
+
+    return true;
+}
+
+void ZXingQtVideoFileScanner::stop()
+{
+    finish(false);
+}
+
+void ZXingQtVideoFileScanner::finish(const bool success)
+{
+    if (!m_running) return;
+
+    // results of the frames still being decoded are dropped, but their tasks keep a pool thread
+    // busy until they complete: they count toward the limit of the next scan
+    m_scanId++;
+    m_staleInFlight += m_inFlight;
+    m_inFlight = 0;
+
+    m_running = false;
+    m_seekTimeout.stop();
+    m_player.stop();
+
+    m_elapsed = m_clock.elapsed();
+    if (success) m_position = m_duration;
+    buildLog();
+
+    emit progressChanged();
+    emit runningChanged();
+    emit finished(success);
+}
+
+/* ************************************************************************** */
+
+void ZXingQtVideoFileScanner::onMediaStatusChanged(QMediaPlayer::MediaStatus status)
+{
+    if (!m_running) return;
+
+    if (status == QMediaPlayer::LoadedMedia && m_duration == 0)
+    {
+        if (!m_player.hasVideo() || m_player.duration() <= 0)
+        {
+            qWarning() << "ZXingQtVideoFileScanner: no video track in" << m_source;
+            finish(false);
+            return;
+        }
+
+        m_duration = m_player.duration();
+        emit progressChanged();
+
+        // pausing a stopped player presents its first frame
+        m_requested = 0;
+        m_player.pause();
+        m_seekTimeout.start();
+    }
+    else if (status == QMediaPlayer::EndOfMedia && m_requested >= 0)
+    {
+        // seeked past the last frame
+        m_seekTimeout.stop();
+        m_requested = -1;
+        m_next = m_duration;
+        seekNext();
+    }
+    else if (status == QMediaPlayer::InvalidMedia)
+    {
+        qWarning() << "ZXingQtVideoFileScanner: invalid media" << m_source;
+        finish(false);
+    }
+}
+
+void ZXingQtVideoFileScanner::onSeekTimeout()
+{
+    if (!m_running || m_requested < 0) return;
+
+    // no frame for this position, move on
+    m_next = std::exchange(m_requested, -1) + m_step;
+    seekNext();
+}
+
+void ZXingQtVideoFileScanner::seekNext()
+{
+    if (!m_running || m_requested >= 0) return;
+
+    if (m_next >= m_duration)
+    {
+        m_endReached = true;
+        if (m_inFlight == 0) finish(true);
+        return;
+    }
+
+    // resumed once a pool thread is available
+    if (m_inFlight + m_staleInFlight >= m_maxInFlight) return;
+
+    m_requested = m_next;
+    m_player.setPosition(m_requested);
+    m_seekTimeout.start();
+}
+
+//! Motion since the previous frame given to the gate, directly in the mapped frame memory
+static bool estimateMotion(ZXingQtFrameGate &gate, const QVideoFrame &frame, float &motion)
+{
+    ZXing::ImageFormat format = ZXing::ImageFormat::None;
+    int pixStride = 0;
+    int pixOffset = 0;
+
+    ZXingQt::qvideoframeFormatToXZingFormat(frame, format, pixStride, pixOffset);
+    if (format == ZXing::ImageFormat::None) return false;
+
+    // shallow copy just to get access to the non-const map() function
+    auto frame_ro = frame;
+    if (!frame_ro.map(QVideoFrame::ReadOnly)) return false;
+    QScopeGuard unmap([&] { frame_ro.unmap(); });
+
+    gate.process(ZXing::ImageView(frame_ro.bits(0) + pixOffset, frame_ro.width(), frame_ro.height(),
+                                  format, frame_ro.bytesPerLine(0), pixStride),
+                 0.f, std::numeric_limits<float>::max());
+    motion = gate.stats().motion;
+
+    return true;
+}
+
+void ZXingQtVideoFileScanner::onVideoFrameChanged(const QVideoFrame &frame)
+{
+    if (!m_running || m_requested < 0 || !frame.isValid()) return;
+
+    m_seekTimeout.stop();
+    const qint64 requested = std::exchange(m_requested, -1);
+    const qint64 timestamp = (frame.startTime() >= 0) ? frame.startTime() / 1000 : requested;
+    m_position = std::max(m_position, requested);
+    m_elapsed = m_clock.elapsed();
+
+    // the seek landed on the frame already analyzed (sampling faster than the video frame rate)
+    if (frame.startTime() >= 0 && frame.startTime() == m_lastFrameTime)
+    {
+        m_framesSkipped++;
+        m_next = requested + m_step;
+        emit progressChanged();
+        seekNext();
+        return;
+    }
+    m_lastFrameTime = frame.startTime();
+
+    float motion = 0.f;
+    const bool isStatic = estimateMotion(m_frameGate, frame, motion) && m_hasReference && motion < m_staticMotion;
+    m_hasReference = true;
+
+    const bool refining = (requested < m_refineUntil);
+
+    if (isStatic)
+    {
+        // same content as the previous sample, already decoded
+        m_framesSkipped++;
+        if (!refining) m_step = std::min<qint64>(m_step * 2, std::max(m_maxSkipInterval, m_sampleInterval));
+        m_next = requested + m_step;
+    }
+    else if (!refining && m_step > m_sampleInterval && m_previous >= 0)
+    {
+        // something changed during the jump, go back over it: the refine pass ends on this position,
+        // so this frame is decoded then. Its first frame has no reference, as this one was not decoded.
+        m_refineUntil = requested;
+        m_next = m_previous + m_sampleInterval;
+        m_step = m_sampleInterval;
+        m_hasReference = false;
+    }
+    else
+    {
+        decode(frame, timestamp);
+        m_next = requested + m_sampleInterval;
+        m_step = m_sampleInterval;
+    }
+    m_previous = requested;
+
+    emit progressChanged();
+    seekNext();
+}
+
+/* ************************************************************************** */
+
+void ZXingQtVideoFileScanner::decode(const QVideoFrame &frame, const qint64 timestamp)
+{
+    m_inFlight++;
+    m_framesDecoded++;
+
+    const ZXing::ReaderOptions opts = m_readerOptions;
+    const int scanId = m_scanId;
+
+    QtConcurrent::run(QThreadPool::globalInstance(), [frame, opts]() {
+        return ZXingQt::ReadBarcodes(frame, opts);
+    }).then(this, [this, scanId, timestamp](const QList<BarcodeQml> &results) {
+        if (scanId == m_scanId)
+        {
+            decoded(timestamp, results);
+        }
+        else
+        {
+            m_staleInFlight--;
+            seekNext();
+        }
+    });
+}
+
+void ZXingQtVideoFileScanner::decoded(const qint64 timestamp, const QList<BarcodeQml> &results)
+{
+    m_inFlight--;
+
+    QList<BarcodeQml> found;
+    for (const auto &r: results)
+    {
+        if (!r.isValid()) continue;
+
+        found.append(r);
+        m_detections.append({timestamp, r.formatName(), r.text()});
+    }
+
+    if (!found.isEmpty())
+    {
+        emit tagsFound(timestamp, found);
+    }
+
+    if (m_endReached && m_inFlight == 0) finish(true);
+    else seekNext();
+}
+
+/* ************************************************************************** */
+
+//! One entry per appearance of a code, the decoding tasks complete out of order so this waits for the end of the scan
+void ZXingQtVideoFileScanner::buildLog()
+{
+    std::stable_sort(m_detections.begin(), m_detections.end(),
+                     [](const Detection &a, const Detection &b) { return a.timestamp < b.timestamp; });
+
+    // a code missing from fewer samples than a full skip is still the same appearance
+    const qint64 gap = std::max(m_maxSkipInterval, m_sampleInterval) + m_sampleInterval;
+
+    QList<QVariantMap> entries;
+    QHash<QString, qsizetype> current; // format and text, to their last entry
+    for (const auto &d: m_detections)
+    {
+        const QString key = d.format + QChar('\n') + d.text;
+        auto it = current.find(key);
+        if (it != current.end() && d.timestamp - entries[*it]["end"].toLongLong() <= gap)
+        {
+            entries[*it]["end"] = d.timestamp;
+            continue;
+        }
+
+        current[key] = entries.size();
+        entries.append({{"start", d.timestamp}, {"end", d.timestamp}, {"format", d.format}, {"text", d.text}});
+    }
+
+    m_log.clear();
+    for (const auto &e: std::as_const(entries)) m_log.append(e);
+
+    emit logChanged();
+}
+
+static QString timecode(const qint64 ms)
+{
+    return QStringLiteral("%1:%2:%3.%4").arg(ms / 3600000, 2, 10, QChar('0'))
+                                        .arg(ms / 60000 % 60, 2, 10, QChar('0'))
+                                        .arg(ms / 1000 % 60, 2, 10, QChar('0'))
+                                        .arg(ms % 1000, 3, 10, QChar('0'));
+}
+
+bool ZXingQtVideoFileScanner::saveLog(const QUrl &fileUrl) const
+{
+    QFile file(fileUrl.isLocalFile() ? fileUrl.toLocalFile() : fileUrl.toString());
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+    {
+        qWarning() << "ZXingQtVideoFileScanner::saveLog() cannot open" << file.fileName();
+        return false;
+    }
+
+    QTextStream out(&file);
+    out << "first seen\tlast seen\tformat\ttext\n";
+    for (const auto &v: m_log)
+    {
+        const QVariantMap e = v.toMap();
+        QString text = e["text"].toString();
+        text.replace(QChar('\t'), QChar(' ')).replace(QChar('\n'), QChar(' '));
+
+        out << timecode(e["start"].toLongLong()) << '\t' << timecode(e["end"].toLongLong()) << '\t'
+            << e["format"].toString() << '\t' << text << '\n';
+    }
+
+    return true;
+}
+
+/* ************************************************************************** */
+
+void ZXingQtVideoFileScanner::setFormats(const int value)
+{
+    if (m_formats != value)
+    {
+        m_formats = value;
+        m_readerOptions.setFormats(ZXingQt::formatsFromBitmask(value));
+        emit readerOptionsChanged();
+    }
+}
+
+void ZXingQtVideoFileScanner::setTryHarder(const bool value)
+{
+    if (m_readerOptions.tryHarder() != value)
+    {
+        m_readerOptions.setTryHarder(value);
+        emit readerOptionsChanged();
+    }
+}
+
+void ZXingQtVideoFileScanner::setTryRotate(const bool value)
+{
+    if (m_readerOptions.tryRotate() != value)
+    {
+        m_readerOptions.setTryRotate(value);
+        emit readerOptionsChanged();
+    }
+}
+
+void ZXingQtVideoFileScanner::setTryInvert(const bool value)
+{
+    if (m_readerOptions.tryInvert() != value)
+    {
+        m_readerOptions.setTryInvert(value);
+        emit readerOptionsChanged();
+    }
+}
+
+void ZXingQtVideoFileScanner::setSampleInterval(const int value)
+{
+    if (m_sampleInterval != value && value > 0)
+    {
+        m_sampleInterval = value;
+        emit samplingChanged();
+    }
+}
+
+void ZXingQtVideoFileScanner::setMaxSkipInterval(const int value)
+{
+    if (m_maxSkipInterval != value && value > 0)
+    {
+        m_maxSkipInterval = value;
+        emit samplingChanged();
+    }
+}
+
+void ZXingQtVideoFileScanner::setStaticMotion(const float value)
+{
+    if (m_staticMotion != value && value >= 0.f)
+    {
+        m_staticMotion = value;
+        emit samplingChanged();
+    }
+}
+
+/* ************************************************************************** */
@@ -0,0 +1,173 @@
+/*
+ * Copyright 2026 Emeric Grange
+ */
+
+#ifndef ZXING_QT_VIDEO_FILE_SCANNER_H
+#define ZXING_QT_VIDEO_FILE_SCANNER_H
+
+#include "ZXingQt.h"
+#include "ZXingQtFrameGate.h"
+
+#include <QObject>
+#include <QUrl>
+#include <QList>
+#include <QString>
+#include <QVariantList>
+#include <QTimer>
+#include <QMediaPlayer>
+#include <QVideoSink>
+#include <QVideoFrame>
+#include <QElapsedTimer>
+
+#include <algorithm>
+
+/*!
+ * \brief Scan a recorded video file for barcodes, as fast as the frames can be decoded.
+ *
+ * QMediaPlayer always paces its playback, so the player is kept paused and driven by
+ * seeks: every seek delivers one frame to the video sink. The frame is decoded on the
+ * global thread pool while the next seek is already underway, with at most one decoding
+ * task per pool thread in flight.
+ *
+ * The video is sampled every sampleInterval ms. Static stretches (the motion estimated by
+ * ZXingQtFrameGate stays below staticMotion) are not decoded again, and the sampling step
+ * doubles up to maxSkipInterval. When a jump lands on something that moved, the scanner
+ * seeks back to right after the last static sample and goes over the stretch at the normal
+ * step. A code that enters and leaves the view between two samples of a static stretch is
+ * not seen though, so maxSkipInterval has to stay below the time a code spends in view.
+ *
+ * Results are reported with their timestamp in the video (tagsFound()) and, once the scan
+ * is over, coalesced into a log of appearances (first and last time a code was seen).
+ */
+class ZXingQtVideoFileScanner : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(int formats READ formats WRITE setFormats NOTIFY readerOptionsChanged)
+    Q_PROPERTY(bool tryHarder READ tryHarder WRITE setTryHarder NOTIFY readerOptionsChanged)
+    Q_PROPERTY(bool tryRotate READ tryRotate WRITE setTryRotate NOTIFY readerOptionsChanged)
+    Q_PROPERTY(bool tryInvert READ tryInvert WRITE setTryInvert NOTIFY readerOptionsChanged)
+
+    Q_PROPERTY(int sampleInterval READ sampleInterval WRITE setSampleInterval NOTIFY samplingChanged)
+    Q_PROPERTY(int maxSkipInterval READ maxSkipInterval WRITE setMaxSkipInterval NOTIFY samplingChanged)
+    Q_PROPERTY(float staticMotion READ staticMotion WRITE setStaticMotion NOTIFY samplingChanged)
+
+    Q_PROPERTY(bool running READ running NOTIFY runningChanged)
+    Q_PROPERTY(QUrl source READ source NOTIFY runningChanged)
+    Q_PROPERTY(qint64 duration READ duration NOTIFY progressChanged)
+    Q_PROPERTY(qint64 position READ position NOTIFY progressChanged)
+    Q_PROPERTY(float progress READ progress NOTIFY progressChanged)
+    Q_PROPERTY(int framesDecoded READ framesDecoded NOTIFY progressChanged)
+    Q_PROPERTY(int framesSkipped READ framesSkipped NOTIFY progressChanged)
+    Q_PROPERTY(qint64 elapsed READ elapsed NOTIFY progressChanged)
+
+    Q_PROPERTY(QVariantList log READ log NOTIFY logChanged)
+
+    QMediaPlayer m_player;
+    QVideoSink m_videoSink;
+    QTimer m_seekTimeout;
+
+    ZXing::ReaderOptions m_readerOptions;
+    int m_formats = 0xffffffff;
+
+    int m_sampleInterval = 100; // ms
+    int m_maxSkipInterval = 800; // ms
+    float m_staticMotion = 2.f; // gray levels
+
+    ZXingQtFrameGate m_frameGate; // only used for its motion estimation
+
+    QUrl m_source;
+    bool m_running = false;
+    qint64 m_duration = 0;
+
+    // seek state, all in ms of video
+    qint64 m_requested = -1; // position of the seek waiting for its frame, -1 if none
+    qint64 m_next = 0; // next position to seek to
+    qint64 m_step = 0;
+    qint64 m_previous = -1; // position of the previous sample
+    qint64 m_refineUntil = -1; // after a seek back, no skipping until that position
+    qint64 m_position = 0; // furthest position analyzed
+    qint64 m_lastFrameTime = -1; // startTime() of the last frame analyzed, in µs
+    bool m_hasReference = false; // the frame gate has a previous frame to compare with
+    bool m_endReached = false;
+
+    int m_scanId = 0; // decoding tasks from a stopped scan are ignored
+
+    int m_inFlight = 0;
+    int m_staleInFlight = 0; // tasks of a stopped scan, still running on the pool
+    int m_maxInFlight = 1;
+    int m_framesDecoded = 0;
+    int m_framesSkipped = 0;
+    QElapsedTimer m_clock;
+    qint64 m_elapsed = 0;
+
+    struct Detection
+    {
+        qint64 timestamp = 0; // ms
+        QString format;
+        QString text;
+    };
+    QList<Detection> m_detections;
+    QVariantList m_log;
+
+    static constexpr int s_seekTimeoutMs = 2000;
+
+    void onMediaStatusChanged(QMediaPlayer::MediaStatus status);
+    void onVideoFrameChanged(const QVideoFrame &frame);
+    void onSeekTimeout();
+
+    void seekNext();
+    void decode(const QVideoFrame &frame, const qint64 timestamp);
+    void decoded(const qint64 timestamp, const QList<BarcodeQml> &results);
+    void finish(const bool success);
+    void buildLog();
+
+    int formats() const { return m_formats; }
+    void setFormats(const int value);
+    bool tryHarder() const { return m_readerOptions.tryHarder(); }
+    void setTryHarder(const bool value);
+    bool tryRotate() const { return m_readerOptions.tryRotate(); }
+    void setTryRotate(const bool value);
+    bool tryInvert() const { return m_readerOptions.tryInvert(); }
+    void setTryInvert(const bool value);
+
+    int sampleInterval() const { return m_sampleInterval; }
+    void setSampleInterval(const int value);
+    int maxSkipInterval() const { return m_maxSkipInterval; }
+    void setMaxSkipInterval(const int value);
+    float staticMotion() const { return m_staticMotion; }
+    void setStaticMotion(const float value);
+
+    bool running() const { return m_running; }
+    QUrl source() const { return m_source; }
+    qint64 duration() const { return m_duration; }
+    qint64 position() const { return m_position; }
+    float progress() const { return (m_duration > 0) ? std::min(1.f, float(m_position) / float(m_duration)) : 0.f; }
+    int framesDecoded() const { return m_framesDecoded; }
+    int framesSkipped() const { return m_framesSkipped; }
+    qint64 elapsed() const { return m_elapsed; }
+
+    QVariantList log() const { return m_log; }
+
+signals:
+    void readerOptionsChanged();
+    void samplingChanged();
+    void runningChanged();
+    void progressChanged();
+    void logChanged();
+
+    void tagsFound(qint64 timestamp, QList<BarcodeQml> results); //!< timestamp in ms of video
+    void finished(bool success);
+
+public:
+    ZXingQtVideoFileScanner(QObject *parent = nullptr);
+    virtual ~ZXingQtVideoFileScanner();
+
+    Q_INVOKABLE bool scan(const QUrl &fileUrl);
+    Q_INVOKABLE void stop();
+
+    //! Write the log as tab separated values: first seen, last seen, format, text
+    Q_INVOKABLE bool saveLog(const QUrl &fileUrl) const;
+};
+
+#endif // ZXING_QT_VIDEO_FILE_SCANNER_H
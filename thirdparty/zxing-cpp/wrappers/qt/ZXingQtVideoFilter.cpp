@@ -6,11 +6,23 @@
 
 #include "ZXingQtVideoFilter.h"
 
-#include <QtConcurrent>
+#include <QMetaObject>
+#include <QMutexLocker>
 #include <QElapsedTimer>
 #include <QImage>
+#include <QScopeGuard>
 #include <QDebug>
 
+#include <chrono>
+#include <utility>
+
+//! Same clock as the app telemetry (FrameRateMonitor::timestamp()), in µs
+static qint64 steadyTimestamp()
+{
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
 ZXingQtVideoFilter::ZXingQtVideoFilter(QObject *parent) : QObject(parent)
 {
     m_readerOptions.setMinLineCount(4); // default is 2
@@ -18,23 +30,48 @@ ZXingQtVideoFilter::ZXingQtVideoFilter(QObject *parent) : QObject(parent)
     m_readerOptions.setFormats(ZXing::BarcodeFormat::AllReadable); // default is
     m_readerOptions.setTextMode(ZXing::TextMode::HRI); // default is
     //m_readerOptions.setBinarizer(ZXing::Binarizer::GlobalHistogram); // default is LocalAverage
+
+    // the decoding thread works on a copy of the properties
+    for (auto signal: {&ZXingQtVideoFilter::captureRectChanged, &ZXingQtVideoFilter::formatsChanged,
+                       &ZXingQtVideoFilter::tryHarderChanged, &ZXingQtVideoFilter::tryRotateChanged,
+                       &ZXingQtVideoFilter::tryInvertChanged, &ZXingQtVideoFilter::tryDownscaleChanged,
+                       &ZXingQtVideoFilter::sequenceTtlChanged, &ZXingQtVideoFilter::fusionChanged,
+                       &ZXingQtVideoFilter::frameGatingChanged, &ZXingQtVideoFilter::itemMappingChanged})
+    {
+        connect(this, signal, this, &ZXingQtVideoFilter::updateDecodeSettings);
+    }
+    updateDecodeSettings();
+
+    m_clock.start();
+
+    m_decodeThread.setObjectName("ZXingQtVideoFilter");
+    m_decodeContext.moveToThread(&m_decodeThread);
+    m_decodeThread.start();
 }
 
 ZXingQtVideoFilter::~ZXingQtVideoFilter()
 {
     stopFilter();
+
+    m_decodeThread.quit();
+    m_decodeThread.wait();
 }
 
 void ZXingQtVideoFilter::stopFilter()
 {
-    if (!m_processThread.isFinished())
+    if (m_videoSink) disconnect(m_videoSink, nullptr, this, nullptr);
+
     {
-        m_processThread.cancel();
-        m_processThread.waitForFinished();
+        QMutexLocker lock(&m_frameMutex);
+        m_active = false;
+        m_pendingFrame = QVideoFrame();
     }
 
-    m_active = false;
-    if (m_videoSink) disconnect(m_videoSink, nullptr, this, nullptr);
+    // wait for the frame being decoded, if any
+    if (m_decodeThread.isRunning())
+    {
+        QMetaObject::invokeMethod(&m_decodeContext, []() {}, Qt::BlockingQueuedConnection);
+    }
 }
 
 void ZXingQtVideoFilter::setVideoSink(QVideoSink *sink)
@@ -43,13 +80,81 @@ void ZXingQtVideoFilter::setVideoSink(QVideoSink *sink)
     if (m_videoSink == sink) return;
     if (m_videoSink) disconnect(m_videoSink, nullptr, this, nullptr);
 
-    m_active = true;
+    {
+        QMutexLocker lock(&m_frameMutex);
+        m_active = true;
+    }
 
     m_videoSink = qobject_cast<QVideoSink*>(sink);
 
+    // process() runs in the thread delivering the frames, it only hands them over to the decoding thread
     connect(m_videoSink, &QVideoSink::videoFrameChanged,
             this, &ZXingQtVideoFilter::process,
-            Qt::QueuedConnection);
+            Qt::DirectConnection);
+}
+
+/*!
+ * \brief Affine transformation from the frame coordinates of a result to the coordinates of the VideoOutput.
+ *
+ * The results are relative to the capture rectangle. The sourceRect of the VideoOutput is expressed
+ * after its rotation, so a frame axis is scaled by the source and content extents it ends up on.
+ */
+static QTransform itemTransform(const QRect &captureRect, const QRectF &sourceRect, const QRectF &contentRect, const int orientation)
+{
+    if (sourceRect.width() <= 0 || sourceRect.height() <= 0) return QTransform(0, 0, 0, 0, 0, 0);
+
+    const qreal cx = contentRect.x(), cy = contentRect.y();
+    const qreal cw = contentRect.width(), ch = contentRect.height();
+    const qreal ox = captureRect.x(), oy = captureRect.y();
+
+    // x' = m11 * x + m21 * y + dx, y' = m12 * x + m22 * y + dy
+    switch ((orientation % 360 + 360) % 360)
+    {
+    default:
+    case 0: {
+        const qreal a = cw / sourceRect.width(), b = ch / sourceRect.height();
+        return QTransform(a, 0, 0, b, cx + a * ox, cy + b * oy);
+    }
+    case 90: {
+        const qreal a = ch / sourceRect.height(), b = cw / sourceRect.width();
+        return QTransform(0, -a, b, 0, cx + b * oy, cy + ch - a * ox);
+    }
+    case 180: {
+        const qreal a = cw / sourceRect.width(), b = ch / sourceRect.height();
+        return QTransform(-a, 0, 0, -b, cx + cw - a * ox, cy + ch - b * oy);
+    }
+    case 270: {
+        const qreal a = ch / sourceRect.height(), b = cw / sourceRect.width();
+        return QTransform(0, a, -b, 0, cx + cw - b * oy, cy + a * ox);
+    }
+    }
+}
+
+void ZXingQtVideoFilter::updateDecodeSettings()
+{
+    QMutexLocker lock(&m_frameMutex);
+
+    m_decodeSettings.readerOptions = m_readerOptions;
+    m_decodeSettings.captureRect = m_captureRect;
+    m_decodeSettings.sequenceTtl = m_sequenceTtl;
+    m_decodeSettings.fusion = m_fusion;
+    m_decodeSettings.frameGating = m_frameGating;
+    m_decodeSettings.minSharpness = m_minSharpness;
+    m_decodeSettings.maxMotion = m_maxMotion;
+    m_decodeSettings.itemTransform = itemTransform(m_captureRect, m_sourceRect, m_contentRect, m_orientation);
+
+    // failed matrix code reads are needed for the multi-frame fusion, but only for the formats it handles:
+    // other formats would return their errors too (checksum failures counting toward maxNumberOfSymbols,
+    // replacing overlapping valid reads), so returnErrors is restricted to the fusable formats
+    if (m_fusion)
+    {
+        std::vector<ZXing::BarcodeFormat> fusable;
+        for (const auto format: ZXing::BarcodeFormats::list(ZXing::BarcodeFormat::AllReadable))
+        {
+            if (ZXingQtModuleFusion::isFusable(ZXing::Symbology(format))) fusable.push_back(format);
+        }
+        m_decodeSettings.readerOptions.setReturnErrors(true).setErrorFormats(std::move(fusable));
+    }
 }
 
 void ZXingQtVideoFilter::setTryHarder(const bool value)
@@ -88,41 +193,49 @@ void ZXingQtVideoFilter::setTryDownscale(const bool value)
     }
 }
 
-static ZXing::BarcodeFormats appBitmaskToZXingFormats(int bitmask)
-{
-    using AF = ZXingQt::BarcodeFormat; // app flags (legacy layout, canonical)
-    using ZF = ZXing::BarcodeFormat;   // library enum (ID based)
-
-    static const struct { AF bit; ZF zx; } s_map[] = {
-        { AF::Aztec,           ZF::Aztec },
-        { AF::Codabar,         ZF::Codabar },
-        { AF::Code39,          ZF::Code39 },
-        { AF::Code93,          ZF::Code93 },
-        { AF::Code128,         ZF::Code128 },
-        { AF::DataBar,         ZF::DataBar },
-        { AF::DataBarExpanded, ZF::DataBarExp },
-        { AF::DataMatrix,      ZF::DataMatrix },
-        { AF::EAN8,            ZF::EAN8 },
-        { AF::EAN13,           ZF::EAN13 },
-        { AF::ITF,             ZF::ITF },
-        { AF::MaxiCode,        ZF::MaxiCode },
-        { AF::PDF417,          ZF::PDF417 },
-        { AF::QRCode,          ZF::QRCode },
-        { AF::UPCA,            ZF::UPCA },
-        { AF::UPCE,            ZF::UPCE },
-        { AF::MicroQRCode,     ZF::MicroQRCode },
-        { AF::RMQRCode,        ZF::RMQRCode },
-        { AF::DataBarLimited,  ZF::DataBarLtd },
-        { AF::DXFilmEdge,      ZF::DXFilmEdge },
-    };
+void ZXingQtVideoFilter::setFusion(const bool value)
+{
+    if (m_fusion != value)
+    {
+        m_fusion = value;
+        emit fusionChanged();
+    }
+}
 
-    std::vector<ZF> formats;
-    for (const auto &m : s_map)
+void ZXingQtVideoFilter::setFrameGating(const bool value)
+{
+    if (m_frameGating != value)
     {
-        if (bitmask & static_cast<int>(m.bit)) formats.push_back(m.zx);
+        m_frameGating = value;
+        emit frameGatingChanged();
     }
+}
 
-    return ZXing::BarcodeFormats(std::move(formats));
+void ZXingQtVideoFilter::setMinSharpness(const float value)
+{
+    if (m_minSharpness != value && value >= 0.f)
+    {
+        m_minSharpness = value;
+        emit frameGatingChanged();
+    }
+}
+
+void ZXingQtVideoFilter::setMaxMotion(const float value)
+{
+    if (m_maxMotion != value && value > 0.f)
+    {
+        m_maxMotion = value;
+        emit frameGatingChanged();
+    }
+}
+
+void ZXingQtVideoFilter::setSequenceTtl(const int value)
+{
+    if (m_sequenceTtl != value && value > 0)
+    {
+        m_sequenceTtl = value;
+        emit sequenceTtlChanged();
+    }
 }
 
 int ZXingQtVideoFilter::formats() const noexcept
@@ -135,7 +248,7 @@ void ZXingQtVideoFilter::setFormats(int newVal)
     if (m_formats != newVal)
     {
         m_formats = newVal;
-        m_readerOptions.setFormats(appBitmaskToZXingFormats(newVal));
+        m_readerOptions.setFormats(ZXingQt::formatsFromBitmask(newVal));
         emit formatsChanged();
     }
 }
@@ -148,48 +261,161 @@ void ZXingQtVideoFilter::setCaptureRect(const QRect &captureRect)
     emit captureRectChanged();
 }
 
+void ZXingQtVideoFilter::setSourceRect(const QRectF &rect)
+{
+    if (rect == m_sourceRect) return;
+
+    m_sourceRect = rect;
+    emit itemMappingChanged();
+}
+
+void ZXingQtVideoFilter::setContentRect(const QRectF &rect)
+{
+    if (rect == m_contentRect) return;
+
+    m_contentRect = rect;
+    emit itemMappingChanged();
+}
+
+void ZXingQtVideoFilter::setOrientation(const int orientation)
+{
+    if (orientation == m_orientation) return;
+
+    m_orientation = orientation;
+    emit itemMappingChanged();
+}
+
+//! Estimate the frame quality on its luma plane, directly in the mapped frame memory
+static ZXingQtFrameGate::Decision gateFrame(ZXingQtFrameGate &gate, const QVideoFrame &frame, const QRect &captureRect,
+                                            const float minSharpness, const float maxMotion)
+{
+    if (!ZXingQt::qvideoframeIsReadable(frame)) return ZXingQtFrameGate::Decision::Decode;
+
+    // shallow copy just to get access to the non-const map() function
+    auto frame_ro = frame;
+    if (!frame_ro.map(QVideoFrame::ReadOnly)) return ZXingQtFrameGate::Decision::Decode;
+    QScopeGuard unmap([&] { frame_ro.unmap(); });
+
+    const ZXing::ImageView view = ZXingQt::qvideoframeToImageView(frame_ro);
+    if (!view.data()) return ZXingQtFrameGate::Decision::Decode;
+
+    return gate.process(view.cropped(captureRect.left(), captureRect.top(), captureRect.width(), captureRect.height()),
+                        minSharpness, maxMotion);
+}
+
 BarcodeQml ZXingQtVideoFilter::process(const QVideoFrame &frame)
 {
-    if (m_active && m_videoSink && m_processThread.isFinished())
-    {
-        //qWarning() << ">>> ZXingQtVideoFilter::process() >>> surfaceFormat > " << frame.surfaceFormat() << " > rotation > " << frame.rotationAngle();
-
-        m_processThread = QtConcurrent::run([=, this]() {
-            QElapsedTimer t;
-            t.start();
-
-            auto results = ZXingQt::ReadBarcodes2(frame, m_readerOptions, m_captureRect);
-
-            for (auto &r: results)
-            {
-                //qDebug() << "+ barcode " << ZXing::ToString(r.format()) << ": " << r.text();
-
-                if (r.isValid())
-                {
-                    r.runTime = t.elapsed();
-                    emit tagFound(r);
-                }
-                else
-                {
-                    qWarning() << ">>> ZXingQtVideoFilter::process() >>> INVALID RESULTS";
-                }
-            }
-
-            if (results.size())
-            {
-                results.first().runTime = t.elapsed();
-                emit decodingFinished(results.first());
-                return results.first();
-            }
-            else
-            {
-                BarcodeQml r;
-                r.runTime = t.elapsed();
-                emit decodingFinished(r);
-                return r;
-            }
-        });
+    QMutexLocker lock(&m_frameMutex);
+    if (!m_active) return BarcodeQml();
+
+    // a newer frame replaces the one still waiting, only one decoding request is queued at a time
+    const bool queued = m_pendingFrame.isValid();
+    m_pendingFrame = frame;
+    m_pendingFrameTime = steadyTimestamp();
+
+    if (!queued)
+    {
+        QMetaObject::invokeMethod(&m_decodeContext, [this]() { decodePendingFrame(); }, Qt::QueuedConnection);
     }
 
     return BarcodeQml();
 }
+
+void ZXingQtVideoFilter::decodePendingFrame()
+{
+    QVideoFrame frame;
+    qint64 frameTime = 0;
+    DecodeSettings settings;
+    {
+        QMutexLocker lock(&m_frameMutex);
+        frame = std::exchange(m_pendingFrame, QVideoFrame());
+        frameTime = m_pendingFrameTime;
+        settings = m_decodeSettings;
+    }
+    if (!frame.isValid()) return;
+
+    //qWarning() << ">>> ZXingQtVideoFilter::decodePendingFrame() >>> surfaceFormat > " << frame.surfaceFormat() << " > rotation > " << frame.rotationAngle();
+
+    QElapsedTimer t;
+    t.start();
+    const qint64 now = m_clock.elapsed();
+    const qint64 decodeStart = steadyTimestamp();
+
+    // blurry or moving frames are skipped, or only get a cheap decoding pass
+    ZXing::ReaderOptions opts = settings.readerOptions;
+    if (settings.frameGating)
+    {
+        const auto decision = gateFrame(m_frameGate, frame, settings.captureRect, settings.minSharpness, settings.maxMotion);
+        const ZXingQtFrameGate::Stats stats = m_frameGate.stats();
+
+        QMetaObject::invokeMethod(this, [this, decision, stats]() {
+            m_frameStats = stats;
+            if (decision == ZXingQtFrameGate::Decision::Skip) m_framesSkipped++;
+            else if (decision == ZXingQtFrameGate::Decision::Downgrade) m_framesDowngraded++;
+            else m_framesDecoded++;
+            emit frameStatsChanged();
+        });
+
+        if (decision == ZXingQtFrameGate::Decision::Skip) return;
+
+        if (decision == ZXingQtFrameGate::Decision::Downgrade)
+        {
+            opts.setTryHarder(false).setTryRotate(false).setTryInvert(false);
+        }
+    }
+
+    // the mapped frame memory is read directly when possible (toImage() otherwise)
+    QList<BarcodeQml> results = ZXingQt::ReadBarcodes(frame, opts, settings.captureRect);
+
+    // everything found in this frame, reported with a single signal
+    QList<BarcodeQml> found;
+
+    for (auto &r: results)
+    {
+        //qDebug() << "+ barcode " << ZXing::ToString(r.format()) << ": " << r.text();
+
+        if (r.isValid())
+        {
+            found.append(r);
+        }
+        else if (!settings.fusion)
+        {
+            qWarning() << ">>> ZXingQtVideoFilter::decodePendingFrame() >>> INVALID RESULTS";
+        }
+    }
+
+    // damaged matrix codes, fused over several frames
+    if (settings.fusion)
+    {
+        auto recovered = m_moduleFusion.process(results, now, s_fusionTtlMs);
+        found.append(recovered);
+
+        results.removeIf([](const BarcodeQml &r) { return !r.isValid(); });
+        results.append(recovered);
+    }
+
+    // structured append sequences, the parts may be spread over several frames
+    found.append(m_sequenceAssembler.process(results, now, settings.sequenceTtl));
+
+    const int runTime = static_cast<int>(t.elapsed());
+    const qint64 decodeEnd = steadyTimestamp();
+    auto complete = [&](BarcodeQml &r) {
+        r.runTime = runTime;
+        r.frameTime = frameTime;
+        r.decodeStart = decodeStart;
+        r.decodeEnd = decodeEnd;
+
+        const Position &p = r.position();
+        r.itemQuad = settings.itemTransform.map(QPolygonF({p.topLeft(), p.topRight(), p.bottomRight(), p.bottomLeft()}));
+    };
+    for (auto &r: found) complete(r);
+
+    if (!found.isEmpty())
+    {
+        emit tagsFound(found);
+    }
+
+    BarcodeQml r = results.size() ? results.first() : BarcodeQml();
+    complete(r);
+    emit decodingFinished(r);
+}
@@ -8,13 +8,20 @@
 #define ZXING_QT_VIDEOFILTER_H
 
 #include "ZXingQt.h"
+#include "ZXingQtFrameGate.h"
+#include "ZXingQtModuleFusion.h"
+#include "ZXingQtSequenceAssembler.h"
 
 #include <QObject>
 #include <QRect>
+#include <QRectF>
 #include <QPoint>
+#include <QTransform>
 #include <QVideoSink>
 #include <QVideoFrame>
-#include <QFuture>
+#include <QThread>
+#include <QMutex>
+#include <QElapsedTimer>
 
 class ZXingQtVideoFilter : public QObject
 {
@@ -23,6 +30,11 @@ class ZXingQtVideoFilter : public QObject
     Q_PROPERTY(QVideoSink *videoSink MEMBER m_videoSink WRITE setVideoSink)
 
     Q_PROPERTY(QRect captureRect READ captureRect WRITE setCaptureRect NOTIFY captureRectChanged)
+
+    // geometry of the VideoOutput, to report the results in its coordinates (BarcodeQml::itemQuad)
+    Q_PROPERTY(QRectF sourceRect READ sourceRect WRITE setSourceRect NOTIFY itemMappingChanged)
+    Q_PROPERTY(QRectF contentRect READ contentRect WRITE setContentRect NOTIFY itemMappingChanged)
+    Q_PROPERTY(int orientation READ orientation WRITE setOrientation NOTIFY itemMappingChanged)
     Q_PROPERTY(int formats READ formats WRITE setFormats NOTIFY formatsChanged)
 
     Q_PROPERTY(bool tryHarder READ tryHarder WRITE setTryHarder NOTIFY tryHarderChanged)
@@ -30,14 +42,73 @@ class ZXingQtVideoFilter : public QObject
     Q_PROPERTY(bool tryInvert READ tryInvert WRITE setTryInvert NOTIFY tryInvertChanged)
     Q_PROPERTY(bool tryDownscale READ tryDownscale WRITE setTryDownscale NOTIFY tryDownscaleChanged)
 
+    Q_PROPERTY(int sequenceTtl READ sequenceTtl WRITE setSequenceTtl NOTIFY sequenceTtlChanged)
+    Q_PROPERTY(bool fusion READ fusion WRITE setFusion NOTIFY fusionChanged)
+
+    Q_PROPERTY(bool frameGating READ frameGating WRITE setFrameGating NOTIFY frameGatingChanged)
+    Q_PROPERTY(float minSharpness READ minSharpness WRITE setMinSharpness NOTIFY frameGatingChanged)
+    Q_PROPERTY(float maxMotion READ maxMotion WRITE setMaxMotion NOTIFY frameGatingChanged)
+    Q_PROPERTY(float sharpness READ sharpness NOTIFY frameStatsChanged)
+    Q_PROPERTY(float motion READ motion NOTIFY frameStatsChanged)
+    Q_PROPERTY(int framesDecoded READ framesDecoded NOTIFY frameStatsChanged)
+    Q_PROPERTY(int framesDowngraded READ framesDowngraded NOTIFY frameStatsChanged)
+    Q_PROPERTY(int framesSkipped READ framesSkipped NOTIFY frameStatsChanged)
+
+    // frames are delivered straight to the decoding thread, only the most recent one is kept
+    QThread m_decodeThread;
+    QObject m_decodeContext; // lives in m_decodeThread
+    QMutex m_frameMutex; // guards m_active, m_pendingFrame and m_decodeSettings
     bool m_active = true;
-    QFuture <void> m_processThread;
+    QVideoFrame m_pendingFrame;
+    qint64 m_pendingFrameTime = 0; // arrival of m_pendingFrame, steady clock in µs
+
+    //! Copy of the properties, for the decoding thread
+    struct DecodeSettings
+    {
+        ZXing::ReaderOptions readerOptions; // with fusion, returnErrors for the formats it handles
+        QRect captureRect;
+        int sequenceTtl = 0;
+        bool fusion = false;
+        bool frameGating = false;
+        float minSharpness = 0.f;
+        float maxMotion = 0.f;
+        QTransform itemTransform; // frame (capture rectangle) coordinates to item coordinates
+    };
+    DecodeSettings m_decodeSettings;
+    void updateDecodeSettings();
+
+    void decodePendingFrame();
 
     QRect m_captureRect;
     ZXing::ReaderOptions m_readerOptions;
 
+    QRectF m_sourceRect;
+    QRectF m_contentRect;
+    int m_orientation = 0;
+
     int m_formats = 0xffffffff;
 
+    QElapsedTimer m_clock; // frame timestamps, for the multi-frame features
+
+    // structured append sequences, assembled across frames
+    ZXingQtSequenceAssembler m_sequenceAssembler;
+    int m_sequenceTtl = 10000; // ms
+
+    // damaged matrix codes, module votes accumulated across frames
+    ZXingQtModuleFusion m_moduleFusion;
+    bool m_fusion = true;
+    static constexpr int s_fusionTtlMs = 1000;
+
+    // blurry or moving frames, skipped or only decoded with a cheap pass
+    ZXingQtFrameGate m_frameGate;
+    bool m_frameGating = true;
+    float m_minSharpness = 0.25f;
+    float m_maxMotion = 20.f; // gray levels
+    ZXingQtFrameGate::Stats m_frameStats; // copy for the QML side, updated from the GUI thread
+    int m_framesDecoded = 0;
+    int m_framesDowngraded = 0;
+    int m_framesSkipped = 0;
+
     QVideoSink *m_videoSink = nullptr;
     void setVideoSink(QVideoSink *sink);
 
@@ -45,6 +116,14 @@ class ZXingQtVideoFilter : public QObject
     QRect captureRect() const { return m_captureRect; }
     void setCaptureRect(const QRect &captureRect);
 
+    // video item geometry
+    QRectF sourceRect() const { return m_sourceRect; }
+    void setSourceRect(const QRectF &rect);
+    QRectF contentRect() const { return m_contentRect; }
+    void setContentRect(const QRectF &rect);
+    int orientation() const { return m_orientation; }
+    void setOrientation(const int orientation);
+
     // barcode reader options
     int formats() const noexcept;
     void setFormats(int newVal);
@@ -57,20 +136,44 @@ class ZXingQtVideoFilter : public QObject
     bool tryDownscale() const { return m_readerOptions.tryDownscale(); }
     void setTryDownscale(const bool value);
 
+    int sequenceTtl() const { return m_sequenceTtl; }
+    void setSequenceTtl(const int value);
+
+    bool fusion() const { return m_fusion; }
+    void setFusion(const bool value);
+
+    bool frameGating() const { return m_frameGating; }
+    void setFrameGating(const bool value);
+    float minSharpness() const { return m_minSharpness; }
+    void setMinSharpness(const float value);
+    float maxMotion() const { return m_maxMotion; }
+    void setMaxMotion(const float value);
+    float sharpness() const { return m_frameStats.sharpness; }
+    float motion() const { return m_frameStats.motion; }
+    int framesDecoded() const { return m_framesDecoded; }
+    int framesDowngraded() const { return m_framesDowngraded; }
+    int framesSkipped() const { return m_framesSkipped; }
+
 signals:
     void tryHarderChanged();
     void tryRotateChanged();
     void tryInvertChanged();
     void tryDownscaleChanged();
+    void sequenceTtlChanged();
+    void fusionChanged();
+    void frameGatingChanged();
+    void frameStatsChanged();
 
     void formatsChanged();
     void captureRectChanged();
+    void itemMappingChanged();
 
     void decodingStarted();
     void decodingFinished(BarcodeQml result);
-    void tagFound(BarcodeQml result);
+    void tagsFound(QList<BarcodeQml> results); //!< all the symbols found in one frame
 
 public slots:
+    //! Hand a frame over to the decoding thread, can be called from any thread
     BarcodeQml process(const QVideoFrame &frame);
 
 public:
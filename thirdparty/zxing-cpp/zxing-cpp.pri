@@ -31,8 +31,16 @@ HEADERS += $${PWD}/wrappers/qt/ZXingQt.h
 INCLUDEPATH += $${PWD}/wrappers/qt/
 
 build_readers {
-    SOURCES += $${PWD}/wrappers/qt/ZXingQtVideoFilter.cpp
-    HEADERS += $${PWD}/wrappers/qt/ZXingQtVideoFilter.h
+    SOURCES += $${PWD}/wrappers/qt/ZXingQtFrameGate.cpp \
+               $${PWD}/wrappers/qt/ZXingQtModuleFusion.cpp \
+               $${PWD}/wrappers/qt/ZXingQtSequenceAssembler.cpp \
+               $${PWD}/wrappers/qt/ZXingQtVideoFilter.cpp \
+               $${PWD}/wrappers/qt/ZXingQtVideoFileScanner.cpp
+    HEADERS += $${PWD}/wrappers/qt/ZXingQtFrameGate.h \
+               $${PWD}/wrappers/qt/ZXingQtModuleFusion.h \
+               $${PWD}/wrappers/qt/ZXingQtSequenceAssembler.h \
+               $${PWD}/wrappers/qt/ZXingQtVideoFilter.h \
+               $${PWD}/wrappers/qt/ZXingQtVideoFileScanner.h
 }
 build_writers {
     SOURCES += $${PWD}/wrappers/qt/ZXingQtImageProvider.cpp
@@ -96,7 +104,8 @@ HEADERS += $${PWD}/core/src/Barcode.h \
            $${PWD}/core/Version.h
 
 build_readers {
-    SOURCES += $${PWD}/core/src/BinaryBitmap.cpp \
+    SOURCES += $${PWD}/core/src/BarcodeIndex.cpp \
+               $${PWD}/core/src/BinaryBitmap.cpp \
                $${PWD}/core/src/BitSource.cpp \
                $${PWD}/core/src/Content.cpp \
                $${PWD}/core/src/DecodeHints.cpp \
@@ -112,7 +121,8 @@ build_readers {
                $${PWD}/core/src/TextDecoder.cpp \
                $${PWD}/core/src/WhiteRectDetector.cpp
 
-    HEADERS += $${PWD}/core/src/BinaryBitmap.h \
+    HEADERS += $${PWD}/core/src/BarcodeIndex.h \
+               $${PWD}/core/src/BinaryBitmap.h \
                $${PWD}/core/src/BitSource.h \
                $${PWD}/core/src/Content.h \
                $${PWD}/core/src/DecodeHints.h \
@@ -131,6 +141,7 @@ build_readers {
                $${PWD}/core/src/ReedSolomonDecoder.h \
                $${PWD}/core/src/Result.h \
                $${PWD}/core/src/ResultPoint.h \
+               $${PWD}/core/src/SpatialGrid.h \
                $${PWD}/core/src/StructuredAppend.h \
                $${PWD}/core/src/TextDecoder.h \
                $${PWD}/core/src/ThresholdBinarizer.h \
@@ -263,7 +274,6 @@ SOURCES += $${PWD}/core/src/datamatrix/DMECEncoder.cpp \
            $${PWD}/core/src/datamatrix/DMWriter.cpp
 
 HEADERS += $${PWD}/core/src/datamatrix/DMECEncoder.h \
-           $${PWD}/core/src/datamatrix/DMEncoderContext.h \
            $${PWD}/core/src/datamatrix/DMHighLevelEncoder.h \
            $${PWD}/core/src/datamatrix/DMSymbolInfo.h \
            $${PWD}/core/src/datamatrix/DMSymbolShape.h \